@@ -0,0 +1,6 @@
+#ifndef _GEGL_PATH_SPIRO__H
+#define _GEGL_PATH_SPIRO__H
+
+void gegl_path_spiro_init (void);
+
+#endif
@@ -39,6 +39,8 @@
 #include "gegl-buffer-iterator.h"
 #include "gegl-buffer-cl-cache.h"
 #include "gegl-config.h"
+#include "gegl-stats.h"
+#include "gegl-trace.h"
 
 static void gegl_buffer_iterate_read_fringed (GeglBuffer          *buffer,
                                               const GeglRectangle *roi,
@@ -117,7 +119,7 @@ gegl_buffer_get_pixel (GeglBuffer     *buffer,
     }
 
   if (gegl_config_threads()>1)
-  g_rec_mutex_lock (&buffer->tile_storage->mutex);
+  gegl_stats_storage_lock (&buffer->tile_storage->mutex);
   {
     gint tile_width  = buffer->tile_width;
     gint tile_height = buffer->tile_height;
@@ -153,7 +155,9 @@ gegl_buffer_get_pixel (GeglBuffer     *buffer,
             gint px_size = babl_format_get_bytes_per_pixel (buffer->soft_format);
             fish    = babl_fish (buffer->soft_format, format);
             tp = gegl_tile_get_data (tile) + (offsety * tile_width + offsetx) * px_size;
-            babl_process (fish, tp, buf, 1);
+            gegl_stats_babl_process (GEGL_CONVERSION_SITE_BUFFER_GET,
+                                     buffer->soft_format, format,
+                                     fish, tp, buf, 1);
           }
         else
           {
@@ -184,7 +188,7 @@ __gegl_buffer_set_pixel (GeglBuffer     *buffer,
     return;
 
   if (gegl_config_threads()>1)
-  g_rec_mutex_lock (&buffer->tile_storage->mutex);
+  gegl_stats_storage_lock (&buffer->tile_storage->mutex);
   {
     gint tile_width  = buffer->tile_width;
     gint tile_height = buffer->tile_height;
@@ -230,7 +234,9 @@ __gegl_buffer_set_pixel (GeglBuffer     *buffer,
         tp = gegl_tile_get_data (tile) + (offsety * tile_width + offsetx) * px_size;
 
         if (fish)
-          babl_process (fish, buf, tp, 1);
+          gegl_stats_babl_process (GEGL_CONVERSION_SITE_BUFFER_SET,
+                                   format, buffer->soft_format,
+                                   fish, buf, tp, 1);
         else
           memcpy (tp, buf, px_size);
 
@@ -385,8 +391,12 @@ gegl_buffer_iterate_write (GeglBuffer          *buffer,
       fish = NULL;
     }
   else
+    {
       fish = babl_fish ((gpointer) format,
                         (gpointer) buffer->soft_format);
+      gegl_stats_add (GEGL_STATS_CONVERSION_BYTES,
+                      (gsize) width * height * bpx_size);
+    }
 
   while (bufy < height)
     {
@@ -455,8 +465,10 @@ gegl_buffer_iterate_write (GeglBuffer          *buffer,
                   if (buffer_y + y >= buffer_abyss_y &&
                       buffer_y + y < abyss_y_total)
                     {
-                      babl_process (fish, bp + lskip * bpx_size, tp + lskip * px_size,
-                                    pixels - lskip - rskip);
+                      gegl_stats_babl_process (GEGL_CONVERSION_SITE_BUFFER_SET,
+                                               format, buffer->soft_format, fish,
+                                               bp + lskip * bpx_size, tp + lskip * px_size,
+                                               pixels - lskip - rskip);
                     }
 
                   tp += tile_stride;
@@ -499,6 +511,8 @@ gegl_buffer_set_internal (GeglBuffer          *buffer,
                           const void          *src,
                           gint                 rowstride)
 {
+  gint64 trace_start = gegl_trace_enabled ? g_get_monotonic_time () : 0;
+
   if (gegl_cl_is_accelerated ())
     {
       gegl_buffer_cl_cache_flush (buffer, rect);
@@ -506,6 +520,10 @@ gegl_buffer_set_internal (GeglBuffer          *buffer,
 
   gegl_buffer_iterate_write (buffer, rect, (void *) src, rowstride, format, level);
 
+  /* only conversions are traced, plain copies are too many to keep */
+  if (trace_start && format != buffer->soft_format)
+    gegl_trace_event ("babl", babl_get_name (format), trace_start, rect, level);
+
   if (gegl_buffer_is_shared (buffer))
     {
       gegl_buffer_flush (buffer);
@@ -584,10 +602,16 @@ gegl_buffer_iterate_read_simple (GeglBuffer          *buffer,
   const Babl *fish;
 
   if (format == buffer->soft_format)
-    fish = NULL;
+    {
+      fish = NULL;
+    }
   else
-    fish = babl_fish ((gpointer) buffer->soft_format,
-                      (gpointer) format);
+    {
+      fish = babl_fish ((gpointer) buffer->soft_format,
+                        (gpointer) format);
+      gegl_stats_add (GEGL_STATS_CONVERSION_BYTES,
+                      (gsize) width * height * bpx_size);
+    }
 
   while (bufy < height)
     {
@@ -631,7 +655,9 @@ gegl_buffer_iterate_read_simple (GeglBuffer          *buffer,
                row++, y++)
             {
               if (fish)
-                babl_process (fish, tp, bp, pixels);
+                gegl_stats_babl_process (GEGL_CONVERSION_SITE_BUFFER_GET,
+                                         buffer->soft_format, format,
+                                         fish, tp, bp, pixels);
               else
                 memcpy (bp, tp, pixels * px_size);
 
@@ -1428,8 +1454,13 @@ _gegl_buffer_get_unlocked (GeglBuffer          *buffer,
     }
   if (GEGL_FLOAT_EQUAL (scale, 1.0))
     {
+      gint64 trace_start = gegl_trace_enabled ? g_get_monotonic_time () : 0;
+
       gegl_buffer_iterate_read_dispatch (buffer, rect, dest_buf, rowstride,
                                          format, 0, repeat_mode);
+
+      if (trace_start && format != buffer->soft_format)
+        gegl_trace_event ("babl", babl_get_name (format), trace_start, rect, 0);
       return;
     }
   else
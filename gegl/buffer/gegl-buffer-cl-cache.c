@@ -22,6 +22,7 @@
 
 #include "gegl.h"
 #include "gegl-debug.h"
+#include "gegl-trace.h"
 #include "gegl-types-internal.h"
 #include "gegl-buffer-types.h"
 #include "gegl-buffer.h"
@@ -151,9 +152,11 @@ _gegl_buffer_cl_cache_flush2 (GeglTileHandlerCache *cache,
 
           data = g_malloc(entry->roi.width * entry->roi.height * size);
 
+          GEGL_TRACE_START ();
           cl_err = gegl_clEnqueueReadBuffer(gegl_cl_get_command_queue(),
                                             entry->tex, CL_TRUE, 0, entry->roi.width * entry->roi.height * size, data,
                                             0, NULL, NULL);
+          GEGL_TRACE_END ("opencl", "download", &entry->roi, 0);
           /* tile-ize */
           gegl_buffer_set (entry->buffer, &entry->roi, 0, entry->buffer->soft_format, data, GEGL_AUTO_ROWSTRIDE);
 
@@ -26,6 +26,7 @@
 
 #include "gegl.h"
 #include "gegl/gegl-debug.h"
+#include "gegl-trace.h"
 
 #include "gegl-buffer-types.h"
 #include "gegl-buffer-cl-iterator.h"
@@ -324,10 +325,12 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
                     {
                       data = g_malloc(i->size[no] * i->op_cl_format_size [no]);
 
+                      GEGL_TRACE_START ();
                       cl_err = gegl_clEnqueueReadBuffer(gegl_cl_get_command_queue(),
                                                         i->tex_op[no], CL_TRUE,
                                                         0, i->size[no] * i->op_cl_format_size[no], data,
                                                         0, NULL, NULL);
+                      GEGL_TRACE_END ("opencl", "download", &i->roi[no], 0);
                       CL_CHECK;
 
                       /* color conversion using BABL */
@@ -426,6 +429,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
                         CL_CHECK;
 
                         /* pre-pinned memory */
+                        GEGL_TRACE_START ();
                         data = gegl_clEnqueueMapBuffer(gegl_cl_get_command_queue(), i->tex_op[no], CL_TRUE,
                                                        CL_MAP_WRITE,
                                                        0, i->size[no] * i->op_cl_format_size [no],
@@ -437,6 +441,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
 
                         cl_err = gegl_clEnqueueUnmapMemObject (gegl_cl_get_command_queue(), i->tex_op[no], data,
                                                                    0, NULL, NULL);
+                        GEGL_TRACE_END ("opencl", "upload", &i->roi[no], 0);
                         CL_CHECK;
 
                         i->tex[no] = i->tex_op[no];
@@ -463,6 +468,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
                             CL_CHECK;
 
                             /* pre-pinned memory */
+                            GEGL_TRACE_START ();
                             data = gegl_clEnqueueMapBuffer(gegl_cl_get_command_queue(), i->tex_buf[no], CL_TRUE,
                                                            CL_MAP_WRITE,
                                                            0, i->size[no] * i->buf_cl_format_size [no],
@@ -474,6 +480,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
 
                             cl_err = gegl_clEnqueueUnmapMemObject (gegl_cl_get_command_queue(), i->tex_buf[no], data,
                                                                    0, NULL, NULL);
+                            GEGL_TRACE_END ("opencl", "upload", &i->roi[no], 0);
                             CL_CHECK;
                           }
 
@@ -501,6 +508,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
                             CL_CHECK;
 
                             /* pre-pinned memory */
+                            GEGL_TRACE_START ();
                             data = gegl_clEnqueueMapBuffer(gegl_cl_get_command_queue(), i->tex_buf[no], CL_TRUE,
                                                            CL_MAP_WRITE,
                                                            0, i->size[no] * i->buf_cl_format_size [no],
@@ -512,6 +520,7 @@ gegl_buffer_cl_iterator_next (GeglBufferClIterator *iterator, gboolean *err)
 
                             cl_err = gegl_clEnqueueUnmapMemObject (gegl_cl_get_command_queue(), i->tex_buf[no], data,
                                                                    0, NULL, NULL);
+                            GEGL_TRACE_END ("opencl", "upload", &i->roi[no], 0);
                             CL_CHECK;
                           }
 
@@ -33,6 +33,7 @@
 #include "gegl-buffer-private.h"
 #include "gegl-buffer-cl-cache.h"
 #include "gegl-config.h"
+#include "gegl-stats.h"
 
 #define GEGL_ITERATOR_INCOMPATIBLE (1 << 2)
 
@@ -194,12 +195,16 @@ release_tile (GeglBufferIterator *iter,
     {
       if (sub->access_mode & GEGL_ACCESS_WRITE)
         {
+          gpointer site = gegl_stats_conversion_site_push (GEGL_CONVERSION_SITE_ITERATOR);
+
           gegl_buffer_set_unlocked_no_notify (sub->buffer,
                                               &sub->real_roi,
                                               sub->level,
                                               sub->format,
                                               sub->real_data,
                                               GEGL_AUTO_ROWSTRIDE);
+
+          gegl_stats_conversion_site_pop (site);
         }
 
       gegl_free (sub->real_data);
@@ -359,10 +364,16 @@ get_indirect (GeglBufferIterator *iter,
 
   sub->real_data = gegl_malloc (sub->format_bpp * sub->real_roi.width * sub->real_roi.height);
 
+  gegl_stats_inc (GEGL_STATS_ITERATOR_INDIRECT);
+
   if (sub->access_mode & GEGL_ACCESS_READ)
     {
+      gpointer site = gegl_stats_conversion_site_push (GEGL_CONVERSION_SITE_ITERATOR);
+
       gegl_buffer_get_unlocked (sub->buffer, level_to_scale (sub->level), &sub->real_roi, sub->format, sub->real_data,
                                 GEGL_AUTO_ROWSTRIDE, sub->abyss_policy);
+
+      gegl_stats_conversion_site_pop (site);
     }
 
   sub->row_stride = sub->real_roi.width * sub->format_bpp;
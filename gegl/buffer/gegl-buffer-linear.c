@@ -11,6 +11,7 @@
 #include "gegl-buffer-private.h"
 #include "gegl-tile-storage.h"
 #include "gegl-tile-handler-cache.h"
+#include "gegl-stats.h"
 
 GeglBuffer *
 gegl_buffer_linear_new (const GeglRectangle *extent,
@@ -147,7 +148,7 @@ gegl_buffer_linear_open (GeglBuffer          *buffer,
     extent=&buffer->extent;
 
   /*gegl_buffer_lock (buffer);*/
-  g_rec_mutex_lock (&buffer->tile_storage->mutex);
+  gegl_stats_storage_lock (&buffer->tile_storage->mutex);
   if (extent->x     == buffer->extent.x &&
       extent->y     == buffer->extent.y &&
       extent->width == buffer->tile_width &&
@@ -265,7 +266,7 @@ gegl_buffer_linear_close (GeglBuffer *buffer,
               gegl_free (info->buf);
               g_free (info);
 
-              g_rec_mutex_lock (&buffer->tile_storage->mutex);
+              gegl_stats_storage_lock (&buffer->tile_storage->mutex);
               break;
             }
         }
@@ -94,8 +94,14 @@ void              gegl_tile_cache_init    (void);
 
 void              gegl_tile_cache_destroy (void);
 
+/* approximate number of bytes held by the tile cache */
+guint64           gegl_tile_cache_get_total (void);
+
 void              gegl_tile_backend_swap_cleanup (void);
 
+/* size in bytes of the swap file */
+guint64           gegl_tile_backend_swap_get_total (void);
+
 GeglTileBackend * gegl_buffer_backend     (GeglBuffer *buffer);
 GeglTileBackend * gegl_buffer_backend2    (GeglBuffer *buffer); /* non-cached */
 
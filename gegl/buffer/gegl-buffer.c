@@ -48,6 +48,7 @@
 #include "gegl-tile-backend-ram.h"
 #include "gegl-types-internal.h"
 #include "gegl-config.h"
+#include "gegl-stats.h"
 #include "gegl-buffer-cl-cache.h"
 
 #ifdef GEGL_ENABLE_DEBUG
@@ -355,7 +356,7 @@ _gegl_buffer_drop_hot_tile (GeglBuffer *buffer)
   GeglTileStorage *storage = buffer->tile_storage;
 
   if (gegl_config_threads()>1)
-    g_rec_mutex_lock (&storage->mutex);
+    gegl_stats_storage_lock (&storage->mutex);
 
   if (storage->hot_tile)
     {
@@ -475,6 +476,8 @@ gegl_buffer_constructor (GType                  type,
 
   object = G_OBJECT_CLASS (parent_class)->constructor (type, n_params, params);
 
+  gegl_stats_inc (GEGL_STATS_BUFFERS_CREATED);
+
   buffer  = GEGL_BUFFER (object);
   handler = GEGL_TILE_HANDLER (object);
   source  = handler->source;
@@ -1222,7 +1225,7 @@ gegl_buffer_get_tile (GeglBuffer *buffer,
     GeglTileStorage *tile_storage = buffer->tile_storage;
     g_assert (tile_storage);
 
-    g_rec_mutex_lock (&tile_storage->mutex);
+    gegl_stats_storage_lock (&tile_storage->mutex);
 
     tile = gegl_tile_source_command (source, GEGL_TILE_GET,
                                      x, y, z, NULL);
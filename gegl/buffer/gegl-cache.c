@@ -18,6 +18,7 @@
 
 #include "config.h"
 
+#include <stdio.h>
 #include <string.h>
 
 #include <glib-object.h>
@@ -30,6 +31,7 @@
 
 #include "gegl-cache.h"
 #include "gegl-region.h"
+#include "gegl-tile-storage.h"
 
 enum
 {
@@ -65,13 +67,18 @@ guint gegl_cache_signals[LAST_SIGNAL] = { 0 };
 static void
 gegl_cache_constructed (GObject *object)
 {
-  GeglCache *self = GEGL_CACHE (object);
+  GeglCache  *self   = GEGL_CACHE (object);
+  GeglBuffer *buffer = GEGL_BUFFER (object);
   gint i;
 
   G_OBJECT_CLASS (gegl_cache_parent_class)->constructed (object);
 
   for (i = 0; i < GEGL_CACHE_VALID_MIPMAPS; i++)
-    self->valid_region[i] = gegl_region_new ();
+    {
+      self->valid_tiles[i]    = gegl_tile_bitmap_new (buffer->tile_width,
+                                                      buffer->tile_height);
+      self->partial_region[i] = gegl_region_new ();
+    }
 }
 
 /* expand invalidated regions to be align with coordinates divisible by 8 in both
@@ -178,8 +185,13 @@ gegl_cache_init (GeglCache *self)
 static void
 dispose (GObject *gobject)
 {
+  GeglCache *self = GEGL_CACHE (gobject);
+
   while (g_idle_remove_by_data (gobject)) ;
 
+  if (self->valid_path)
+    gegl_cache_detach_file (self);
+
   G_OBJECT_CLASS (gegl_cache_parent_class)->dispose (gobject);
 }
 
@@ -191,8 +203,12 @@ finalize (GObject *gobject)
 
   g_mutex_clear (&self->mutex);
   for (i = 0; i < GEGL_CACHE_VALID_MIPMAPS; i++)
-    if (self->valid_region[i])
-      gegl_region_destroy (self->valid_region[i]);
+    {
+      if (self->valid_tiles[i])
+        gegl_tile_bitmap_free (self->valid_tiles[i]);
+      if (self->partial_region[i])
+        gegl_region_destroy (self->partial_region[i]);
+    }
   G_OBJECT_CLASS (gegl_cache_parent_class)->finalize (gobject);
 }
 
@@ -257,6 +273,54 @@ get_property (GObject    *gobject,
     }
 }
 
+/* Tiles along the border of an invalidated rectangle are dropped from the
+ * bitmap as a whole, keep the parts of them that stay valid in the partial
+ * region instead.
+ */
+static void
+gegl_cache_keep_border_tiles (GeglCache           *self,
+                              gint                 level,
+                              const GeglRectangle *roi)
+{
+  GeglTileBitmap *bitmap = self->valid_tiles[level];
+  GeglRegion     *roi_region;
+  GeglRectangle   cells;
+  gint            x, y;
+
+  gegl_tile_bitmap_get_cells (bitmap, roi, &cells);
+
+  /* too large to be worth it, these tiles get recomputed when needed */
+  if (cells.width + cells.height > 1024)
+    return;
+
+  roi_region = gegl_region_rectangle (roi);
+
+  for (y = cells.y; y < cells.y + cells.height; y++)
+    for (x = cells.x; x < cells.x + cells.width; x++)
+      {
+        GeglRectangle cell;
+
+        /* only the border of the range can stick out of roi */
+        if (y != cells.y && y != cells.y + cells.height - 1 &&
+            x != cells.x && x != cells.x + cells.width - 1)
+          x = cells.x + cells.width - 1;
+
+        gegl_tile_bitmap_get_cell_rect (bitmap, x, y, &cell);
+
+        if (!gegl_rectangle_contains (roi, &cell) &&
+            gegl_tile_bitmap_get (bitmap, x, y))
+          {
+            GeglRegion *kept = gegl_region_rectangle (&cell);
+
+            gegl_region_subtract (kept, roi_region);
+            gegl_region_union (self->partial_region[level], kept);
+            gegl_region_destroy (kept);
+          }
+      }
+
+  gegl_region_destroy (roi_region);
+}
+
 void
 gegl_cache_invalidate (GeglCache           *self,
                        const GeglRectangle *roi)
@@ -271,7 +335,12 @@ gegl_cache_invalidate (GeglCache           *self,
       GeglRegion *temp_region;
       temp_region = gegl_region_rectangle (&expanded);
       for (i = 0; i < GEGL_CACHE_VALID_MIPMAPS; i++)
-        gegl_region_subtract (self->valid_region[i], temp_region);
+        {
+          if (!gegl_rectangle_is_infinite_plane (&expanded))
+            gegl_cache_keep_border_tiles (self, i, &expanded);
+          gegl_tile_bitmap_remove_rect (self->valid_tiles[i], &expanded);
+          gegl_region_subtract (self->partial_region[i], temp_region);
+        }
       gegl_region_destroy (temp_region);
       g_signal_emit (self, gegl_cache_signals[INVALIDATED], 0,
                      roi, NULL);
@@ -281,9 +350,10 @@ gegl_cache_invalidate (GeglCache           *self,
       GeglRectangle rect = { 0, 0, 0, 0 }; /* should probably be the extent of the cache */
       for (i = 0; i < GEGL_CACHE_VALID_MIPMAPS; i++)
       {
-        if (self->valid_region[i])
-          gegl_region_destroy (self->valid_region[i]);
-        self->valid_region[i] = gegl_region_new ();
+        gegl_tile_bitmap_reset (self->valid_tiles[i]);
+        if (self->partial_region[i])
+          gegl_region_destroy (self->partial_region[i]);
+        self->partial_region[i] = gegl_region_new ();
       }
       g_signal_emit (self, gegl_cache_signals[INVALIDATED], 0,
                      &rect, NULL);
@@ -291,6 +361,32 @@ gegl_cache_invalidate (GeglCache           *self,
   g_mutex_unlock (&self->mutex);
 }
 
+/* called with the mutex held */
+static void
+gegl_cache_add_valid (GeglCache           *self,
+                      const GeglRectangle *rect,
+                      gint                 level)
+{
+  GeglRectangle interior;
+
+  gegl_tile_bitmap_add_rect (self->valid_tiles[level], rect, &interior);
+
+  /* only chunks not aligned with the tile grid need region algebra */
+  if (!gegl_rectangle_equal (&interior, rect))
+    {
+      GeglRegion *fringe = gegl_region_rectangle (rect);
+
+      if (interior.width && interior.height)
+        {
+          GeglRegion *inner = gegl_region_rectangle (&interior);
+          gegl_region_subtract (fringe, inner);
+          gegl_region_destroy (inner);
+        }
+      gegl_region_union (self->partial_region[level], fringe);
+      gegl_region_destroy (fringe);
+    }
+}
+
 void
 gegl_cache_computed (GeglCache           *self,
                      const GeglRectangle *rect,
@@ -302,12 +398,347 @@ gegl_cache_computed (GeglCache           *self,
   g_mutex_lock (&self->mutex);
 
   if (level < GEGL_CACHE_VALID_MIPMAPS)
-    gegl_region_union_with_rect (self->valid_region[level], rect);
+    gegl_cache_add_valid (self, rect, level);
 
   g_signal_emit (self, gegl_cache_signals[COMPUTED], 0, rect, NULL);
   g_mutex_unlock (&self->mutex);
 }
 
+static gboolean
+gegl_cache_cell_is_valid (GeglCache           *self,
+                          gint                 level,
+                          gint                 x,
+                          gint                 y,
+                          const GeglRectangle *rect)
+{
+  GeglRectangle part;
+
+  if (gegl_tile_bitmap_get (self->valid_tiles[level], x, y))
+    return TRUE;
+
+  gegl_tile_bitmap_get_cell_rect (self->valid_tiles[level], x, y, &part);
+  gegl_rectangle_intersect (&part, &part, rect);
+
+  return gegl_region_rect_in (self->partial_region[level], &part) ==
+         GEGL_OVERLAP_RECTANGLE_IN;
+}
+
+/* the extent of the cache scaled to level, nothing outside it is ever
+ * computed
+ */
+static void
+gegl_cache_get_level_extent (GeglCache     *self,
+                             gint           level,
+                             GeglRectangle *extent)
+{
+  *extent = *gegl_buffer_get_extent (GEGL_BUFFER (self));
+
+  if (level > 0 && !gegl_rectangle_is_infinite_plane (extent))
+    {
+      gint64 x1 = extent->x >> level;
+      gint64 y1 = extent->y >> level;
+      gint64 x2 = ((gint64) extent->x + extent->width  + (1 << level) - 1) >> level;
+      gint64 y2 = ((gint64) extent->y + extent->height + (1 << level) - 1) >> level;
+
+      gegl_rectangle_set (extent, x1, y1, x2 - x1, y2 - y1);
+    }
+}
+
+static void
+add_valid_run (const GeglRectangle *rect,
+               gpointer             region)
+{
+  gegl_region_union_with_rect (region, rect);
+}
+
+/* called with the mutex held, returns the parts of rect that still need
+ * to be computed at level, in whole cells clipped to rect and to the
+ * extent of the cache
+ */
+static GeglRegion *
+gegl_cache_get_missing_region (GeglCache           *self,
+                               const GeglRectangle *rect,
+                               gint                 level)
+{
+  GeglTileBitmap *bitmap = self->valid_tiles[level];
+  GeglRegion     *missing;
+  GeglRegion     *valid;
+  GeglRectangle  *partial;
+  gint            n_partial;
+  GeglRectangle   area;
+  gint            i;
+
+  gegl_cache_get_level_extent (self, level, &area);
+  if (!gegl_rectangle_intersect (&area, &area, rect))
+    return gegl_region_new ();
+
+  /* only the allocated blocks of the bitmap and the cells overlapping
+   * the partial region are looked at, area can be huge
+   */
+  valid = gegl_region_new ();
+  gegl_tile_bitmap_foreach_in_rect (bitmap, &area, add_valid_run, valid);
+
+  gegl_region_get_rectangles (self->partial_region[level],
+                              &partial, &n_partial);
+  for (i = 0; i < n_partial; i++)
+    {
+      GeglRectangle part;
+      GeglRectangle cells;
+      gint          x, y;
+
+      if (!gegl_rectangle_intersect (&part, &partial[i], &area))
+        continue;
+
+      gegl_tile_bitmap_get_cells (bitmap, &part, &cells);
+
+      for (y = cells.y; y < cells.y + cells.height; y++)
+        for (x = cells.x; x < cells.x + cells.width; x++)
+          if (!gegl_tile_bitmap_get (bitmap, x, y) &&
+              gegl_cache_cell_is_valid (self, level, x, y, &area))
+            {
+              GeglRectangle cell;
+
+              gegl_tile_bitmap_get_cell_rect (bitmap, x, y, &cell);
+              gegl_rectangle_intersect (&cell, &cell, &area);
+              gegl_region_union_with_rect (valid, &cell);
+            }
+    }
+  g_free (partial);
+
+  missing = gegl_region_rectangle (&area);
+  gegl_region_subtract (missing, valid);
+  gegl_region_destroy (valid);
+
+  return missing;
+}
+
+/**
+ * gegl_cache_is_valid:
+ * @self: a #GeglCache
+ * @rect: the rectangle to check
+ * @level: the mipmap level @rect is at
+ *
+ * Return value: TRUE if all of @rect has been computed at @level, a @rect
+ * reaching outside the extent of @self is never valid.
+ */
+gboolean
+gegl_cache_is_valid (GeglCache           *self,
+                     const GeglRectangle *rect,
+                     gint                 level)
+{
+  GeglRectangle extent;
+  GeglRectangle cells;
+  gboolean      valid;
+  gint          x, y;
+
+  g_return_val_if_fail (GEGL_IS_CACHE (self), FALSE);
+
+  if (level >= GEGL_CACHE_VALID_MIPMAPS)
+    return FALSE;
+  if (rect->width <= 0 || rect->height <= 0)
+    return TRUE;
+
+  g_mutex_lock (&self->mutex);
+
+  /* nothing outside the extent is ever computed, within it the bits of
+   * the bitmap answer for all cells but those partially computed
+   */
+  gegl_cache_get_level_extent (self, level, &extent);
+  valid = gegl_rectangle_contains (&extent, rect);
+
+  if (valid)
+    {
+      gegl_tile_bitmap_get_cells (self->valid_tiles[level], rect, &cells);
+
+      for (y = cells.y; valid && y < cells.y + cells.height; y++)
+        for (x = cells.x; valid && x < cells.x + cells.width; x++)
+          valid = gegl_cache_cell_is_valid (self, level, x, y, rect);
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  return valid;
+}
+
+/**
+ * gegl_cache_get_missing:
+ * @self: a #GeglCache
+ * @rect: the rectangle of interest
+ * @level: the mipmap level @rect is at
+ * @rectangles: (out): return location for a newly allocated array of
+ * rectangles, to be freed with g_free()
+ * @n_rectangles: (out): return location for the number of rectangles
+ *
+ * Lists the parts of @rect within the extent of @self that still need to
+ * be computed at @level, as rectangles following the tile grid of the
+ * cache, clipped to @rect.
+ */
+void
+gegl_cache_get_missing (GeglCache           *self,
+                        const GeglRectangle *rect,
+                        gint                 level,
+                        GeglRectangle      **rectangles,
+                        gint                *n_rectangles)
+{
+  GeglRegion *missing;
+
+  if (level >= GEGL_CACHE_VALID_MIPMAPS)
+    {
+      *rectangles      = g_new (GeglRectangle, 1);
+      (*rectangles)[0] = *rect;
+      *n_rectangles    = 1;
+      return;
+    }
+
+  g_mutex_lock (&self->mutex);
+  missing = gegl_cache_get_missing_region (self, rect, level);
+  g_mutex_unlock (&self->mutex);
+
+  gegl_region_get_rectangles (missing, rectangles, n_rectangles);
+  gegl_region_destroy (missing);
+}
+
+/* called with the mutex held */
+static GeglRegion *
+gegl_cache_get_valid_region (GeglCache *self,
+                             gint       level)
+{
+  GeglRegion *region = gegl_region_copy (self->partial_region[level]);
+
+  gegl_tile_bitmap_foreach (self->valid_tiles[level], add_valid_run, region);
+
+  return region;
+}
+
+#define GEGL_CACHE_VALID_HEADER "GEGL-CACHE-VALID 1"
+
+/**
+ * gegl_cache_attach_file:
+ * @self: a #GeglCache backed by a file
+ * @valid_path: file to keep the valid rectangles of @self in
+ *
+ * Loads the valid rectangles saved in @valid_path, if any, and makes
+ * @self save them there again when it is detached or disposed. The
+ * pixels themselves are expected to persist in the file backing @self.
+ *
+ * Return value: FALSE if @valid_path exists but could not be read, in
+ * which case nothing is loaded.
+ */
+gboolean
+gegl_cache_attach_file (GeglCache   *self,
+                        const gchar *valid_path)
+{
+  gchar    *contents = NULL;
+  gchar   **lines;
+  gboolean  ok = TRUE;
+  gint      i;
+
+  g_return_val_if_fail (GEGL_IS_CACHE (self), FALSE);
+  g_return_val_if_fail (valid_path != NULL, FALSE);
+
+  g_free (self->valid_path);
+  self->valid_path = g_strdup (valid_path);
+
+  if (!g_file_get_contents (valid_path, &contents, NULL, NULL))
+    return !g_file_test (valid_path, G_FILE_TEST_EXISTS);
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  if (!lines[0] || strcmp (lines[0], GEGL_CACHE_VALID_HEADER))
+    ok = FALSE;
+
+  g_mutex_lock (&self->mutex);
+
+  for (i = 1; ok && lines[i]; i++)
+    {
+      GeglRectangle rect;
+      gint          level;
+
+      if (!lines[i][0])
+        continue;
+
+      if (sscanf (lines[i], "%i %i %i %i %i", &level,
+                  &rect.x, &rect.y, &rect.width, &rect.height) != 5 ||
+          level < 0 || level >= GEGL_CACHE_VALID_MIPMAPS)
+        {
+          ok = FALSE;
+          break;
+        }
+
+      gegl_cache_add_valid (self, &rect, level);
+    }
+
+  if (!ok)
+    {
+      for (i = 0; i < GEGL_CACHE_VALID_MIPMAPS; i++)
+        {
+          gegl_tile_bitmap_reset (self->valid_tiles[i]);
+          gegl_region_destroy (self->partial_region[i]);
+          self->partial_region[i] = gegl_region_new ();
+        }
+    }
+
+  g_mutex_unlock (&self->mutex);
+  g_strfreev (lines);
+
+  return ok;
+}
+
+/**
+ * gegl_cache_detach_file:
+ * @self: a #GeglCache
+ *
+ * Flushes the pixels of @self to its backing file and saves its valid
+ * rectangles to the file given to gegl_cache_attach_file(), after which
+ * @self no longer keeps that file up to date.
+ */
+void
+gegl_cache_detach_file (GeglCache *self)
+{
+  GString *str;
+  gint     level;
+
+  g_return_if_fail (GEGL_IS_CACHE (self));
+
+  if (!self->valid_path)
+    return;
+
+  gegl_buffer_flush (GEGL_BUFFER (self));
+
+  str = g_string_new (GEGL_CACHE_VALID_HEADER "\n");
+
+  g_mutex_lock (&self->mutex);
+
+  for (level = 0; level < GEGL_CACHE_VALID_MIPMAPS; level++)
+    {
+      GeglRegion    *region = gegl_cache_get_valid_region (self, level);
+      GeglRectangle *rectangles;
+      gint           n_rectangles;
+      gint           i;
+
+      gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
+
+      for (i = 0; i < n_rectangles; i++)
+        g_string_append_printf (str, "%i %i %i %i %i\n", level,
+                                rectangles[i].x, rectangles[i].y,
+                                rectangles[i].width, rectangles[i].height);
+
+      g_free (rectangles);
+      gegl_region_destroy (region);
+    }
+
+  g_mutex_unlock (&self->mutex);
+
+  if (!g_file_set_contents (self->valid_path, str->str, str->len, NULL))
+    g_warning ("failed to save the valid region of a cache to %s",
+               self->valid_path);
+
+  g_string_free (str, TRUE);
+  g_free (self->valid_path);
+  self->valid_path = NULL;
+}
+
 gboolean
 gegl_buffer_list_valid_rectangles (GeglBuffer     *buffer,
                                    GeglRectangle **rectangles,
@@ -328,8 +759,33 @@ gegl_buffer_list_valid_rectangles (GeglBuffer     *buffer,
   if (level >= GEGL_CACHE_VALID_MIPMAPS)
     level = GEGL_CACHE_VALID_MIPMAPS-1;
 
-  gegl_region_get_rectangles (cache->valid_region[level],
-                              rectangles, n_rectangles);
+  {
+    GeglRegion *region;
+
+    g_mutex_lock (&cache->mutex);
+    region = gegl_cache_get_valid_region (cache, level);
+    g_mutex_unlock (&cache->mutex);
+
+    gegl_region_get_rectangles (region, rectangles, n_rectangles);
+    gegl_region_destroy (region);
+  }
 
   return TRUE;
 }
+
+/* keep the tiles of the cache in memory ahead of the tiles of other
+ * buffers, within the tile-cache-pinned-size budget.
+ */
+void
+gegl_cache_set_pinned (GeglCache *self,
+                       gboolean   pinned)
+{
+  GeglTileStorage *storage;
+
+  g_return_if_fail (GEGL_IS_CACHE (self));
+
+  storage = GEGL_BUFFER (self)->tile_storage;
+
+  if (storage && storage->cache)
+    gegl_tile_handler_cache_set_pinned (storage->cache, pinned);
+}
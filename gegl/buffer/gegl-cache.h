@@ -21,6 +21,7 @@
 
 #include "gegl-buffer.h"
 #include "gegl-buffer-private.h"
+#include "gegl-tile-bitmap.h"
 
 G_BEGIN_DECLS
 
@@ -39,8 +40,15 @@ struct _GeglCache
 {
   GeglBuffer    parent_instance;
 
-  GeglRegion   *valid_region[GEGL_CACHE_VALID_MIPMAPS];
-  GMutex        mutex;
+  /* the tiles that have been completely computed, and the computed parts
+   * of the other tiles, per level
+   */
+  GeglTileBitmap *valid_tiles[GEGL_CACHE_VALID_MIPMAPS];
+  GeglRegion     *partial_region[GEGL_CACHE_VALID_MIPMAPS];
+  GMutex          mutex;
+
+  /* where the valid rectangles are saved for a cache backed by a file */
+  gchar          *valid_path;
 };
 
 struct _GeglCacheClass
@@ -54,6 +62,21 @@ void     gegl_cache_invalidate  (GeglCache           *self,
 void     gegl_cache_computed    (GeglCache           *self,
                                  const GeglRectangle *rect,
                                  gint                 level);
+gboolean gegl_cache_is_valid    (GeglCache           *self,
+                                 const GeglRectangle *rect,
+                                 gint                 level);
+void     gegl_cache_get_missing (GeglCache           *self,
+                                 const GeglRectangle *rect,
+                                 gint                 level,
+                                 GeglRectangle      **rectangles,
+                                 gint                *n_rectangles);
+
+gboolean gegl_cache_attach_file (GeglCache           *self,
+                                 const gchar         *valid_path);
+void     gegl_cache_detach_file (GeglCache           *self);
+
+void     gegl_cache_set_pinned  (GeglCache           *self,
+                                 gboolean             pinned);
 
 G_END_DECLS
 
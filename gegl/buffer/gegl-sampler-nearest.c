@@ -27,6 +27,7 @@
 #include "gegl-tile-storage.h"
 #include "gegl-tile-backend.h"
 #include "gegl-config.h"
+#include "gegl-stats.h"
 #include "gegl-sampler-nearest.h"
 
 enum
@@ -132,7 +133,7 @@ gegl_sampler_get_pixel (GeglSampler    *sampler,
 
   gegl_buffer_lock (sampler->buffer);
   if (gegl_config_threads()>1)
-    g_rec_mutex_lock (&buffer->tile_storage->mutex);
+    gegl_stats_storage_lock (&buffer->tile_storage->mutex);
 
   {
     gint tile_width  = buffer->tile_width;
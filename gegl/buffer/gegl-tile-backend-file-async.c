@@ -636,6 +636,12 @@ gegl_tile_backend_file_write_block (GeglTileBackendFile  *self,
   return TRUE;
 }
 
+gint
+gegl_tile_backend_file_get_queue_size (void)
+{
+  return queue_size;
+}
+
 void
 gegl_tile_backend_file_stats (void)
 {
@@ -76,6 +76,9 @@ GType gegl_tile_backend_file_get_type (void) G_GNUC_CONST;
 
 void  gegl_tile_backend_file_stats    (void);
 
+/* bytes of writes queued for the file backends */
+gint  gegl_tile_backend_file_get_queue_size (void);
+
 gboolean gegl_tile_backend_file_try_lock (GeglTileBackendFile *file);
 gboolean gegl_tile_backend_file_unlock   (GeglTileBackendFile *file);
 
@@ -42,6 +42,8 @@
 #include "gegl-tile-backend-swap.h"
 #include "gegl-debug.h"
 #include "gegl-config.h"
+#include "gegl-stats.h"
+#include "gegl-trace.h"
 
 
 #ifndef HAVE_FSYNC
@@ -213,6 +215,9 @@ gegl_tile_backend_swap_write (ThreadParams *params)
       out_offset    += wrote;
     }
 
+  gegl_stats_inc (GEGL_STATS_SWAP_WRITES);
+  gegl_stats_add (GEGL_STATS_SWAP_WRITTEN_BYTES, params->length - to_be_written);
+
   GEGL_NOTE (GEGL_DEBUG_TILE_BACKEND, "writer thread wrote at %i", (gint)offset);
 }
 
@@ -222,6 +227,7 @@ gegl_tile_backend_swap_writer_thread (gpointer ignored)
   while (TRUE)
     {
       ThreadParams *params;
+      gint          z = 0;
 
       g_mutex_lock (&mutex);
 
@@ -240,6 +246,8 @@ gegl_tile_backend_swap_writer_thread (gpointer ignored)
         {
           in_progress = params;
           params->entry->link = NULL;
+          /* the entry may be freed once the write is done */
+          z = params->entry->z;
         }
 
       g_mutex_unlock (&mutex);
@@ -247,7 +255,9 @@ gegl_tile_backend_swap_writer_thread (gpointer ignored)
       switch (params->operation)
         {
         case OP_WRITE:
+          GEGL_TRACE_START ();
           gegl_tile_backend_swap_write (params);
+          GEGL_TRACE_END ("swap", "write", NULL, z);
           break;
         case OP_TRUNCATE:
           if (ftruncate (out_fd, total) != 0)
@@ -314,6 +324,8 @@ gegl_tile_backend_swap_entry_read (GeglTileBackendSwap *self,
       in_offset = offset;
     }
 
+  GEGL_TRACE_START ();
+
   while (to_be_read > 0)
     {
       GError *error = NULL;
@@ -331,6 +343,16 @@ gegl_tile_backend_swap_entry_read (GeglTileBackendSwap *self,
       in_offset  += byte_read;
     }
 
+  GEGL_TRACE_END ("swap", "read",
+                  GEGL_RECTANGLE (entry->x * gegl_tile_backend_get_tile_width (GEGL_TILE_BACKEND (self)),
+                                  entry->y * gegl_tile_backend_get_tile_height (GEGL_TILE_BACKEND (self)),
+                                  gegl_tile_backend_get_tile_width (GEGL_TILE_BACKEND (self)),
+                                  gegl_tile_backend_get_tile_height (GEGL_TILE_BACKEND (self))),
+                  entry->z);
+
+  gegl_stats_inc (GEGL_STATS_SWAP_READS);
+  gegl_stats_add (GEGL_STATS_SWAP_READ_BYTES, tile_size);
+
   GEGL_NOTE(GEGL_DEBUG_TILE_BACKEND, "read entry %i, %i, %i from %i", entry->x, entry->y, entry->z, (gint)offset);
 }
 
@@ -824,6 +846,12 @@ gegl_tile_backend_swap_class_init (GeglTileBackendSwapClass *klass)
                                 NULL);
 }
 
+guint64
+gegl_tile_backend_swap_get_total (void)
+{
+  return total;
+}
+
 void
 gegl_tile_backend_swap_cleanup (void)
 {
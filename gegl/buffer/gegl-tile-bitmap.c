@@ -0,0 +1,377 @@
+/* This file is part of GEGL.
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib-object.h>
+
+#include "gegl.h"
+#include "gegl-tile-bitmap.h"
+
+#define BLOCK_SHIFT 5
+#define BLOCK_SIZE  (1 << BLOCK_SHIFT) /* cells per block side, one guint32
+                                          per row of cells */
+
+typedef struct
+{
+  gint64  key;
+  gint    x;       /* block coordinates */
+  gint    y;
+  gint    n_set;
+  guint32 rows[BLOCK_SIZE];
+} Block;
+
+struct _GeglTileBitmap
+{
+  gint        cell_width;
+  gint        cell_height;
+  GHashTable *blocks;
+};
+
+static inline gint64
+floor_div (gint64 a,
+           gint64 b)
+{
+  return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+static inline gint64
+ceil_div (gint64 a,
+          gint64 b)
+{
+  return -floor_div (-a, b);
+}
+
+static inline gint64
+block_key (gint x,
+           gint y)
+{
+  return (gint64) (((guint64) (guint32) x << 32) | (guint32) y);
+}
+
+static inline guint32
+range_mask (gint lo,
+            gint hi)
+{
+  if (hi - lo >= BLOCK_SIZE)
+    return 0xffffffff;
+  return ((1u << (hi - lo)) - 1) << lo;
+}
+
+static inline gint
+count_bits (guint32 v)
+{
+  v = v - ((v >> 1) & 0x55555555);
+  v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+  return (((v + (v >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24;
+}
+
+static Block *
+get_block (GeglTileBitmap *bitmap,
+           gint            x,
+           gint            y,
+           gboolean        create)
+{
+  gint64  key   = block_key (x, y);
+  Block  *block = g_hash_table_lookup (bitmap->blocks, &key);
+
+  if (!block && create)
+    {
+      block      = g_slice_new0 (Block);
+      block->key = key;
+      block->x   = x;
+      block->y   = y;
+      g_hash_table_insert (bitmap->blocks, &block->key, block);
+    }
+
+  return block;
+}
+
+static void
+block_free (gpointer block)
+{
+  g_slice_free (Block, block);
+}
+
+GeglTileBitmap *
+gegl_tile_bitmap_new (gint cell_width,
+                      gint cell_height)
+{
+  GeglTileBitmap *bitmap = g_slice_new0 (GeglTileBitmap);
+
+  g_return_val_if_fail (cell_width > 0 && cell_height > 0, NULL);
+
+  bitmap->cell_width  = cell_width;
+  bitmap->cell_height = cell_height;
+  bitmap->blocks      = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                               NULL, block_free);
+  return bitmap;
+}
+
+void
+gegl_tile_bitmap_free (GeglTileBitmap *bitmap)
+{
+  g_hash_table_unref (bitmap->blocks);
+  g_slice_free (GeglTileBitmap, bitmap);
+}
+
+void
+gegl_tile_bitmap_reset (GeglTileBitmap *bitmap)
+{
+  g_hash_table_remove_all (bitmap->blocks);
+}
+
+void
+gegl_tile_bitmap_add_rect (GeglTileBitmap      *bitmap,
+                           const GeglRectangle *rect,
+                           GeglRectangle       *interior)
+{
+  gint64 cx0 = ceil_div  (rect->x, bitmap->cell_width);
+  gint64 cy0 = ceil_div  (rect->y, bitmap->cell_height);
+  gint64 cx1 = floor_div ((gint64) rect->x + rect->width,  bitmap->cell_width);
+  gint64 cy1 = floor_div ((gint64) rect->y + rect->height, bitmap->cell_height);
+  gint64 cy;
+
+  if (interior)
+    {
+      interior->x      = cx0 * bitmap->cell_width;
+      interior->y      = cy0 * bitmap->cell_height;
+      interior->width  = MAX (cx1 - cx0, 0) * bitmap->cell_width;
+      interior->height = MAX (cy1 - cy0, 0) * bitmap->cell_height;
+    }
+
+  if (cx0 >= cx1 || cy0 >= cy1)
+    return;
+
+  for (cy = cy0; cy < cy1; cy++)
+    {
+      gint64 by = floor_div (cy, BLOCK_SIZE);
+      gint64 bx;
+
+      for (bx = floor_div (cx0, BLOCK_SIZE);
+           bx <= floor_div (cx1 - 1, BLOCK_SIZE);
+           bx++)
+        {
+          Block   *block = get_block (bitmap, bx, by, TRUE);
+          gint     lo    = MAX (cx0, bx * BLOCK_SIZE) - bx * BLOCK_SIZE;
+          gint     hi    = MIN (cx1, (bx + 1) * BLOCK_SIZE) - bx * BLOCK_SIZE;
+          guint32  mask  = range_mask (lo, hi);
+          guint32 *row   = &block->rows[cy - by * BLOCK_SIZE];
+
+          block->n_set += count_bits (mask & ~*row);
+          *row |= mask;
+        }
+    }
+}
+
+void
+gegl_tile_bitmap_remove_rect (GeglTileBitmap      *bitmap,
+                              const GeglRectangle *rect)
+{
+  gint64         cx0 = floor_div (rect->x, bitmap->cell_width);
+  gint64         cy0 = floor_div (rect->y, bitmap->cell_height);
+  gint64         cx1 = ceil_div ((gint64) rect->x + rect->width,  bitmap->cell_width);
+  gint64         cy1 = ceil_div ((gint64) rect->y + rect->height, bitmap->cell_height);
+  GHashTableIter iter;
+  gpointer       value;
+
+  if (cx0 >= cx1 || cy0 >= cy1)
+    return;
+
+  /* visit the allocated blocks rather than the cells, rect can be huge */
+  g_hash_table_iter_init (&iter, bitmap->blocks);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      Block   *block = value;
+      gint64   bx0   = (gint64) block->x * BLOCK_SIZE;
+      gint64   by0   = (gint64) block->y * BLOCK_SIZE;
+      gint     lo    = CLAMP (cx0 - bx0, 0, BLOCK_SIZE);
+      gint     hi    = CLAMP (cx1 - bx0, 0, BLOCK_SIZE);
+      gint     top   = CLAMP (cy0 - by0, 0, BLOCK_SIZE);
+      gint     bottom = CLAMP (cy1 - by0, 0, BLOCK_SIZE);
+      guint32  mask;
+      gint     row;
+
+      if (lo >= hi || top >= bottom)
+        continue;
+
+      mask = range_mask (lo, hi);
+
+      for (row = top; row < bottom; row++)
+        {
+          block->n_set -= count_bits (block->rows[row] & mask);
+          block->rows[row] &= ~mask;
+        }
+
+      if (block->n_set == 0)
+        g_hash_table_iter_remove (&iter);
+    }
+}
+
+gboolean
+gegl_tile_bitmap_get (GeglTileBitmap *bitmap,
+                      gint            cell_x,
+                      gint            cell_y)
+{
+  gint64  bx    = floor_div (cell_x, BLOCK_SIZE);
+  gint64  by    = floor_div (cell_y, BLOCK_SIZE);
+  Block  *block = get_block (bitmap, bx, by, FALSE);
+
+  if (!block)
+    return FALSE;
+
+  return (block->rows[cell_y - by * BLOCK_SIZE] >>
+          (cell_x - bx * BLOCK_SIZE)) & 1;
+}
+
+void
+gegl_tile_bitmap_get_cells (GeglTileBitmap      *bitmap,
+                            const GeglRectangle *rect,
+                            GeglRectangle       *cells)
+{
+  gint64 cx0 = floor_div (rect->x, bitmap->cell_width);
+  gint64 cy0 = floor_div (rect->y, bitmap->cell_height);
+  gint64 cx1 = ceil_div ((gint64) rect->x + rect->width,  bitmap->cell_width);
+  gint64 cy1 = ceil_div ((gint64) rect->y + rect->height, bitmap->cell_height);
+
+  cells->x      = cx0;
+  cells->y      = cy0;
+  cells->width  = MAX (cx1 - cx0, 0);
+  cells->height = MAX (cy1 - cy0, 0);
+}
+
+void
+gegl_tile_bitmap_get_cell_rect (GeglTileBitmap *bitmap,
+                                gint            cell_x,
+                                gint            cell_y,
+                                GeglRectangle  *rect)
+{
+  rect->x      = cell_x * bitmap->cell_width;
+  rect->y      = cell_y * bitmap->cell_height;
+  rect->width  = bitmap->cell_width;
+  rect->height = bitmap->cell_height;
+}
+
+void
+gegl_tile_bitmap_foreach (GeglTileBitmap *bitmap,
+                          void          (*func) (const GeglRectangle *rect,
+                                                 gpointer             user_data),
+                          gpointer        user_data)
+{
+  GHashTableIter iter;
+  gpointer       value;
+
+  g_hash_table_iter_init (&iter, bitmap->blocks);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      Block *block = value;
+      gint   row;
+
+      for (row = 0; row < BLOCK_SIZE; row++)
+        {
+          guint32 bits = block->rows[row];
+          gint    col  = 0;
+
+          while (col < BLOCK_SIZE)
+            {
+              GeglRectangle run;
+              gint          start;
+
+              if (!((bits >> col) & 1))
+                {
+                  col++;
+                  continue;
+                }
+
+              start = col;
+              while (col < BLOCK_SIZE && ((bits >> col) & 1))
+                col++;
+
+              run.x      = (block->x * BLOCK_SIZE + start) * bitmap->cell_width;
+              run.y      = (block->y * BLOCK_SIZE + row) * bitmap->cell_height;
+              run.width  = (col - start) * bitmap->cell_width;
+              run.height = bitmap->cell_height;
+
+              func (&run, user_data);
+            }
+        }
+    }
+}
+
+void
+gegl_tile_bitmap_foreach_in_rect (GeglTileBitmap      *bitmap,
+                                  const GeglRectangle *rect,
+                                  void               (*func) (const GeglRectangle *rect,
+                                                              gpointer             user_data),
+                                  gpointer             user_data)
+{
+  gint64         cx0 = floor_div (rect->x, bitmap->cell_width);
+  gint64         cy0 = floor_div (rect->y, bitmap->cell_height);
+  gint64         cx1 = ceil_div ((gint64) rect->x + rect->width,  bitmap->cell_width);
+  gint64         cy1 = ceil_div ((gint64) rect->y + rect->height, bitmap->cell_height);
+  GHashTableIter iter;
+  gpointer       value;
+
+  if (cx0 >= cx1 || cy0 >= cy1)
+    return;
+
+  /* like remove_rect, visit the allocated blocks rather than the cells */
+  g_hash_table_iter_init (&iter, bitmap->blocks);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      Block   *block  = value;
+      gint64   bx0    = (gint64) block->x * BLOCK_SIZE;
+      gint64   by0    = (gint64) block->y * BLOCK_SIZE;
+      gint     lo     = CLAMP (cx0 - bx0, 0, BLOCK_SIZE);
+      gint     hi     = CLAMP (cx1 - bx0, 0, BLOCK_SIZE);
+      gint     top    = CLAMP (cy0 - by0, 0, BLOCK_SIZE);
+      gint     bottom = CLAMP (cy1 - by0, 0, BLOCK_SIZE);
+      gint     row;
+
+      if (lo >= hi || top >= bottom)
+        continue;
+
+      for (row = top; row < bottom; row++)
+        {
+          guint32 bits = block->rows[row] & range_mask (lo, hi);
+          gint    col  = lo;
+
+          while (col < hi)
+            {
+              GeglRectangle run;
+              gint          start;
+
+              if (!((bits >> col) & 1))
+                {
+                  col++;
+                  continue;
+                }
+
+              start = col;
+              while (col < hi && ((bits >> col) & 1))
+                col++;
+
+              run.x      = (bx0 + start) * bitmap->cell_width;
+              run.y      = (by0 + row) * bitmap->cell_height;
+              run.width  = (col - start) * bitmap->cell_width;
+              run.height = bitmap->cell_height;
+
+              gegl_rectangle_intersect (&run, &run, rect);
+              func (&run, user_data);
+            }
+        }
+    }
+}
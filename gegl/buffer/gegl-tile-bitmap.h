@@ -0,0 +1,89 @@
+/* This file is part of GEGL.
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_TILE_BITMAP_H__
+#define __GEGL_TILE_BITMAP_H__
+
+#include <glib.h>
+#include "gegl-buffer.h"
+
+G_BEGIN_DECLS
+
+/* A sparse set of cells on a grid of cell_width×cell_height pixels, stored
+ * as bitmaps of 32×32 cells allocated on demand. Setting, clearing and
+ * testing a cell is O(1), setting and clearing a rectangle is linear in the
+ * number of rows of cells it spans.
+ */
+typedef struct _GeglTileBitmap GeglTileBitmap;
+
+GeglTileBitmap *gegl_tile_bitmap_new        (gint                 cell_width,
+                                             gint                 cell_height);
+void            gegl_tile_bitmap_free       (GeglTileBitmap      *bitmap);
+
+/* unset all cells */
+void            gegl_tile_bitmap_reset      (GeglTileBitmap      *bitmap);
+
+/* set the cells completely inside rect, storing the pixel rectangle they
+ * cover in interior if it is not NULL
+ */
+void            gegl_tile_bitmap_add_rect   (GeglTileBitmap      *bitmap,
+                                             const GeglRectangle *rect,
+                                             GeglRectangle       *interior);
+
+/* unset the cells touched by rect, rect may be an infinite plane */
+void            gegl_tile_bitmap_remove_rect(GeglTileBitmap      *bitmap,
+                                             const GeglRectangle *rect);
+
+gboolean        gegl_tile_bitmap_get        (GeglTileBitmap      *bitmap,
+                                             gint                 cell_x,
+                                             gint                 cell_y);
+
+/* the cells (given in cell coordinates) spanned by rect, partially
+ * covered cells included
+ */
+void            gegl_tile_bitmap_get_cells  (GeglTileBitmap      *bitmap,
+                                             const GeglRectangle *rect,
+                                             GeglRectangle       *cells);
+
+/* the pixel rectangle of a cell */
+void            gegl_tile_bitmap_get_cell_rect
+                                            (GeglTileBitmap      *bitmap,
+                                             gint                 cell_x,
+                                             gint                 cell_y,
+                                             GeglRectangle       *rect);
+
+/* call func with the pixel rectangle of every run of set cells within a
+ * row, rows are visited in no particular order
+ */
+void            gegl_tile_bitmap_foreach    (GeglTileBitmap      *bitmap,
+                                             void               (*func) (const GeglRectangle *rect,
+                                                                         gpointer             user_data),
+                                             gpointer             user_data);
+
+/* like gegl_tile_bitmap_foreach, for the runs touching rect clipped to
+ * it, in time proportional to the number of allocated blocks rather than
+ * to the size of rect
+ */
+void            gegl_tile_bitmap_foreach_in_rect
+                                            (GeglTileBitmap      *bitmap,
+                                             const GeglRectangle *rect,
+                                             void               (*func) (const GeglRectangle *rect,
+                                                                         gpointer             user_data),
+                                             gpointer             user_data);
+
+G_END_DECLS
+
+#endif /* __GEGL_TILE_BITMAP_H__ */
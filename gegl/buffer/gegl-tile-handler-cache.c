@@ -30,12 +30,12 @@
 #include "gegl-tile-handler-cache.h"
 #include "gegl-tile-storage.h"
 #include "gegl-debug.h"
+#include "gegl-stats.h"
+#include "gegl-trace.h"
+#include "gegl-tile-trace.h"
 
 #include "gegl-buffer-cl-cache.h"
 
-/*
-#define GEGL_DEBUG_CACHE_HITS
-*/
 
 typedef struct CacheItem
 {
@@ -47,6 +47,8 @@ typedef struct CacheItem
   gint      x;                   /* The coordinates this tile was cached for */
   gint      y;
   gint      z;
+
+  gboolean  pinned;              /* Whether the item is in the pinned_queue */
 } CacheItem;
 
 #define LINK_GET_ITEM(link) \
@@ -89,17 +91,82 @@ static void       gegl_tile_handler_cache_invalidate (GeglTileHandlerCache *cach
 
 static GMutex       mutex                 = { 0, };
 static GQueue      *cache_queue           = NULL;
+static GQueue      *pinned_queue          = NULL; /* tiles of pinned handlers,
+                                                     only trimmed when
+                                                     cache_queue is empty */
 static gint         cache_wash_percentage = 20;
 static guint64      cache_total           = 0; /* approximate amount of bytes stored */
-#ifdef GEGL_DEBUG_CACHE_HITS
-static gint         cache_hits            = 0;
-static gint         cache_misses          = 0;
-#endif
+static guint64      pinned_total          = 0; /* the part of it in pinned_queue */
 
 
 G_DEFINE_TYPE (GeglTileHandlerCache, gegl_tile_handler_cache, GEGL_TYPE_TILE_HANDLER)
 
 
+/* add item as the most recently used tile of the queue of its handler,
+ * the least recently used pinned tiles beyond the pinned budget are moved
+ * to the regular queue. Called with the mutex held.
+ */
+static void
+cache_item_push (CacheItem *item)
+{
+  if (!item->handler->pinned)
+    {
+      item->pinned = FALSE;
+      g_queue_push_head_link (cache_queue, &item->link);
+      return;
+    }
+
+  item->pinned  = TRUE;
+  pinned_total += item->tile->size;
+  g_queue_push_head_link (pinned_queue, &item->link);
+
+  while (pinned_total > gegl_config ()->tile_cache_pinned_size)
+    {
+      GList     *link    = g_queue_pop_tail_link (pinned_queue);
+      CacheItem *demoted = LINK_GET_ITEM (link);
+
+      pinned_total    -= demoted->tile->size;
+      demoted->pinned  = FALSE;
+      g_queue_push_head_link (cache_queue, link);
+    }
+}
+
+/* write the tiles of cache in queue to its backend */
+static void
+cache_queue_store (GQueue               *queue,
+                   GeglTileHandlerCache *cache)
+{
+  GList *link;
+
+  for (link = g_queue_peek_head_link (queue); link; link = link->next)
+    {
+      CacheItem *item = LINK_GET_ITEM (link);
+      GeglTile  *tile = item->tile;
+
+      if (tile != NULL &&
+          item->handler == cache)
+        {
+          gegl_tile_store (tile);
+        }
+    }
+}
+
+/* remove item from the queue it is in, called with the mutex held */
+static void
+cache_item_unlink (CacheItem *item)
+{
+  if (item->pinned)
+    {
+      pinned_total -= item->tile->size;
+      g_queue_unlink (pinned_queue, &item->link);
+    }
+  else
+    {
+      g_queue_unlink (cache_queue, &item->link);
+    }
+}
+
+
 static void
 gegl_tile_handler_cache_class_init (GeglTileHandlerCacheClass *class)
 {
@@ -132,12 +199,13 @@ gegl_tile_handler_cache_reinit (GeglTileHandlerCache *cache)
   if (!cache->count)
     return;
 
-  g_mutex_lock (&mutex);
+  gegl_stats_cache_lock (&mutex);
   {
     g_hash_table_iter_init (&iter, cache->items);
     while (g_hash_table_iter_next (&iter, &key, &value))
     {
       item = (CacheItem *) value;
+      cache_item_unlink (item);
       if (item->tile)
         {
           cache_total -= item->tile->size;
@@ -145,7 +213,6 @@ gegl_tile_handler_cache_reinit (GeglTileHandlerCache *cache)
           gegl_tile_unref (item->tile);
           cache->count--;
         }
-      g_queue_unlink (cache_queue, &item->link);
       g_hash_table_iter_remove (&iter);
       g_slice_free (CacheItem, item);
     }
@@ -184,19 +251,31 @@ gegl_tile_handler_cache_get_tile_command (GeglTileSource *tile_store,
     gegl_buffer_cl_cache_flush2 (cache, NULL);
 
   tile = gegl_tile_handler_cache_get_tile (cache, x, y, z);
+
+  if (G_UNLIKELY (gegl_tile_trace_enabled))
+    gegl_tile_trace_record (cache->tile_storage, GEGL_TILE_TRACE_GET,
+                            x, y, z, tile != NULL);
+
   if (tile)
     {
-#ifdef GEGL_DEBUG_CACHE_HITS
-      cache_hits++;
-#endif
+      gegl_stats_inc (GEGL_STATS_TILE_CACHE_HITS);
       return tile;
     }
-#ifdef GEGL_DEBUG_CACHE_HITS
-  cache_misses++;
-#endif
+  gegl_stats_inc (GEGL_STATS_TILE_CACHE_MISSES);
 
   if (source)
-    tile = gegl_tile_source_get_tile (source, x, y, z);
+    {
+      GEGL_TRACE_START ();
+
+      tile = gegl_tile_source_get_tile (source, x, y, z);
+
+      GEGL_TRACE_END ("tile", "fetch",
+                      GEGL_RECTANGLE (x * cache->tile_storage->tile_width,
+                                      y * cache->tile_storage->tile_height,
+                                      cache->tile_storage->tile_width,
+                                      cache->tile_storage->tile_height),
+                      z);
+    }
 
   if (tile)
     gegl_tile_handler_cache_insert (cache, tile, x, y, z);
@@ -219,24 +298,17 @@ gegl_tile_handler_cache_command (GeglTileSource  *tile_store,
     {
       case GEGL_TILE_FLUSH:
         {
-          GList     *link;
-
           if (gegl_cl_is_accelerated ())
             gegl_buffer_cl_cache_flush2 (cache, NULL);
 
           if (cache->count)
             {
-              for (link = g_queue_peek_head_link (cache_queue); link; link = link->next)
-                {
-                  CacheItem *item = LINK_GET_ITEM (link);
-                  GeglTile  *tile = item->tile;
-
-                  if (tile != NULL &&
-                      item->handler == cache)
-                    {
-                      gegl_tile_store (tile);
-                    }
-                }
+              /* a pinned handler has tiles in both queues, those beyond
+               * the pinned budget are in the regular one
+               */
+              cache_queue_store (cache_queue, cache);
+              if (cache->pinned)
+                cache_queue_store (pinned_queue, cache);
             }
         }
         break;
@@ -266,7 +338,15 @@ gegl_tile_handler_cache_command (GeglTileSource  *tile_store,
       case GEGL_TILE_REFETCH:
         gegl_tile_handler_cache_invalidate (cache, x, y, z);
         break;
+      case GEGL_TILE_SET:
+        if (G_UNLIKELY (gegl_tile_trace_enabled))
+          gegl_tile_trace_record (cache->tile_storage, GEGL_TILE_TRACE_SET,
+                                  x, y, z, FALSE);
+        break;
       case GEGL_TILE_VOID:
+        if (G_UNLIKELY (gegl_tile_trace_enabled))
+          gegl_tile_trace_record (cache->tile_storage, GEGL_TILE_TRACE_VOID,
+                                  x, y, z, FALSE);
         gegl_tile_handler_cache_void (cache, x, y, z);
         break;
       case GEGL_TILE_REINIT:
@@ -341,12 +421,12 @@ gegl_tile_handler_cache_get_tile (GeglTileHandlerCache *cache,
   if (cache->count == 0)
     return NULL;
 
-  g_mutex_lock (&mutex);
+  gegl_stats_cache_lock (&mutex);
   result = cache_lookup (cache, x, y, z);
   if (result)
     {
-      g_queue_unlink (cache_queue, &result->link);
-      g_queue_push_head_link (cache_queue, &result->link);
+      cache_item_unlink (result);
+      cache_item_push (result);
       g_mutex_unlock (&mutex);
       while (result->tile == NULL)
       {
@@ -385,7 +465,7 @@ drop_hot_tile (GeglTile *tile)
   if (storage)
     {
       if (gegl_config_threads()>1)
-        g_rec_mutex_lock (&storage->mutex);
+        gegl_stats_storage_lock (&storage->mutex);
 
       if (storage->hot_tile == tile)
         {
@@ -405,6 +485,10 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
 
   link = g_queue_pop_tail_link (cache_queue);
 
+  /* pinned tiles only go when nothing else is left */
+  if (link == NULL)
+    link = g_queue_pop_tail_link (pinned_queue);
+
   if (link != NULL)
     {
       CacheItem *last_writable = LINK_GET_ITEM (link);
@@ -412,9 +496,12 @@ gegl_tile_handler_cache_trim (GeglTileHandlerCache *cache)
 
       g_hash_table_remove (last_writable->handler->items, last_writable);
       cache_total -= tile->size;
+      if (last_writable->pinned)
+        pinned_total -= tile->size;
       drop_hot_tile (tile);
       gegl_tile_unref (tile);
       g_slice_free (CacheItem, last_writable);
+      gegl_stats_inc (GEGL_STATS_TILE_CACHE_EVICTIONS);
       return TRUE;
     }
 
@@ -429,7 +516,7 @@ gegl_tile_handler_cache_invalidate (GeglTileHandlerCache *cache,
 {
   CacheItem *item;
 
-  g_mutex_lock (&mutex);
+  gegl_stats_cache_lock (&mutex);
   item = cache_lookup (cache, x, y, z);
   if (item)
     {
@@ -437,9 +524,9 @@ gegl_tile_handler_cache_invalidate (GeglTileHandlerCache *cache,
       drop_hot_tile (item->tile);
       item->tile->tile_storage = NULL;
       gegl_tile_mark_as_stored (item->tile); /* to cheat it out of being stored */
+      cache_item_unlink (item);
       gegl_tile_unref (item->tile);
 
-      g_queue_unlink (cache_queue, &item->link);
       g_hash_table_remove (cache->items, item);
 
       g_slice_free (CacheItem, item);
@@ -456,12 +543,12 @@ gegl_tile_handler_cache_void (GeglTileHandlerCache *cache,
 {
   CacheItem *item;
 
-  g_mutex_lock (&mutex);
+  gegl_stats_cache_lock (&mutex);
   item = cache_lookup (cache, x, y, z);
   if (item)
     {
       cache_total -= item->tile->size;
-      g_queue_unlink (cache_queue, &item->link);
+      cache_item_unlink (item);
       g_hash_table_remove (cache->items, item);
       cache->count--;
     }
@@ -505,9 +592,9 @@ gegl_tile_handler_cache_insert (GeglTileHandlerCache *cache,
 
   /* XXX: this is a window when the tile is a zero tile during update */
 
-  g_mutex_lock (&mutex);
+  gegl_stats_cache_lock (&mutex);
   cache_total  += item->tile->size;
-  g_queue_push_head_link (cache_queue, &item->link);
+  cache_item_push (item);
 
   cache->count ++;
 
@@ -515,10 +602,7 @@ gegl_tile_handler_cache_insert (GeglTileHandlerCache *cache,
 
   while (cache_total > gegl_config()->tile_cache_size)
     {
-#ifdef GEGL_DEBUG_CACHE_HITS
-      GEGL_NOTE(GEGL_DEBUG_CACHE, "cache_total:"G_GUINT64_FORMAT" > cache_size:"G_GUINT64_FORMAT, cache_total, gegl_config()->tile_cache_size);
-      GEGL_NOTE(GEGL_DEBUG_CACHE, "%f%% hit:%i miss:%i  %i]", cache_hits*100.0/(cache_hits+cache_misses), cache_hits, cache_misses, g_queue_get_length (cache_queue));
-#endif
+      GEGL_NOTE(GEGL_DEBUG_CACHE, "cache_total:%"G_GUINT64_FORMAT" > cache_size:%"G_GUINT64_FORMAT, cache_total, gegl_config()->tile_cache_size);
       gegl_tile_handler_cache_trim (cache);
     }
   g_mutex_unlock (&mutex);
@@ -577,6 +661,14 @@ gegl_tile_cache_init (void)
 {
   if (cache_queue == NULL)
     cache_queue = g_queue_new ();
+  if (pinned_queue == NULL)
+    pinned_queue = g_queue_new ();
+}
+
+guint64
+gegl_tile_cache_get_total (void)
+{
+  return cache_total;
 }
 
 void
@@ -588,4 +680,49 @@ gegl_tile_cache_destroy (void)
       g_queue_free (cache_queue);
     }
   cache_queue = NULL;
+
+  if (pinned_queue)
+    {
+      while (g_queue_pop_head_link (pinned_queue));
+      g_queue_free (pinned_queue);
+    }
+  pinned_queue = NULL;
+  pinned_total = 0;
+}
+
+/* Pinned handlers keep their tiles in memory ahead of the tiles of other
+ * handlers, as long as all pinned tiles fit in the tile-cache-pinned-size
+ * budget of GeglConfig.
+ */
+void
+gegl_tile_handler_cache_set_pinned (GeglTileHandlerCache *cache,
+                                    gboolean              pinned)
+{
+  GHashTableIter iter;
+  gpointer       value;
+
+  g_return_if_fail (GEGL_IS_TILE_HANDLER_CACHE (cache));
+
+  pinned = pinned != FALSE;
+
+  gegl_stats_cache_lock (&mutex);
+
+  if (cache->pinned == pinned)
+    {
+      g_mutex_unlock (&mutex);
+      return;
+    }
+
+  cache->pinned = pinned;
+
+  g_hash_table_iter_init (&iter, cache->items);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      CacheItem *item = value;
+
+      cache_item_unlink (item);
+      cache_item_push (item);
+    }
+
+  g_mutex_unlock (&mutex);
 }
@@ -42,6 +42,7 @@ struct _GeglTileHandlerCache
   GeglTileStorage *tile_storage;
   GHashTable      *items;
   int              count; /* number of items held by cache */
+  gboolean         pinned; /* whether tiles are kept ahead of other tiles */
 };
 
 struct _GeglTileHandlerCacheClass
@@ -57,5 +58,8 @@ void              gegl_tile_handler_cache_insert   (GeglTileHandlerCache *cache,
                                                     gint                  x,
                                                     gint                  y,
                                                     gint                  z);
+void              gegl_tile_handler_cache_set_pinned
+                                                   (GeglTileHandlerCache *cache,
+                                                    gboolean              pinned);
 
 #endif
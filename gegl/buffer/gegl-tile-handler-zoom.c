@@ -33,6 +33,7 @@
 #include "gegl-tile-backend.h"
 #include "gegl-tile-storage.h"
 #include "gegl-algorithms.h"
+#include "gegl-stats.h"
 
 
 G_DEFINE_TYPE (GeglTileHandlerZoom, gegl_tile_handler_zoom,
@@ -131,6 +132,7 @@ get_tile (GeglTileSource *gegl_tile_source,
     g_assert (tile == NULL);
 
     tile = gegl_tile_handler_create_tile (GEGL_TILE_HANDLER (zoom), x, y, z);
+    gegl_stats_inc (GEGL_STATS_ZOOM_TILES);
 
     gegl_tile_lock (tile);
 
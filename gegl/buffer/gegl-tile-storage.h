@@ -50,6 +50,8 @@ struct _GeglTileStorage
 
   GeglTile      *hot_tile; /* cached tile for speeding up gegl_buffer_get_pixel
                               and gegl_buffer_set_pixel (1x1 sized gets/sets)*/
+
+  guint          trace_id; /* number in the tile trace, 0 until recorded */
 };
 
 struct _GeglTileStorageClass
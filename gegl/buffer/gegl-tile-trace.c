@@ -0,0 +1,153 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib-object.h>
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+#include "gegl-buffer-types.h"
+#include "gegl-config.h"
+#include "gegl-tile-storage.h"
+#include "gegl-tile-trace.h"
+
+/* records buffered before a write, the file is written under the mutex */
+#define TRACE_RECORDS 4096
+
+gboolean gegl_tile_trace_enabled = FALSE;
+
+static GMutex               trace_mutex;
+static FILE                *trace_file     = NULL;
+static gint64               trace_epoch    = 0;
+static guint                trace_storages = 0;
+static GeglTileTraceRecord  records[TRACE_RECORDS];
+static guint                n_records      = 0;
+
+static void
+trace_flush (void)
+{
+  if (n_records &&
+      fwrite (records, sizeof (GeglTileTraceRecord), n_records,
+              trace_file) != n_records)
+    {
+      g_warning ("GEGL_TILE_TRACE: writing failed, recording stopped");
+      gegl_tile_trace_enabled = FALSE;
+    }
+
+  n_records = 0;
+}
+
+void
+gegl_tile_trace_init (void)
+{
+  const gchar         *path = g_getenv ("GEGL_TILE_TRACE");
+  GeglTileTraceHeader  header;
+
+  if (! path || ! *path)
+    return;
+
+  trace_file = g_fopen (path, "wb");
+
+  if (! trace_file)
+    {
+      g_warning ("GEGL_TILE_TRACE: unable to write %s", path);
+      return;
+    }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, GEGL_TILE_TRACE_MAGIC, sizeof (header.magic));
+  header.version     = GEGL_TILE_TRACE_VERSION;
+  header.record_size = sizeof (GeglTileTraceRecord);
+  header.cache_size  = gegl_config ()->tile_cache_size;
+
+  fwrite (&header, sizeof (header), 1, trace_file);
+
+  trace_epoch             = g_get_monotonic_time ();
+  gegl_tile_trace_enabled = TRUE;
+}
+
+void
+gegl_tile_trace_exit (void)
+{
+  if (! trace_file)
+    return;
+
+  g_mutex_lock (&trace_mutex);
+
+  if (gegl_tile_trace_enabled)
+    trace_flush ();
+  gegl_tile_trace_enabled = FALSE;
+
+  fclose (trace_file);
+  trace_file = NULL;
+
+  g_mutex_unlock (&trace_mutex);
+}
+
+static void
+trace_append (guint32         storage,
+              GeglTileTraceOp op,
+              gint            x,
+              gint            y,
+              gint            z,
+              gboolean        hit)
+{
+  GeglTileTraceRecord *record = &records[n_records++];
+
+  record->time    = g_get_monotonic_time () - trace_epoch;
+  record->storage = storage;
+  record->x       = x;
+  record->y       = y;
+  record->z       = CLAMP (z, 0, G_MAXUINT8);
+  record->op      = op;
+  record->hit     = hit ? 1 : 0;
+  record->padding = 0;
+
+  if (n_records == TRACE_RECORDS)
+    trace_flush ();
+}
+
+void
+gegl_tile_trace_record (GeglTileStorage *storage,
+                        GeglTileTraceOp  op,
+                        gint             x,
+                        gint             y,
+                        gint             z,
+                        gboolean         hit)
+{
+  if (! storage)
+    return;
+
+  g_mutex_lock (&trace_mutex);
+
+  if (gegl_tile_trace_enabled)
+    {
+      if (! storage->trace_id)
+        {
+          storage->trace_id = ++trace_storages;
+          trace_append (storage->trace_id, GEGL_TILE_TRACE_STORAGE,
+                        storage->tile_size, 0, 0, FALSE);
+        }
+
+      trace_append (storage->trace_id, op, x, y, z, hit);
+    }
+
+  g_mutex_unlock (&trace_mutex);
+}
@@ -0,0 +1,87 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_TILE_TRACE_H__
+#define __GEGL_TILE_TRACE_H__
+
+#include <glib.h>
+
+#include "gegl-buffer-types.h"
+
+G_BEGIN_DECLS
+
+/***
+ * Tile access traces are recorded when GEGL_TILE_TRACE is set to the path
+ * of a file, they log every tile fetched, written, stored and voided
+ * through the tile cache so cache sizes and eviction policies can be
+ * evaluated offline, with tools/gegl-tile-replay.
+ *
+ * The file is a GeglTileTraceHeader followed by GeglTileTraceRecords, in
+ * the byte order of the machine that recorded it. The first record of a
+ * tile storage is a GEGL_TILE_TRACE_STORAGE one giving its tile size.
+ */
+
+#define GEGL_TILE_TRACE_MAGIC   "GEGLTILE"
+#define GEGL_TILE_TRACE_VERSION 1
+
+typedef enum
+{
+  GEGL_TILE_TRACE_STORAGE, /* a new storage, x is its tile size in bytes */
+  GEGL_TILE_TRACE_GET,     /* a tile fetched, hit tells if it was cached */
+  GEGL_TILE_TRACE_WRITE,   /* a tile modified */
+  GEGL_TILE_TRACE_SET,     /* a tile stored to the backend */
+  GEGL_TILE_TRACE_VOID     /* a tile discarded */
+} GeglTileTraceOp;
+
+typedef struct
+{
+  gchar   magic[8];
+  guint32 version;
+  guint32 record_size;
+  guint64 cache_size;  /* tile-cache-size when recording started */
+} GeglTileTraceHeader;
+
+typedef struct
+{
+  guint64 time;        /* microseconds since recording started */
+  guint32 storage;     /* numbered from 1 in order of first use */
+  gint32  x;
+  gint32  y;
+  guint8  z;
+  guint8  op;          /* a GeglTileTraceOp */
+  guint8  hit;
+  guint8  padding;
+} GeglTileTraceRecord;
+
+extern gboolean gegl_tile_trace_enabled;
+
+/* read GEGL_TILE_TRACE, called from gegl_init */
+void gegl_tile_trace_init   (void);
+
+/* finish the trace file, called from gegl_exit */
+void gegl_tile_trace_exit   (void);
+
+/* record @op on the tile at @x, @y, @z of @storage */
+void gegl_tile_trace_record (GeglTileStorage *storage,
+                             GeglTileTraceOp  op,
+                             gint             x,
+                             gint             y,
+                             gint             z,
+                             gboolean         hit);
+
+G_END_DECLS
+
+#endif
@@ -34,6 +34,8 @@
 #include "gegl-buffer-private.h"
 #include "gegl-tile-source.h"
 #include "gegl-tile-storage.h"
+#include "gegl-stats.h"
+#include "gegl-tile-trace.h"
 
 static GMutex cowmutex = { 0, }; /* copy on write is maintained in a doubly linked
                                   * list, which must be protected by a mutex
@@ -67,7 +69,10 @@ void gegl_tile_unref (GeglTile *tile)
           if (tile->destroy_notify)
             {
               if (tile->destroy_notify == (void*)&free_data_directly)
-                gegl_free (tile->data);
+                {
+                  gegl_free (tile->data);
+                  gegl_stats_add_tile_bytes (-(gssize) tile->size);
+                }
               else
                 tile->destroy_notify (tile->destroy_notify_data);
             }
@@ -140,6 +145,9 @@ gegl_tile_new (gint size)
   tile->data = gegl_malloc (size);
   tile->size = size;
 
+  gegl_stats_inc (GEGL_STATS_TILE_ALLOCATIONS);
+  gegl_stats_add_tile_bytes (size);
+
   return tile;
 }
 
@@ -176,6 +184,8 @@ gegl_tile_unclone (GeglTile *tile)
         {
           tile->data = gegl_memdup (tile->data, tile->size);
         }
+      gegl_stats_inc (GEGL_STATS_TILE_ALLOCATIONS);
+      gegl_stats_add_tile_bytes (tile->size);
       tile->destroy_notify           = (void*)&free_data_directly;
       tile->destroy_notify_data      = NULL;
     }
@@ -247,6 +257,10 @@ gegl_tile_unlock (GeglTile *tile)
         gegl_tile_void_pyramid (tile);
       }
       tile->rev++;
+
+    if (G_UNLIKELY (gegl_tile_trace_enabled))
+      gegl_tile_trace_record (tile->tile_storage, GEGL_TILE_TRACE_WRITE,
+                              tile->x, tile->y, tile->z, FALSE);
   }
 
   g_atomic_int_add (&tile->lock, -1);
@@ -267,7 +281,7 @@ gegl_tile_is_stored (GeglTile *tile)
 void
 gegl_tile_void (GeglTile *tile)
 {
-  g_rec_mutex_lock (&tile->tile_storage->mutex);
+  gegl_stats_storage_lock (&tile->tile_storage->mutex);
   gegl_tile_mark_as_stored (tile);
 
   if (tile->z == 0)
@@ -282,7 +296,7 @@ gboolean gegl_tile_store (GeglTile *tile)
     return TRUE;
   if (tile->tile_storage == NULL)
     return FALSE;
-  g_rec_mutex_lock (&tile->tile_storage->mutex);
+  gegl_stats_storage_lock (&tile->tile_storage->mutex);
   if (gegl_tile_is_stored (tile))
   {
     g_rec_mutex_unlock (&tile->tile_storage->mutex);
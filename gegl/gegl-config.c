@@ -45,7 +45,11 @@ enum
   PROP_THREADS,
   PROP_USE_OPENCL,
   PROP_QUEUE_SIZE,
-  PROP_APPLICATION_LICENSE
+  PROP_APPLICATION_LICENSE,
+  PROP_CACHE_BUDGET,
+  PROP_DISK_CACHE,
+  PROP_DISK_CACHE_SIZE,
+  PROP_TILE_CACHE_PINNED_SIZE
 };
 
 gint _gegl_threads = 1; 
@@ -100,6 +104,22 @@ gegl_config_get_property (GObject    *gobject,
         g_value_set_string (value, config->application_license);
         break;
 
+      case PROP_CACHE_BUDGET:
+        g_value_set_uint64 (value, config->cache_budget);
+        break;
+
+      case PROP_DISK_CACHE:
+        g_value_set_string (value, config->disk_cache);
+        break;
+
+      case PROP_DISK_CACHE_SIZE:
+        g_value_set_uint64 (value, config->disk_cache_size);
+        break;
+
+      case PROP_TILE_CACHE_PINNED_SIZE:
+        g_value_set_uint64 (value, config->tile_cache_pinned_size);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -150,6 +170,20 @@ gegl_config_set_property (GObject      *gobject,
           g_free (config->application_license);
         config->application_license = g_value_dup_string (value);
         break;
+      case PROP_CACHE_BUDGET:
+        config->cache_budget = g_value_get_uint64 (value);
+        break;
+      case PROP_DISK_CACHE:
+        if (config->disk_cache)
+          g_free (config->disk_cache);
+        config->disk_cache = g_value_dup_string (value);
+        break;
+      case PROP_DISK_CACHE_SIZE:
+        config->disk_cache_size = g_value_get_uint64 (value);
+        break;
+      case PROP_TILE_CACHE_PINNED_SIZE:
+        config->tile_cache_pinned_size = g_value_get_uint64 (value);
+        break;
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -167,6 +201,9 @@ gegl_config_finalize (GObject *gobject)
   if (config->application_license)
     g_free (config->application_license);
 
+  if (config->disk_cache)
+    g_free (config->disk_cache);
+
   G_OBJECT_CLASS (gegl_config_parent_class)->finalize (gobject);
 }
 
@@ -261,6 +298,38 @@ gegl_config_class_init (GeglConfigClass *klass)
                                                         "",
                                                         G_PARAM_READWRITE |
                                                         G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_CACHE_BUDGET,
+                                   g_param_spec_uint64 ("cache-budget",
+                                                        "Cache budget",
+                                                        "bytes of node caches to keep, picking nodes by measured cost and reuse, 0 caches every node",
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_DISK_CACHE,
+                                   g_param_spec_string ("disk-cache",
+                                                        "Disk cache",
+                                                        "directory where node caches persist between processes, keyed by the graph producing them",
+                                                        NULL,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_DISK_CACHE_SIZE,
+                                   g_param_spec_uint64 ("disk-cache-size",
+                                                        "Disk cache size",
+                                                        "bytes the disk cache may take before least recently used entries are removed",
+                                                        0, G_MAXUINT64, (guint64) 1024 * 1024 * 1024,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
+
+  g_object_class_install_property (gobject_class, PROP_TILE_CACHE_PINNED_SIZE,
+                                   g_param_spec_uint64 ("tile-cache-pinned-size",
+                                                        "Pinned tile cache size",
+                                                        "bytes of the tile cache reserved for the tiles of pinned caches, like those of gegl:cache nodes with pinned set",
+                                                        0, G_MAXUINT64, 128 * 1024 * 1024,
+                                                        G_PARAM_READWRITE |
+                                                        G_PARAM_CONSTRUCT));
 }
 
 static void
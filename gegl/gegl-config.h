@@ -44,6 +44,10 @@ struct _GeglConfig
   gboolean use_opencl;
   gint     queue_size;
   gchar   *application_license;
+  guint64  cache_budget;
+  gchar   *disk_cache;
+  guint64  disk_cache_size;
+  guint64  tile_cache_pinned_size;
 };
 
 struct _GeglConfigClass
@@ -31,13 +31,43 @@
 #include "graph/gegl-connection.h"
 #include "graph/gegl-visitable.h"
 #include "graph/gegl-visitor.h"
+#include "process/gegl-list-visitor.h"
 #include "gegl-dot.h"
 #include "gegl-dot-visitor.h"
 #include "gegl.h"
 
-void
-gegl_dot_util_add_node (GString  *string,
-                        GeglNode *node)
+typedef struct
+{
+  gint64 max_usecs; /* of the most expensive node, which is drawn red */
+} GeglDotProfile;
+
+gboolean gegl_node_profiling = FALSE;
+
+static void
+gegl_dot_add_profile_rows (GString  *string,
+                           GeglNode *node)
+{
+  const GeglNodeProfile *profile = &node->profile;
+  gdouble                msecs   = profile->usecs / 1000.0;
+
+  g_string_append_printf (string, "time=%.2f ms | ", msecs);
+  g_string_append_printf (string, "pixels=%" G_GINT64_FORMAT " | ",
+                          profile->pixels);
+  if (profile->usecs > 0)
+    g_string_append_printf (string, "%.2f Mpx/s | ",
+                            (gdouble) profile->pixels / profile->usecs);
+  if (profile->requests > 0)
+    g_string_append_printf (string, "cache hits=%.0f%% (%u/%u) | ",
+                            100.0 * profile->cache_hits / profile->requests,
+                            profile->cache_hits, profile->requests);
+  g_string_append_printf (string, "peak=%.1f KiB | ",
+                          profile->peak_bytes / 1024.0);
+}
+
+static void
+gegl_dot_add_node (GString              *string,
+                   GeglNode             *node,
+                   const GeglDotProfile *profile)
 {
   g_string_append_printf (string, "op_%p [fontsize=\"10\" label=\"", node);
 
@@ -75,6 +105,10 @@ gegl_dot_util_add_node (GString  *string,
   /* The second row is the operation name such as gegl:translate */
   g_string_append_printf (string, "%s |", gegl_node_get_debug_name (node));
 
+  /* When profiling, followed by the totals of the renderings so far */
+  if (profile)
+    gegl_dot_add_profile_rows (string, node);
+
   /* The next rows are property names and their values */
   if (1)
     {
@@ -145,9 +179,27 @@ gegl_dot_util_add_node (GString  *string,
   }
 
   g_string_append_printf (string, "}\"");
+
+  /* Expensive nodes fade from white to red */
+  if (profile && profile->max_usecs > 0 && node->profile.usecs > 0)
+    {
+      gint cool = 255 - 255 * node->profile.usecs / profile->max_usecs;
+
+      g_string_append_printf (string,
+                              " style=\"filled\" fillcolor=\"#ff%02x%02x\" ",
+                              cool, cool);
+    }
+
   g_string_append_printf (string, "shape=\"record\"];\n");
 }
 
+void
+gegl_dot_util_add_node (GString  *string,
+                        GeglNode *node)
+{
+  gegl_dot_add_node (string, node, NULL);
+}
+
 void
 gegl_dot_util_add_node_sink_edges (GString  *string,
                                    GeglNode *node)
@@ -182,9 +234,10 @@ gegl_dot_util_add_connection (GString        *string,
 }
 
 static void
-gegl_dot_add_graph (GString     *string,
-                    GeglNode    *node,
-                    const gchar *label)
+gegl_dot_add_graph (GString              *string,
+                    GeglNode             *node,
+                    const gchar          *label,
+                    const GeglDotProfile *profile)
 {
   GeglNode *graph = node;
 
@@ -209,12 +262,12 @@ gegl_dot_add_graph (GString     *string,
                   *p = '_';
                 p++;
               }
-            gegl_dot_add_graph (string, node, name);
+            gegl_dot_add_graph (string, node, name, profile);
             g_free (name);
           }
         else
           {
-            gegl_dot_util_add_node (string, node);
+            gegl_dot_add_node (string, node, profile);
           }
 
         entry = g_slist_next (entry);
@@ -241,17 +294,31 @@ gegl_dot_add_graph (GString     *string,
 }
 
 
+static GList *
+gegl_dot_get_dependencies (GeglNode *node)
+{
+  GeglListVisitor *list_visitor = g_object_new (GEGL_TYPE_LIST_VISITOR, NULL);
+  GList           *nodes;
+
+  nodes = gegl_list_visitor_get_dfs_path (list_visitor, GEGL_VISITABLE (node));
+  g_object_unref (list_visitor);
+
+  return nodes;
+}
+
 /**
  * gegl_dot_add_node_and_dependencies:
  * @string:
  * @node:
+ * @profile: (allow-none):
  *
  * Adds @node to the graph, and all nodes that @node depends on both
  * directly and indirectly. There is no grouping of subgraphs.
  **/
 static void
-gegl_dot_add_node_and_dependencies (GString  *string,
-                                    GeglNode *node)
+gegl_dot_add_node_and_dependencies (GString              *string,
+                                    GeglNode             *node,
+                                    const GeglDotProfile *profile)
 {
   GeglDotVisitor *dot_visitor;
   GeglPad        *pad;
@@ -265,8 +332,21 @@ gegl_dot_add_node_and_dependencies (GString  *string,
                                          string);
 
   /* Add the nodes */
-  gegl_visitor_bfs_traverse (GEGL_VISITOR (dot_visitor),
-                             GEGL_VISITABLE (node));
+  if (profile)
+    {
+      GList *nodes = gegl_dot_get_dependencies (node);
+      GList *iter;
+
+      for (iter = nodes; iter; iter = g_list_next (iter))
+        gegl_dot_add_node (string, iter->data, profile);
+
+      g_list_free (nodes);
+    }
+  else
+    {
+      gegl_visitor_bfs_traverse (GEGL_VISITOR (dot_visitor),
+                                 GEGL_VISITABLE (node));
+    }
 
   /* Add the edges */
   pad = gegl_node_get_pad (node, "output");
@@ -294,23 +374,97 @@ gegl_dot_add_node_and_dependencies (GString  *string,
   g_object_unref (dot_visitor);
 }
 
-gchar *
-gegl_to_dot (GeglNode *node)
+static void
+gegl_dot_profile_scan (GeglDotProfile *profile,
+                       GeglNode       *node)
+{
+  GList *nodes;
+  GList *iter;
+
+  if (node->is_graph)
+    {
+      GSList *children = gegl_node_get_children (node);
+      GSList *child;
+
+      for (child = children; child; child = g_slist_next (child))
+        gegl_dot_profile_scan (profile, child->data);
+
+      g_slist_free (children);
+      return;
+    }
+
+  nodes = gegl_dot_get_dependencies (node);
+
+  for (iter = nodes; iter; iter = g_list_next (iter))
+    {
+      GeglNode *dependency = iter->data;
+
+      profile->max_usecs = MAX (profile->max_usecs, dependency->profile.usecs);
+    }
+
+  g_list_free (nodes);
+}
+
+static gchar *
+gegl_to_dot_real (GeglNode             *node,
+                  const GeglDotProfile *profile)
 {
   GString *string;
 
   string = g_string_new ("digraph gegl { graph [ rankdir = \"BT\" fontsize = \"10\" ];\n");
 
   if (node->is_graph)
-    gegl_dot_add_graph (string, node, "GEGL");
+    gegl_dot_add_graph (string, node, "GEGL", profile);
   else
-    gegl_dot_add_node_and_dependencies (string, node);
+    gegl_dot_add_node_and_dependencies (string, node, profile);
 
   g_string_append (string, "}\n");
 
   return g_string_free (string, FALSE);
 }
 
+gchar *
+gegl_to_dot (GeglNode *node)
+{
+  return gegl_to_dot_real (node, NULL);
+}
+
+/**
+ * gegl_dot_set_profiling:
+ * @enabled: whether to profile the nodes
+ *
+ * Starts or stops adding up the renderings of every node for
+ * gegl_to_dot_profile(). Profiling is off by default, it costs a lock
+ * of the node for every chunk processed.
+ **/
+void
+gegl_dot_set_profiling (gboolean enabled)
+{
+  gegl_node_profiling = enabled;
+}
+
+/**
+ * gegl_to_dot_profile:
+ * @node: Node to depict graph for.
+ *
+ * Like gegl_to_dot(), with each node also annotated with the totals of
+ * its renderings while profiling was enabled with
+ * gegl_dot_set_profiling(): the time spent processing it, the pixels it
+ * computed and the resulting throughput, how many of the requests for
+ * it were served from its cache and the largest output it handed on.
+ * Nodes are filled with a shade of red proportional to their time,
+ * the most expensive one being the reddest.
+ **/
+gchar *
+gegl_to_dot_profile (GeglNode *node)
+{
+  GeglDotProfile profile = { 0, };
+
+  gegl_dot_profile_scan (&profile, node);
+
+  return gegl_to_dot_real (node, &profile);
+}
+
 /**
  * gegl_dot_node_to_png_default:
  * @node:
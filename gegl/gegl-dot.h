@@ -23,6 +23,8 @@
 
 
 gchar *gegl_to_dot                       (GeglNode       *node);
+gchar *gegl_to_dot_profile               (GeglNode       *node);
+void   gegl_dot_set_profiling            (gboolean        enabled);
 void   gegl_dot_util_add_node            (GString        *string,
                                           GeglNode       *node);
 void   gegl_dot_util_add_node_sink_edges (GString        *string,
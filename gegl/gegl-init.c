@@ -89,6 +89,9 @@ guint gegl_debug_flags = 0;
 #include "gegl-types.h"
 #include "gegl-types-internal.h"
 #include "gegl-instrument.h"
+#include "gegl-trace.h"
+#include "gegl-stats.h"
+#include "buffer/gegl-tile-trace.h"
 #include "gegl-init.h"
 #include "gegl-init-private.h"
 #include "module/geglmodule.h"
@@ -97,6 +100,7 @@ guint gegl_debug_flags = 0;
 #include "operation/gegl-operation.h"
 #include "operation/gegl-operations.h"
 #include "operation/gegl-operation-handlers-private.h"
+#include "operation/gegl-operation-context-private.h"
 #include "buffer/gegl-buffer-private.h"
 #include "buffer/gegl-buffer-iterator-private.h"
 #include "buffer/gegl-tile-backend-ram.h"
@@ -112,6 +116,7 @@ static gboolean  gegl_post_parse_hook (GOptionContext *context,
 
 
 static GeglConfig   *config = NULL;
+static GeglStats    *stats  = NULL;
 
 static GeglModuleDB *module_db   = NULL;
 
@@ -353,6 +358,18 @@ static void gegl_config_parse_env (GeglConfig *config)
   if (g_getenv ("GEGL_CACHE_SIZE"))
     config->tile_cache_size = atoll(g_getenv("GEGL_CACHE_SIZE"))* 1024*1024;
 
+  if (g_getenv ("GEGL_CACHE_PINNED_SIZE"))
+    config->tile_cache_pinned_size = atoll(g_getenv("GEGL_CACHE_PINNED_SIZE"))* 1024*1024;
+
+  if (g_getenv ("GEGL_CACHE_BUDGET"))
+    config->cache_budget = atoll(g_getenv("GEGL_CACHE_BUDGET"))* 1024*1024;
+
+  if (g_getenv ("GEGL_DISK_CACHE"))
+    g_object_set (config, "disk-cache", g_getenv ("GEGL_DISK_CACHE"), NULL);
+
+  if (g_getenv ("GEGL_DISK_CACHE_SIZE"))
+    config->disk_cache_size = atoll(g_getenv("GEGL_DISK_CACHE_SIZE"))* 1024*1024;
+
   if (g_getenv ("GEGL_CHUNK_SIZE"))
     config->chunk_size = atoi(g_getenv("GEGL_CHUNK_SIZE"));
 
@@ -399,6 +416,13 @@ static void gegl_config_parse_env (GeglConfig *config)
     g_object_set (config, "swap", g_getenv ("GEGL_SWAP"), NULL);
 }
 
+GeglStats *gegl_stats (void)
+{
+  if (!stats)
+    stats = g_object_new (GEGL_TYPE_STATS, NULL);
+  return stats;
+}
+
 GeglConfig *gegl_config (void)
 {
   if (!config)
@@ -459,6 +483,9 @@ gegl_exit (void)
 
   GEGL_INSTRUMENT_START()
 
+  /* before babl_exit (), the report names the formats */
+  gegl_stats_conversions_exit ();
+
   gegl_tile_backend_swap_cleanup ();
   gegl_tile_cache_destroy ();
   gegl_operation_gtype_cleanup ();
@@ -467,6 +494,7 @@ gegl_exit (void)
   gegl_cl_cleanup ();
 
   gegl_temp_buffer_free ();
+  gegl_operation_context_pool_cleanup ();
 
   if (module_db != NULL)
     {
@@ -478,6 +506,9 @@ gegl_exit (void)
 
   GEGL_INSTRUMENT_END ("gegl", "gegl_exit")
 
+  gegl_trace_exit ();
+  gegl_tile_trace_exit ();
+
   /* used when tracking buffer and tile leaks */
   if (g_getenv ("GEGL_DEBUG_BUFS") != NULL)
     {
@@ -538,6 +569,7 @@ gegl_exit (void)
     }
   g_object_unref (config);
   config = NULL;
+  g_clear_object (&stats);
   global_time = 0;
 }
 
@@ -626,6 +658,9 @@ gegl_post_parse_hook (GOptionContext *context,
   if (g_getenv ("GEGL_DEBUG_TIME") != NULL)
     gegl_instrument_enable ();
 
+  gegl_trace_init ();
+  gegl_stats_conversions_init ();
+
   gegl_instrument ("gegl", "gegl_init", 0);
 
   config = gegl_config ();
@@ -680,6 +715,9 @@ gegl_post_parse_hook (GOptionContext *context,
 
   gegl_init_swap_dir ();
 
+  /* after the options, the trace records the tile-cache-size used */
+  gegl_tile_trace_init ();
+
   GEGL_INSTRUMENT_START();
 
   gegl_operation_gtype_init ();
@@ -94,6 +94,80 @@ void          gegl_load_module_directory (const gchar *path);
  */
 GeglConfig   *gegl_config                (void);
 
+/**
+ * gegl_stats:
+ *
+ * Returns a GeglStats object with read-only properties counting what the
+ * buffer subsystem did since GEGL was initialized, like tile cache hits
+ * and swap traffic.  The counters are always kept and are cheap to poll.
+ *
+ * Return value: (transfer none): a #GeglStats
+ */
+GeglStats    *gegl_stats                 (void);
+
+/**
+ * gegl_stats_get_blit_latency:
+ * @size: the size class of the blits
+ * @phase: the phase of the blits, or GEGL_LATENCY_TOTAL
+ * @percentile: the percentile to return, such as 50.0 or 99.0
+ *
+ * Returns the latency in microseconds that @percentile percent of the
+ * gegl_node_blit() calls of @size spent at most in @phase, with a
+ * precision of about 3%, or 0 if there were no such blits. Blits made
+ * while rendering a #GeglProcessor or another blit are not recorded.
+ */
+gint64        gegl_stats_get_blit_latency   (GeglBlitSize     size,
+                                             GeglLatencyPhase phase,
+                                             gdouble          percentile);
+
+/**
+ * gegl_stats_get_blit_count:
+ * @size: the size class of the blits
+ *
+ * Returns the number of gegl_node_blit() calls of @size recorded in the
+ * latency histograms.
+ */
+guint         gegl_stats_get_blit_count     (GeglBlitSize     size);
+
+/**
+ * gegl_stats_reset_blit_latency:
+ *
+ * Clears the blit latency histograms, for instance to only measure the
+ * interaction that follows.
+ */
+void          gegl_stats_reset_blit_latency (void);
+
+/**
+ * gegl_stats_set_conversion_tracking:
+ * @enabled: whether to account babl conversions
+ *
+ * Starts or stops timing the babl conversions made by buffer iterators,
+ * gegl_buffer_get(), gegl_buffer_set() and point operations, per source
+ * and destination format.  Tracking costs two clock reads per
+ * conversion, it is off unless GEGL_CONVERSION_STATS is set.
+ */
+void          gegl_stats_set_conversion_tracking (gboolean enabled);
+
+/**
+ * gegl_stats_get_conversion_report:
+ * @max_entries: the number of format pairs to list, or 0 for all
+ *
+ * Returns a report of the babl conversions accounted while tracking was
+ * enabled, one line per place of conversion and source and destination
+ * format, most time consuming first, with the bytes converted counted in
+ * the source format.
+ *
+ * Return value: (transfer full): a newly allocated string
+ */
+gchar        *gegl_stats_get_conversion_report   (gint max_entries);
+
+/**
+ * gegl_stats_reset_conversions:
+ *
+ * Clears what was accounted of babl conversions so far.
+ */
+void          gegl_stats_reset_conversions       (void);
+
 gboolean gegl_is_main_thread (void);
 
 G_END_DECLS
@@ -33,6 +33,7 @@ struct _Timing
 {
   gchar  *name;
   long    usecs;
+  gint64  pixels;
   Timing *parent;
   Timing *children;
   Timing *next;
@@ -104,10 +105,9 @@ gegl_instrument_enable (void)
   gegl_instrument_enabled = TRUE;
 }
 
-void
-real_gegl_instrument (const gchar *parent_name,
-                      const gchar *name,
-                      long         usecs)
+static Timing *
+timing_get (const gchar *parent_name,
+            const gchar *name)
 {
   Timing *iter;
   Timing *parent;
@@ -120,7 +120,7 @@ real_gegl_instrument (const gchar *parent_name,
   parent = timing_find (root, parent_name);
   if (!parent)
     {
-      real_gegl_instrument (root->name, parent_name, 0);
+      timing_get (root->name, parent_name);
       parent = timing_find (root, parent_name);
     }
   g_assert (parent);
@@ -133,7 +133,27 @@ real_gegl_instrument (const gchar *parent_name,
       iter->next       = parent->children;
       parent->children = iter;
     }
-  iter->usecs += usecs;
+  return iter;
+}
+
+void
+real_gegl_instrument (const gchar *parent_name,
+                      const gchar *name,
+                      long         usecs)
+{
+  timing_get (parent_name, name)->usecs += usecs;
+}
+
+void
+real_gegl_instrument_pixels (const gchar *parent_name,
+                             const gchar *name,
+                             long         usecs,
+                             gint64       pixels)
+{
+  Timing *iter = timing_get (parent_name, name);
+
+  iter->usecs  += usecs;
+  iter->pixels += pixels;
 }
 
 
@@ -321,6 +341,12 @@ gegl_instrument_utf8 (void)
       g_free (buf);
       s = tab_to (s, BAR_COL);
       s = bar (s, BAR_WIDTH, normalized (iter->usecs));
+      if (iter->pixels > 0 && iter->usecs > 0)
+        {
+          buf = g_strdup_printf (" %.2f Mpx/s", 1.0 * iter->pixels / iter->usecs);
+          s   = g_string_append (s, buf);
+          g_free (buf);
+        }
       s = g_string_append (s, "\n");
 
       if (timing_depth (iter_next (iter)) < timing_depth (iter))
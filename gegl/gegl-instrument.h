@@ -36,6 +36,15 @@ void gegl_instrument_enable   (void);
                                  } \
   }
 
+/* like GEGL_INSTRUMENT_END, also accounting for the number of pixels
+ * produced in the time-slice, permitting throughput to be reported */
+#define GEGL_INSTRUMENT_END_PIXELS(parent, scale, pixels) \
+    if (gegl_instrument_enabled) { \
+      real_gegl_instrument_pixels (parent, scale, gegl_ticks () - _gegl_instrument_ticks, \
+                                   pixels); \
+                                 } \
+  }
+
 /* store a timing instrumentation (parent is expected to exist,
  * and to keep it's own record of the time-slice reported) */
 #define gegl_instrument(parent, scale, usecs) \
@@ -47,6 +56,11 @@ void real_gegl_instrument     (const gchar *parent,
                                const gchar *scale,
                                long         usecs);
 
+void real_gegl_instrument_pixels (const gchar *parent,
+                                  const gchar *scale,
+                                  long         usecs,
+                                  gint64       pixels);
+
 /* create a utf8 string with bar charts for where time disappears
  * during a gegl-run
  */
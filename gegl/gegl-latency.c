@@ -0,0 +1,211 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <math.h>
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "gegl.h"
+#include "gegl-latency.h"
+
+#define SUB GEGL_LATENCY_SUB_BUCKETS
+
+static GeglLatencyHistogram blit_histograms[GEGL_BLIT_SIZE_N_CLASSES]
+                                           [GEGL_LATENCY_N_PHASES];
+
+static GPrivate current_timing = G_PRIVATE_INIT (NULL);
+
+static guint
+bucket_index (guint64 usecs)
+{
+  guint shift = 0;
+
+  if (usecs < 2 * SUB)
+    return usecs;
+
+  while ((usecs >> shift) >= 2 * SUB)
+    shift++;
+
+  return MIN ((shift + 1) * SUB + (usecs >> shift) - SUB,
+              GEGL_LATENCY_BUCKETS - 1);
+}
+
+/* the highest value ending up in bucket @index */
+static gint64
+bucket_value (guint index)
+{
+  guint shift;
+
+  if (index < 2 * SUB)
+    return index;
+
+  shift = index / SUB - 1;
+
+  return ((gint64) (index % SUB + SUB + 1) << shift) - 1;
+}
+
+void
+gegl_latency_histogram_record (GeglLatencyHistogram *histogram,
+                               gint64                usecs)
+{
+  g_atomic_int_inc ((gint *) &histogram->counts[bucket_index (MAX (usecs, 0))]);
+}
+
+guint
+gegl_latency_histogram_count (const GeglLatencyHistogram *histogram)
+{
+  guint count = 0;
+  gint  i;
+
+  for (i = 0; i < GEGL_LATENCY_BUCKETS; i++)
+    count += g_atomic_int_get ((gint *) &histogram->counts[i]);
+
+  return count;
+}
+
+gint64
+gegl_latency_histogram_percentile (const GeglLatencyHistogram *histogram,
+                                   gdouble                     percentile)
+{
+  guint  count = gegl_latency_histogram_count (histogram);
+  guint  rank;
+  guint  seen  = 0;
+  gint   i;
+
+  if (! count)
+    return 0;
+
+  rank = (guint) ceil (CLAMP (percentile, 0.0, 100.0) / 100.0 * count);
+  rank = MAX (rank, 1);
+
+  for (i = 0; i < GEGL_LATENCY_BUCKETS; i++)
+    {
+      seen += g_atomic_int_get ((gint *) &histogram->counts[i]);
+
+      if (seen >= rank)
+        return bucket_value (i);
+    }
+
+  return bucket_value (GEGL_LATENCY_BUCKETS - 1);
+}
+
+void
+gegl_latency_histogram_reset (GeglLatencyHistogram *histogram)
+{
+  gint i;
+
+  for (i = 0; i < GEGL_LATENCY_BUCKETS; i++)
+    g_atomic_int_set ((gint *) &histogram->counts[i], 0);
+}
+
+GeglLatencyTiming *
+gegl_latency_timing_push (GeglLatencyTiming *timing)
+{
+  GeglLatencyTiming *previous = g_private_get (&current_timing);
+
+  memset (timing, 0, sizeof (GeglLatencyTiming));
+  g_private_set (&current_timing, timing);
+
+  return previous;
+}
+
+void
+gegl_latency_timing_pop (GeglLatencyTiming *timing,
+                         GeglLatencyTiming *previous)
+{
+  g_private_set (&current_timing, previous);
+
+  if (previous)
+    {
+      gint i;
+
+      for (i = 0; i < GEGL_LATENCY_N_PHASES; i++)
+        previous->phases[i] += timing->phases[i];
+    }
+}
+
+void
+gegl_latency_add (GeglLatencyPhase phase,
+                  gint64           usecs)
+{
+  GeglLatencyTiming *timing = g_private_get (&current_timing);
+
+  if (timing)
+    timing->phases[phase] += usecs;
+}
+
+static GeglBlitSize
+blit_size (const GeglRectangle *roi)
+{
+  gint64 pixels = (gint64) roi->width * roi->height;
+
+  if (pixels <= 128 * 128)
+    return GEGL_BLIT_SIZE_TILE;
+  else if (pixels <= 512 * 512)
+    return GEGL_BLIT_SIZE_SMALL;
+  else if (pixels <= 2048 * 2048)
+    return GEGL_BLIT_SIZE_VIEWPORT;
+
+  return GEGL_BLIT_SIZE_LARGE;
+}
+
+void
+gegl_latency_record_blit (const GeglRectangle     *roi,
+                          gint64                   total,
+                          const GeglLatencyTiming *timing)
+{
+  GeglLatencyHistogram *histograms = blit_histograms[blit_size (roi)];
+  gint                  i;
+
+  for (i = 0; i < GEGL_LATENCY_N_PHASES; i++)
+    if (i != GEGL_LATENCY_TOTAL)
+      gegl_latency_histogram_record (&histograms[i], timing->phases[i]);
+
+  gegl_latency_histogram_record (&histograms[GEGL_LATENCY_TOTAL], total);
+}
+
+gint64
+gegl_stats_get_blit_latency (GeglBlitSize     size,
+                             GeglLatencyPhase phase,
+                             gdouble          percentile)
+{
+  g_return_val_if_fail (size < GEGL_BLIT_SIZE_N_CLASSES, 0);
+  g_return_val_if_fail (phase < GEGL_LATENCY_N_PHASES, 0);
+
+  return gegl_latency_histogram_percentile (&blit_histograms[size][phase],
+                                            percentile);
+}
+
+guint
+gegl_stats_get_blit_count (GeglBlitSize size)
+{
+  g_return_val_if_fail (size < GEGL_BLIT_SIZE_N_CLASSES, 0);
+
+  return gegl_latency_histogram_count (&blit_histograms[size][GEGL_LATENCY_TOTAL]);
+}
+
+void
+gegl_stats_reset_blit_latency (void)
+{
+  gint size, phase;
+
+  for (size = 0; size < GEGL_BLIT_SIZE_N_CLASSES; size++)
+    for (phase = 0; phase < GEGL_LATENCY_N_PHASES; phase++)
+      gegl_latency_histogram_reset (&blit_histograms[size][phase]);
+}
@@ -0,0 +1,69 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GEGL_LATENCY_H
+#define GEGL_LATENCY_H
+
+/* Latency histograms of blits and processor work, in the style of
+ * HdrHistogram: microsecond values are bucketed with 32 linear
+ * sub-buckets per power of two, a relative precision of about 3% from
+ * 1 microsecond to hours, in a fixed amount of memory. Recording is a
+ * single atomic increment.
+ */
+
+#define GEGL_LATENCY_SUB_BUCKETS 32
+#define GEGL_LATENCY_BUCKETS     (33 * GEGL_LATENCY_SUB_BUCKETS)
+
+typedef struct
+{
+  guint counts[GEGL_LATENCY_BUCKETS];
+} GeglLatencyHistogram;
+
+/* time spent in each phase of a blit or processor work, accumulated by
+ * gegl_latency_add () between push and pop on the calling thread
+ */
+typedef struct
+{
+  gint64 phases[GEGL_LATENCY_N_PHASES];
+} GeglLatencyTiming;
+
+void   gegl_latency_histogram_record     (GeglLatencyHistogram       *histogram,
+                                          gint64                      usecs);
+guint  gegl_latency_histogram_count      (const GeglLatencyHistogram *histogram);
+gint64 gegl_latency_histogram_percentile (const GeglLatencyHistogram *histogram,
+                                          gdouble                     percentile);
+void   gegl_latency_histogram_reset      (GeglLatencyHistogram       *histogram);
+
+/* make @timing, cleared, the one gegl_latency_add () accumulates into on
+ * this thread, returning the one it replaces
+ */
+GeglLatencyTiming *gegl_latency_timing_push (GeglLatencyTiming *timing);
+
+/* restore @previous, adding what @timing accumulated to it */
+void               gegl_latency_timing_pop  (GeglLatencyTiming *timing,
+                                             GeglLatencyTiming *previous);
+
+/* account @usecs to @phase of the blit or work in progress on this thread,
+ * if any
+ */
+void               gegl_latency_add         (GeglLatencyPhase   phase,
+                                             gint64             usecs);
+
+/* record a finished blit of @roi, @total long and made of @timing */
+void               gegl_latency_record_blit (const GeglRectangle     *roi,
+                                             gint64                   total,
+                                             const GeglLatencyTiming *timing);
+
+#endif
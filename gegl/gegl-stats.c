@@ -0,0 +1,754 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include <glib-object.h>
+#include <glib/gprintf.h>
+
+#include "gegl.h"
+#include "gegl-types-internal.h"
+#include "gegl-stats.h"
+#include "buffer/gegl-buffer-private.h"
+#include "buffer/gegl-tile-backend-file.h"
+
+G_DEFINE_TYPE (GeglStats, gegl_stats, G_TYPE_OBJECT)
+
+volatile gsize _gegl_stats_counters[GEGL_STATS_N_COUNTERS];
+
+enum
+{
+  PROP_0,
+  PROP_TILE_CACHE_TOTAL,
+  PROP_TILE_CACHE_HITS,
+  PROP_TILE_CACHE_MISSES,
+  PROP_TILE_CACHE_HIT_RATIO,
+  PROP_TILE_CACHE_EVICTIONS,
+  PROP_SWAP_TOTAL,
+  PROP_SWAP_READS,
+  PROP_SWAP_WRITES,
+  PROP_SWAP_READ_BYTES,
+  PROP_SWAP_WRITTEN_BYTES,
+  PROP_FILE_QUEUE_SIZE,
+  PROP_ZOOM_TILES,
+  PROP_TILE_ALLOCATIONS,
+  PROP_ITERATOR_INDIRECT,
+  PROP_TILE_BYTES,
+  PROP_TILE_BYTES_PEAK,
+  PROP_BUFFERS_CREATED,
+  PROP_CONVERSION_BYTES,
+  PROP_STORAGE_LOCK_WAITS,
+  PROP_STORAGE_LOCK_WAIT_USECS,
+  PROP_CACHE_LOCK_WAITS,
+  PROP_CACHE_LOCK_WAIT_USECS
+};
+
+static guint64
+counter_get (GeglStatsCounter counter)
+{
+  return (gsize) g_atomic_pointer_get (&_gegl_stats_counters[counter]);
+}
+
+static void
+gegl_stats_get_property (GObject    *gobject,
+                         guint       property_id,
+                         GValue     *value,
+                         GParamSpec *pspec)
+{
+  switch (property_id)
+    {
+      case PROP_TILE_CACHE_TOTAL:
+        g_value_set_uint64 (value, gegl_tile_cache_get_total ());
+        break;
+
+      case PROP_TILE_CACHE_HITS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_CACHE_HITS));
+        break;
+
+      case PROP_TILE_CACHE_MISSES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_CACHE_MISSES));
+        break;
+
+      case PROP_TILE_CACHE_HIT_RATIO:
+        {
+          guint64 hits   = counter_get (GEGL_STATS_TILE_CACHE_HITS);
+          guint64 misses = counter_get (GEGL_STATS_TILE_CACHE_MISSES);
+
+          g_value_set_double (value, hits + misses ?
+                                     (gdouble) hits / (hits + misses) : 0.0);
+        }
+        break;
+
+      case PROP_TILE_CACHE_EVICTIONS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_CACHE_EVICTIONS));
+        break;
+
+      case PROP_SWAP_TOTAL:
+        g_value_set_uint64 (value, gegl_tile_backend_swap_get_total ());
+        break;
+
+      case PROP_SWAP_READS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_SWAP_READS));
+        break;
+
+      case PROP_SWAP_WRITES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_SWAP_WRITES));
+        break;
+
+      case PROP_SWAP_READ_BYTES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_SWAP_READ_BYTES));
+        break;
+
+      case PROP_SWAP_WRITTEN_BYTES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_SWAP_WRITTEN_BYTES));
+        break;
+
+      case PROP_FILE_QUEUE_SIZE:
+        g_value_set_uint64 (value, MAX (gegl_tile_backend_file_get_queue_size (), 0));
+        break;
+
+      case PROP_ZOOM_TILES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_ZOOM_TILES));
+        break;
+
+      case PROP_TILE_ALLOCATIONS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_ALLOCATIONS));
+        break;
+
+      case PROP_ITERATOR_INDIRECT:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_ITERATOR_INDIRECT));
+        break;
+
+      case PROP_TILE_BYTES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_BYTES));
+        break;
+
+      case PROP_TILE_BYTES_PEAK:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_TILE_BYTES_PEAK));
+        break;
+
+      case PROP_BUFFERS_CREATED:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_BUFFERS_CREATED));
+        break;
+
+      case PROP_CONVERSION_BYTES:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_CONVERSION_BYTES));
+        break;
+
+      case PROP_STORAGE_LOCK_WAITS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_STORAGE_LOCK_WAITS));
+        break;
+
+      case PROP_STORAGE_LOCK_WAIT_USECS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_STORAGE_LOCK_WAIT_USECS));
+        break;
+
+      case PROP_CACHE_LOCK_WAITS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_CACHE_LOCK_WAITS));
+        break;
+
+      case PROP_CACHE_LOCK_WAIT_USECS:
+        g_value_set_uint64 (value, counter_get (GEGL_STATS_CACHE_LOCK_WAIT_USECS));
+        break;
+
+      default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
+        break;
+    }
+}
+
+static void
+install_counter (GObjectClass *gobject_class,
+                 guint         property_id,
+                 const gchar  *name,
+                 const gchar  *nick,
+                 const gchar  *blurb)
+{
+  g_object_class_install_property (gobject_class, property_id,
+                                   g_param_spec_uint64 (name, nick, blurb,
+                                                        0, G_MAXUINT64, 0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gegl_stats_class_init (GeglStatsClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->get_property = gegl_stats_get_property;
+
+  install_counter (gobject_class, PROP_TILE_CACHE_TOTAL,
+                   "tile-cache-total", "Tile cache total",
+                   "approximate number of bytes held by the tile cache");
+
+  install_counter (gobject_class, PROP_TILE_CACHE_HITS,
+                   "tile-cache-hits", "Tile cache hits",
+                   "number of tiles found in the tile cache");
+
+  install_counter (gobject_class, PROP_TILE_CACHE_MISSES,
+                   "tile-cache-misses", "Tile cache misses",
+                   "number of tiles not found in the tile cache");
+
+  g_object_class_install_property (gobject_class, PROP_TILE_CACHE_HIT_RATIO,
+                                   g_param_spec_double ("tile-cache-hit-ratio",
+                                                        "Tile cache hit ratio",
+                                                        "the share of tile lookups that hit the tile cache",
+                                                        0.0, 1.0, 0.0,
+                                                        G_PARAM_READABLE |
+                                                        G_PARAM_STATIC_STRINGS));
+
+  install_counter (gobject_class, PROP_TILE_CACHE_EVICTIONS,
+                   "tile-cache-evictions", "Tile cache evictions",
+                   "number of tiles dropped from the tile cache to stay within tile-cache-size");
+
+  install_counter (gobject_class, PROP_SWAP_TOTAL,
+                   "swap-total", "Swap total",
+                   "size in bytes of the swap file");
+
+  install_counter (gobject_class, PROP_SWAP_READS,
+                   "swap-reads", "Swap reads",
+                   "number of tiles read back from swap");
+
+  install_counter (gobject_class, PROP_SWAP_WRITES,
+                   "swap-writes", "Swap writes",
+                   "number of tiles written to swap");
+
+  install_counter (gobject_class, PROP_SWAP_READ_BYTES,
+                   "swap-read-bytes", "Swap read bytes",
+                   "number of bytes read back from swap");
+
+  install_counter (gobject_class, PROP_SWAP_WRITTEN_BYTES,
+                   "swap-written-bytes", "Swap written bytes",
+                   "number of bytes written to swap");
+
+  install_counter (gobject_class, PROP_FILE_QUEUE_SIZE,
+                   "file-queue-size", "File queue size",
+                   "number of bytes queued for writing by file backed buffers");
+
+  install_counter (gobject_class, PROP_ZOOM_TILES,
+                   "zoom-tiles", "Zoom tiles",
+                   "number of mipmap tiles generated from the level below");
+
+  install_counter (gobject_class, PROP_TILE_ALLOCATIONS,
+                   "tile-allocations", "Tile allocations",
+                   "number of tiles allocated with their own data");
+
+  install_counter (gobject_class, PROP_ITERATOR_INDIRECT,
+                   "iterator-indirect", "Iterator indirect",
+                   "number of buffer iterator chunks that went through a converted copy instead of direct tile access");
+
+  install_counter (gobject_class, PROP_TILE_BYTES,
+                   "tile-bytes", "Tile bytes",
+                   "number of bytes of tile data currently allocated");
+
+  install_counter (gobject_class, PROP_TILE_BYTES_PEAK,
+                   "tile-bytes-peak", "Tile bytes peak",
+                   "most bytes of tile data allocated at once");
+
+  install_counter (gobject_class, PROP_BUFFERS_CREATED,
+                   "buffers-created", "Buffers created",
+                   "number of GeglBuffer objects created");
+
+  install_counter (gobject_class, PROP_CONVERSION_BYTES,
+                   "conversion-bytes", "Conversion bytes",
+                   "number of bytes of pixel data converted by babl when reading or writing buffers");
+
+  install_counter (gobject_class, PROP_STORAGE_LOCK_WAITS,
+                   "storage-lock-waits", "Storage lock waits",
+                   "number of times a thread waited for the mutex of a tile storage");
+
+  install_counter (gobject_class, PROP_STORAGE_LOCK_WAIT_USECS,
+                   "storage-lock-wait-usecs", "Storage lock wait time",
+                   "microseconds threads spent waiting for the mutex of a tile storage");
+
+  install_counter (gobject_class, PROP_CACHE_LOCK_WAITS,
+                   "cache-lock-waits", "Cache lock waits",
+                   "number of times a thread waited for the mutex of the tile cache");
+
+  install_counter (gobject_class, PROP_CACHE_LOCK_WAIT_USECS,
+                   "cache-lock-wait-usecs", "Cache lock wait time",
+                   "microseconds threads spent waiting for the mutex of the tile cache");
+}
+
+static void
+gegl_stats_init (GeglStats *self)
+{
+}
+
+/* the peak of the tile bytes is kept per epoch, every report started
+ * begins a new one. Allocating only raises the peak of the current epoch,
+ * and a report takes the largest peak of the epochs it was open for.
+ * Epoch slots are reused after GEGL_STATS_EPOCHS reports have started,
+ * a report open for longer only sees the peaks still in the slots.
+ */
+#define GEGL_STATS_EPOCHS 256
+
+static volatile gint  epoch = 0;
+static volatile gsize epoch_peaks[GEGL_STATS_EPOCHS];
+
+static inline void
+atomic_max (volatile gsize *peak,
+            gsize           value)
+{
+  gsize old_peak;
+
+  do
+    {
+      old_peak = (gsize) g_atomic_pointer_get (peak);
+
+      if (value <= old_peak)
+        return;
+    }
+  while (!g_atomic_pointer_compare_and_exchange (peak, old_peak, value));
+}
+
+void
+gegl_stats_add_tile_bytes (gssize bytes)
+{
+  gsize total;
+  gint  current;
+
+  total = (gsize) g_atomic_pointer_add (&_gegl_stats_counters[GEGL_STATS_TILE_BYTES],
+                                        bytes) + bytes;
+
+  if (bytes <= 0)
+    return;
+
+  /* a report starting meanwhile may have read the total before this
+   * allocation, raise the peak of its epoch too
+   */
+  do
+    {
+      current = g_atomic_int_get (&epoch);
+      atomic_max (&epoch_peaks[(guint) current % GEGL_STATS_EPOCHS], total);
+    }
+  while (g_atomic_int_get (&epoch) != current);
+
+  atomic_max (&_gegl_stats_counters[GEGL_STATS_TILE_BYTES_PEAK], total);
+}
+
+void
+gegl_stats_report_begin (GeglStatsReport *start)
+{
+  GeglMemoryReport *counters = &start->counters;
+  gint              current;
+  gint              next;
+
+  do
+    {
+      current = g_atomic_int_get (&epoch);
+      next    = (gint) ((guint) current + 1);
+      g_atomic_pointer_set (&epoch_peaks[(guint) next % GEGL_STATS_EPOCHS],
+                            (gsize) counter_get (GEGL_STATS_TILE_BYTES));
+    }
+  while (!g_atomic_int_compare_and_exchange (&epoch, current, next));
+
+  start->epoch = next;
+
+  counters->peak_tile_bytes    = counter_get (GEGL_STATS_TILE_BYTES);
+  counters->buffers_created    = counter_get (GEGL_STATS_BUFFERS_CREATED);
+  counters->tile_allocations   = counter_get (GEGL_STATS_TILE_ALLOCATIONS);
+  counters->conversion_bytes   = counter_get (GEGL_STATS_CONVERSION_BYTES);
+  counters->swap_read_bytes    = counter_get (GEGL_STATS_SWAP_READ_BYTES);
+  counters->swap_written_bytes = counter_get (GEGL_STATS_SWAP_WRITTEN_BYTES);
+}
+
+void
+gegl_stats_report_end (GeglStatsReport  *start,
+                       GeglMemoryReport *report)
+{
+  const GeglMemoryReport *counters = &start->counters;
+  guint                   n_epochs;
+  guint64                 peak     = counters->peak_tile_bytes;
+  guint                   i;
+
+  n_epochs = (guint) g_atomic_int_get (&epoch) - (guint) start->epoch + 1;
+  n_epochs = MIN (n_epochs, GEGL_STATS_EPOCHS);
+
+  for (i = 0; i < n_epochs; i++)
+    peak = MAX (peak, (gsize) g_atomic_pointer_get (
+                        &epoch_peaks[((guint) start->epoch + i) % GEGL_STATS_EPOCHS]));
+
+  report->peak_tile_bytes     = MAX (report->peak_tile_bytes, peak);
+  report->buffers_created    += counter_get (GEGL_STATS_BUFFERS_CREATED) -
+                                counters->buffers_created;
+  report->tile_allocations   += counter_get (GEGL_STATS_TILE_ALLOCATIONS) -
+                                counters->tile_allocations;
+  report->conversion_bytes   += counter_get (GEGL_STATS_CONVERSION_BYTES) -
+                                counters->conversion_bytes;
+  report->swap_read_bytes    += counter_get (GEGL_STATS_SWAP_READ_BYTES) -
+                                counters->swap_read_bytes;
+  report->swap_written_bytes += counter_get (GEGL_STATS_SWAP_WRITTEN_BYTES) -
+                                counters->swap_written_bytes;
+}
+
+/* conversion accounting, each thread adds to a table of its own so
+ * converting threads only ever take their own, uncontended, mutex
+ */
+
+typedef struct
+{
+  GeglConversionSite  site;
+  const Babl         *from;
+  const Babl         *to;
+  guint64             calls;
+  guint64             pixels;
+  guint64             bytes;
+  gint64              usecs;
+} ConversionEntry;
+
+typedef struct
+{
+  GMutex      mutex;
+  GHashTable *entries;
+} ConversionTable;
+
+gboolean gegl_stats_conversions_enabled = FALSE;
+
+static const gchar *conversion_site_names[GEGL_CONVERSION_N_SITES] =
+{
+  "iterator", "get", "set", "point-op"
+};
+
+static GMutex           conversion_tables_mutex;
+static GSList          *conversion_tables   = NULL;
+/* what the tables of exited threads held */
+static ConversionTable *conversion_retired  = NULL;
+static gint             conversion_report_n = 0;
+
+static void conversion_table_free (ConversionTable *table);
+
+static GPrivate conversion_table = G_PRIVATE_INIT ((GDestroyNotify) conversion_table_free);
+static GPrivate conversion_site  = G_PRIVATE_INIT (NULL);
+
+static guint
+conversion_entry_hash (gconstpointer key)
+{
+  const ConversionEntry *entry = key;
+
+  return g_direct_hash (entry->from) ^
+         (g_direct_hash (entry->to) * 31) ^
+         entry->site;
+}
+
+static gboolean
+conversion_entry_equal (gconstpointer a,
+                        gconstpointer b)
+{
+  const ConversionEntry *ea = a;
+  const ConversionEntry *eb = b;
+
+  return ea->site == eb->site && ea->from == eb->from && ea->to == eb->to;
+}
+
+static void
+conversion_entry_free (ConversionEntry *entry)
+{
+  g_slice_free (ConversionEntry, entry);
+}
+
+static ConversionTable *
+conversion_table_new (void)
+{
+  ConversionTable *table = g_slice_new0 (ConversionTable);
+
+  g_mutex_init (&table->mutex);
+  table->entries = g_hash_table_new_full (conversion_entry_hash,
+                                          conversion_entry_equal,
+                                          (GDestroyNotify) conversion_entry_free,
+                                          NULL);
+
+  return table;
+}
+
+/* add the entries of @src to @dest, with the mutex of @dest held */
+static void
+conversion_table_merge (GHashTable *dest,
+                        GHashTable *src)
+{
+  GHashTableIter   iter;
+  ConversionEntry *entry;
+
+  g_hash_table_iter_init (&iter, src);
+
+  while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL))
+    {
+      ConversionEntry *total = g_hash_table_lookup (dest, entry);
+
+      if (! total)
+        {
+          total = g_slice_new0 (ConversionEntry);
+          total->site = entry->site;
+          total->from = entry->from;
+          total->to   = entry->to;
+          g_hash_table_add (dest, total);
+        }
+
+      total->calls  += entry->calls;
+      total->pixels += entry->pixels;
+      total->bytes  += entry->bytes;
+      total->usecs  += entry->usecs;
+    }
+}
+
+static void
+conversion_table_free (ConversionTable *table)
+{
+  g_mutex_lock (&conversion_tables_mutex);
+
+  conversion_tables = g_slist_remove (conversion_tables, table);
+
+  if (! conversion_retired)
+    conversion_retired = conversion_table_new ();
+  conversion_table_merge (conversion_retired->entries, table->entries);
+
+  g_mutex_unlock (&conversion_tables_mutex);
+
+  g_hash_table_destroy (table->entries);
+  g_mutex_clear (&table->mutex);
+  g_slice_free (ConversionTable, table);
+}
+
+void
+gegl_stats_babl_process_timed (GeglConversionSite  site,
+                               const Babl         *from,
+                               const Babl         *to,
+                               const Babl         *fish,
+                               const void         *src,
+                               void               *dst,
+                               glong               n)
+{
+  ConversionTable *table = g_private_get (&conversion_table);
+  gpointer         override = g_private_get (&conversion_site);
+  ConversionEntry  key;
+  ConversionEntry *entry;
+  gint64           start;
+  gint64           usecs;
+
+  start = g_get_monotonic_time ();
+  babl_process (fish, src, dst, n);
+  usecs = g_get_monotonic_time () - start;
+
+  if (! table)
+    {
+      table = conversion_table_new ();
+      g_private_set (&conversion_table, table);
+
+      g_mutex_lock (&conversion_tables_mutex);
+      conversion_tables = g_slist_prepend (conversion_tables, table);
+      g_mutex_unlock (&conversion_tables_mutex);
+    }
+
+  key.site = override ? GPOINTER_TO_INT (override) - 1 : site;
+  key.from = from;
+  key.to   = to;
+
+  g_mutex_lock (&table->mutex);
+
+  entry = g_hash_table_lookup (table->entries, &key);
+
+  if (! entry)
+    {
+      entry = g_slice_new0 (ConversionEntry);
+      entry->site = key.site;
+      entry->from = from;
+      entry->to   = to;
+      g_hash_table_add (table->entries, entry);
+    }
+
+  entry->calls++;
+  entry->pixels += n;
+  entry->bytes  += (guint64) n * babl_format_get_bytes_per_pixel (from);
+  entry->usecs  += usecs;
+
+  g_mutex_unlock (&table->mutex);
+}
+
+gpointer
+gegl_stats_conversion_site_push (GeglConversionSite site)
+{
+  gpointer previous = g_private_get (&conversion_site);
+
+  g_private_set (&conversion_site, GINT_TO_POINTER (site + 1));
+
+  return previous;
+}
+
+void
+gegl_stats_conversion_site_pop (gpointer previous)
+{
+  g_private_set (&conversion_site, previous);
+}
+
+void
+gegl_stats_set_conversion_tracking (gboolean enabled)
+{
+  gegl_stats_conversions_enabled = enabled;
+}
+
+void
+gegl_stats_reset_conversions (void)
+{
+  GSList *iter;
+
+  g_mutex_lock (&conversion_tables_mutex);
+
+  for (iter = conversion_tables; iter; iter = iter->next)
+    {
+      ConversionTable *table = iter->data;
+
+      g_mutex_lock (&table->mutex);
+      g_hash_table_remove_all (table->entries);
+      g_mutex_unlock (&table->mutex);
+    }
+
+  if (conversion_retired)
+    g_hash_table_remove_all (conversion_retired->entries);
+
+  g_mutex_unlock (&conversion_tables_mutex);
+}
+
+static gint
+conversion_entry_compare (gconstpointer a,
+                          gconstpointer b)
+{
+  const ConversionEntry *ea = *(ConversionEntry * const *) a;
+  const ConversionEntry *eb = *(ConversionEntry * const *) b;
+
+  if (ea->usecs != eb->usecs)
+    return ea->usecs > eb->usecs ? -1 : 1;
+
+  return ea->bytes > eb->bytes ? -1 : ea->bytes < eb->bytes;
+}
+
+gchar *
+gegl_stats_get_conversion_report (gint max_entries)
+{
+  GHashTable      *totals;
+  GHashTableIter   hash_iter;
+  GPtrArray       *ranked;
+  GString         *report;
+  ConversionEntry *entry;
+  GSList          *iter;
+  gint64           total_usecs = 0;
+  guint64          total_bytes = 0;
+  guint            i;
+
+  totals = g_hash_table_new_full (conversion_entry_hash,
+                                  conversion_entry_equal,
+                                  (GDestroyNotify) conversion_entry_free,
+                                  NULL);
+
+  g_mutex_lock (&conversion_tables_mutex);
+
+  for (iter = conversion_tables; iter; iter = iter->next)
+    {
+      ConversionTable *table = iter->data;
+
+      g_mutex_lock (&table->mutex);
+      conversion_table_merge (totals, table->entries);
+      g_mutex_unlock (&table->mutex);
+    }
+
+  if (conversion_retired)
+    conversion_table_merge (totals, conversion_retired->entries);
+
+  g_mutex_unlock (&conversion_tables_mutex);
+
+  ranked = g_ptr_array_new ();
+
+  g_hash_table_iter_init (&hash_iter, totals);
+  while (g_hash_table_iter_next (&hash_iter, (gpointer *) &entry, NULL))
+    {
+      g_ptr_array_add (ranked, entry);
+      total_usecs += entry->usecs;
+      total_bytes += entry->bytes;
+    }
+
+  g_ptr_array_sort (ranked, conversion_entry_compare);
+
+  report = g_string_new (NULL);
+
+  g_string_append_printf (report,
+                          "babl conversions: %.1f ms, %.1f MiB\n"
+                          "%9s %6s %9s %9s %10s  %-9s %s\n",
+                          total_usecs / 1000.0, total_bytes / 1048576.0,
+                          "ms", "time", "MiB", "MiB/s", "calls",
+                          "site", "from -> to");
+
+  for (i = 0; i < ranked->len; i++)
+    {
+      if (max_entries > 0 && i >= (guint) max_entries)
+        {
+          g_string_append_printf (report, "... %u more\n", ranked->len - i);
+          break;
+        }
+
+      entry = g_ptr_array_index (ranked, i);
+
+      g_string_append_printf (report,
+                              "%9.1f %5.1f%% %9.1f %9.1f %10" G_GUINT64_FORMAT
+                              "  %-9s %s -> %s\n",
+                              entry->usecs / 1000.0,
+                              total_usecs ? 100.0 * entry->usecs / total_usecs : 0.0,
+                              entry->bytes / 1048576.0,
+                              entry->usecs ?
+                                entry->bytes / 1048576.0 / (entry->usecs / 1000000.0) : 0.0,
+                              entry->calls,
+                              conversion_site_names[entry->site],
+                              babl_get_name (entry->from),
+                              babl_get_name (entry->to));
+    }
+
+  g_ptr_array_free (ranked, TRUE);
+  g_hash_table_destroy (totals);
+
+  return g_string_free (report, FALSE);
+}
+
+void
+gegl_stats_conversions_init (void)
+{
+  const gchar *value = g_getenv ("GEGL_CONVERSION_STATS");
+
+  if (! value)
+    return;
+
+  conversion_report_n = atoi (value);
+  if (conversion_report_n <= 0)
+    conversion_report_n = 20;
+
+  gegl_stats_set_conversion_tracking (TRUE);
+}
+
+void
+gegl_stats_conversions_exit (void)
+{
+  gchar *report;
+
+  if (! conversion_report_n)
+    return;
+
+  report = gegl_stats_get_conversion_report (conversion_report_n);
+  g_printf ("\n%s", report);
+  g_free (report);
+
+  gegl_stats_set_conversion_tracking (FALSE);
+  conversion_report_n = 0;
+}
@@ -0,0 +1,195 @@
+/* This file is part of GEGL.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_STATS_H__
+#define __GEGL_STATS_H__
+
+#include <glib.h>
+#include <glib-object.h>
+#include <babl/babl.h>
+
+G_BEGIN_DECLS
+
+#define GEGL_STATS_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GEGL_TYPE_STATS, GeglStatsClass))
+#define GEGL_IS_STATS_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  GEGL_TYPE_STATS))
+#define GEGL_STATS_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  GEGL_TYPE_STATS, GeglStatsClass))
+/* The rest is in gegl-types.h */
+
+typedef struct _GeglStatsClass GeglStatsClass;
+
+struct _GeglStats
+{
+  GObject  parent_instance;
+};
+
+struct _GeglStatsClass
+{
+  GObjectClass parent_class;
+};
+
+typedef enum
+{
+  GEGL_STATS_TILE_CACHE_HITS,
+  GEGL_STATS_TILE_CACHE_MISSES,
+  GEGL_STATS_TILE_CACHE_EVICTIONS,
+  GEGL_STATS_SWAP_READS,
+  GEGL_STATS_SWAP_WRITES,
+  GEGL_STATS_SWAP_READ_BYTES,
+  GEGL_STATS_SWAP_WRITTEN_BYTES,
+  GEGL_STATS_ZOOM_TILES,
+  GEGL_STATS_TILE_ALLOCATIONS,
+  GEGL_STATS_ITERATOR_INDIRECT,
+  GEGL_STATS_TILE_BYTES,
+  GEGL_STATS_TILE_BYTES_PEAK,
+  GEGL_STATS_BUFFERS_CREATED,
+  GEGL_STATS_CONVERSION_BYTES,
+  GEGL_STATS_STORAGE_LOCK_WAITS,
+  GEGL_STATS_STORAGE_LOCK_WAIT_USECS,
+  GEGL_STATS_CACHE_LOCK_WAITS,
+  GEGL_STATS_CACHE_LOCK_WAIT_USECS,
+  GEGL_STATS_N_COUNTERS
+} GeglStatsCounter;
+
+/* the counters behind the properties of gegl_stats (), they live outside
+ * of the object so they can be bumped before it is created
+ */
+extern volatile gsize _gegl_stats_counters[GEGL_STATS_N_COUNTERS];
+
+#define gegl_stats_add(counter, value) \
+  ((void) g_atomic_pointer_add (&_gegl_stats_counters[(counter)], (value)))
+
+#define gegl_stats_inc(counter) gegl_stats_add ((counter), 1)
+
+/* lock @mutex, counting in @waits and @wait_usecs how often and for how
+ * long it had to wait for another thread to release it. An uncontended
+ * lock only costs a trylock.
+ */
+static inline void
+gegl_stats_mutex_lock (GMutex           *mutex,
+                       GeglStatsCounter  waits,
+                       GeglStatsCounter  wait_usecs)
+{
+  if (G_UNLIKELY (!g_mutex_trylock (mutex)))
+    {
+      gint64 start = g_get_monotonic_time ();
+
+      g_mutex_lock (mutex);
+
+      gegl_stats_inc (waits);
+      gegl_stats_add (wait_usecs, g_get_monotonic_time () - start);
+    }
+}
+
+static inline void
+gegl_stats_rec_mutex_lock (GRecMutex        *mutex,
+                           GeglStatsCounter  waits,
+                           GeglStatsCounter  wait_usecs)
+{
+  if (G_UNLIKELY (!g_rec_mutex_trylock (mutex)))
+    {
+      gint64 start = g_get_monotonic_time ();
+
+      g_rec_mutex_lock (mutex);
+
+      gegl_stats_inc (waits);
+      gegl_stats_add (wait_usecs, g_get_monotonic_time () - start);
+    }
+}
+
+/* the mutex of a GeglTileStorage and the global one of the tile cache */
+#define gegl_stats_storage_lock(mutex) \
+  gegl_stats_rec_mutex_lock ((mutex), GEGL_STATS_STORAGE_LOCK_WAITS, \
+                             GEGL_STATS_STORAGE_LOCK_WAIT_USECS)
+
+#define gegl_stats_cache_lock(mutex) \
+  gegl_stats_mutex_lock ((mutex), GEGL_STATS_CACHE_LOCK_WAITS, \
+                         GEGL_STATS_CACHE_LOCK_WAIT_USECS)
+
+/* where a babl conversion happened, for gegl_stats_get_conversion_report () */
+typedef enum
+{
+  GEGL_CONVERSION_SITE_ITERATOR,
+  GEGL_CONVERSION_SITE_BUFFER_GET,
+  GEGL_CONVERSION_SITE_BUFFER_SET,
+  GEGL_CONVERSION_SITE_POINT_OP,
+  GEGL_CONVERSION_N_SITES
+} GeglConversionSite;
+
+extern gboolean gegl_stats_conversions_enabled;
+
+/* babl_process () @n pixels from @src to @dst with @fish, a fish from
+ * @from to @to, accounting the time and bytes it took to @site when
+ * conversion tracking is enabled
+ */
+#define gegl_stats_babl_process(site, from, to, fish, src, dst, n)          \
+  G_STMT_START {                                                            \
+    if (G_UNLIKELY (gegl_stats_conversions_enabled))                        \
+      gegl_stats_babl_process_timed ((site), (from), (to), (fish),          \
+                                     (src), (dst), (n));                    \
+    else                                                                    \
+      babl_process ((fish), (src), (dst), (n));                             \
+  } G_STMT_END
+
+void     gegl_stats_babl_process_timed     (GeglConversionSite  site,
+                                            const Babl         *from,
+                                            const Babl         *to,
+                                            const Babl         *fish,
+                                            const void         *src,
+                                            void               *dst,
+                                            glong               n);
+
+/* account the conversions made by this thread to @site instead of where
+ * they happen until gegl_stats_conversion_site_pop () is given what this
+ * returned, so conversions done by the iterator through gegl_buffer_get ()
+ * and gegl_buffer_set () are told apart
+ */
+gpointer gegl_stats_conversion_site_push   (GeglConversionSite  site);
+void     gegl_stats_conversion_site_pop    (gpointer            previous);
+
+/* read GEGL_CONVERSION_STATS, called from gegl_init */
+void     gegl_stats_conversions_init       (void);
+
+/* print the report asked for with GEGL_CONVERSION_STATS, called from
+ * gegl_exit
+ */
+void     gegl_stats_conversions_exit       (void);
+
+/* account for @bytes of tile data being allocated, or freed when
+ * negative, keeping track of the peak
+ */
+void gegl_stats_add_tile_bytes (gssize                  bytes);
+
+/* accounting of a single evaluation: gegl_stats_report_begin () stores
+ * the counters as they are before it in @start and starts tracking a
+ * peak of its own, gegl_stats_report_end () adds what happened since to
+ * @report. Reports can nest and overlap, the tile-bytes-peak counter is
+ * left alone and allocating tiles takes no lock. The peak is process
+ * wide, it includes tiles held by anything else going on at the same
+ * time.
+ */
+typedef struct
+{
+  GeglMemoryReport counters;
+  gint             epoch;
+} GeglStatsReport;
+
+void gegl_stats_report_begin   (GeglStatsReport        *start);
+void gegl_stats_report_end     (GeglStatsReport        *start,
+                                GeglMemoryReport       *report);
+
+G_END_DECLS
+
+#endif
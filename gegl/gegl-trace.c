@@ -0,0 +1,215 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+#include "gegl-trace.h"
+
+/* events kept per thread, older ones are overwritten */
+#define TRACE_EVENTS 8192
+
+typedef struct
+{
+  gint64         start;
+  gint64         end;
+  const gchar   *category;
+  const gchar   *name;
+  GeglRectangle  roi;
+  gint           level;
+  gboolean       has_roi;
+} TraceEvent;
+
+typedef struct
+{
+  gint        tid;
+  guint       count;  /* events recorded, the ring holds the last ones */
+  TraceEvent  events[TRACE_EVENTS];
+} TraceBuffer;
+
+gboolean gegl_trace_enabled = FALSE;
+
+static gchar   *trace_path  = NULL;
+static gint64   trace_epoch = 0;
+static GSList  *buffers     = NULL;
+static GMutex   buffers_mutex;
+static GPrivate thread_buffer = G_PRIVATE_INIT (NULL);
+
+void
+gegl_trace_init (void)
+{
+  const gchar *path = g_getenv ("GEGL_TRACE");
+
+  if (! path || ! *path)
+    return;
+
+  trace_path         = g_strdup (path);
+  trace_epoch        = g_get_monotonic_time ();
+  gegl_trace_enabled = TRUE;
+}
+
+static TraceBuffer *
+trace_buffer (void)
+{
+  TraceBuffer *buffer = g_private_get (&thread_buffer);
+
+  if (G_UNLIKELY (! buffer))
+    {
+      buffer = g_new0 (TraceBuffer, 1);
+
+      g_mutex_lock (&buffers_mutex);
+      buffer->tid = g_slist_length (buffers) + 1;
+      buffers     = g_slist_prepend (buffers, buffer);
+      g_mutex_unlock (&buffers_mutex);
+
+      /* the buffer outlives the thread, it is freed in gegl_trace_exit */
+      g_private_set (&thread_buffer, buffer);
+    }
+
+  return buffer;
+}
+
+void
+gegl_trace_event (const gchar         *category,
+                  const gchar         *name,
+                  gint64               start,
+                  const GeglRectangle *roi,
+                  gint                 level)
+{
+  TraceBuffer *buffer = trace_buffer ();
+  TraceEvent  *event  = &buffer->events[buffer->count % TRACE_EVENTS];
+
+  event->start    = start;
+  event->end      = g_get_monotonic_time ();
+  event->category = category;
+  event->name     = name ? name : "(unnamed)";
+  event->level    = level;
+  event->has_roi  = roi != NULL;
+
+  if (roi)
+    event->roi = *roi;
+
+  g_atomic_int_inc ((gint *) &buffer->count);
+}
+
+static void
+write_string (FILE        *file,
+              const gchar *string)
+{
+  fputc ('"', file);
+
+  for (; *string; string++)
+    {
+      if (*string == '"' || *string == '\\')
+        fputc ('\\', file);
+
+      if ((guchar) *string >= 0x20)
+        fputc (*string, file);
+    }
+
+  fputc ('"', file);
+}
+
+static void
+write_buffer (FILE        *file,
+              TraceBuffer *buffer,
+              gboolean    *first)
+{
+  guint count = g_atomic_int_get ((gint *) &buffer->count);
+  guint i     = count > TRACE_EVENTS ? count - TRACE_EVENTS : 0;
+
+  fprintf (file,
+           "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+           "\"args\":{\"name\":\"thread %d\"}}",
+           *first ? "" : ",", buffer->tid, buffer->tid);
+  *first = FALSE;
+
+  if (count > TRACE_EVENTS)
+    g_warning ("GEGL_TRACE: thread %d dropped its first %u events",
+               buffer->tid, count - TRACE_EVENTS);
+
+  for (; i < count; i++)
+    {
+      TraceEvent *event = &buffer->events[i % TRACE_EVENTS];
+
+      fprintf (file, ",\n{\"name\":");
+      write_string (file, event->name);
+      fprintf (file, ",\"cat\":");
+      write_string (file, event->category);
+      fprintf (file,
+               ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+               "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+               "\"args\":{\"level\":%d",
+               buffer->tid,
+               event->start - trace_epoch,
+               event->end - event->start,
+               event->level);
+
+      if (event->has_roi)
+        fprintf (file, ",\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d",
+                 event->roi.x, event->roi.y,
+                 event->roi.width, event->roi.height);
+
+      fprintf (file, "}}");
+    }
+}
+
+void
+gegl_trace_exit (void)
+{
+  FILE     *file;
+  GSList   *iter;
+  gboolean  first = TRUE;
+
+  if (! gegl_trace_enabled)
+    return;
+
+  gegl_trace_enabled = FALSE;
+
+  file = g_fopen (trace_path, "w");
+
+  if (! file)
+    {
+      g_warning ("GEGL_TRACE: unable to write %s", trace_path);
+    }
+  else
+    {
+      fprintf (file, "{\"traceEvents\":[");
+
+      g_mutex_lock (&buffers_mutex);
+      for (iter = buffers; iter; iter = iter->next)
+        write_buffer (file, iter->data, &first);
+      g_mutex_unlock (&buffers_mutex);
+
+      fprintf (file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+      fclose (file);
+    }
+
+  /* threads still running may have recorded their last event before the
+   * flag was cleared, their buffers are leaked rather than freed under them
+   */
+  g_mutex_lock (&buffers_mutex);
+  g_slist_free (buffers);
+  buffers = NULL;
+  g_mutex_unlock (&buffers_mutex);
+
+  g_clear_pointer (&trace_path, g_free);
+}
@@ -0,0 +1,54 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef GEGL_TRACE_H
+#define GEGL_TRACE_H
+
+/* Timeline tracing, enabled by setting GEGL_TRACE to the path of a file
+ * that a chrome://tracing / Perfetto compatible trace is written to at
+ * gegl_exit ().  Every thread records into a ring buffer of its own, so
+ * recording takes no locks and long runs keep their most recent events.
+ */
+
+extern gboolean gegl_trace_enabled;
+
+/* read GEGL_TRACE, called from gegl_init */
+void gegl_trace_init  (void);
+
+/* write out the recorded events, called from gegl_exit */
+void gegl_trace_exit  (void);
+
+/* record an event on the calling thread that started at @start (in
+ * g_get_monotonic_time () microseconds) and ends now, @category and @name
+ * are not copied and should be static or otherwise outlive the trace,
+ * @roi may be NULL.
+ */
+void gegl_trace_event (const gchar         *category,
+                       const gchar         *name,
+                       gint64               start,
+                       const GeglRectangle *roi,
+                       gint                 level);
+
+#define GEGL_TRACE_START() \
+  { gint64 _gegl_trace_start = 0; \
+    if (gegl_trace_enabled) { _gegl_trace_start = g_get_monotonic_time (); }
+
+#define GEGL_TRACE_END(category, name, roi, level) \
+    if (gegl_trace_enabled) { \
+      gegl_trace_event (category, name, _gegl_trace_start, roi, level); \
+                            } \
+  }
+
+#endif
@@ -38,7 +38,8 @@ typedef enum
 {
   GEGL_BLIT_DEFAULT  = 0,
   GEGL_BLIT_CACHE    = 1 << 0,
-  GEGL_BLIT_DIRTY    = 1 << 1
+  GEGL_BLIT_DIRTY    = 1 << 1,
+  GEGL_BLIT_STREAM   = 1 << 2
 } GeglBlitFlags;
 
 
@@ -48,6 +49,51 @@ GType gegl_config_get_type (void) G_GNUC_CONST;
 #define GEGL_CONFIG(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GEGL_TYPE_CONFIG, GeglConfig))
 #define GEGL_IS_CONFIG(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GEGL_TYPE_CONFIG))
 
+typedef struct _GeglStats GeglStats;
+GType gegl_stats_get_type (void) G_GNUC_CONST;
+#define GEGL_TYPE_STATS             (gegl_stats_get_type ())
+#define GEGL_STATS(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), GEGL_TYPE_STATS, GeglStats))
+#define GEGL_IS_STATS(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GEGL_TYPE_STATS))
+
+/* what an evaluation used, see gegl_processor_get_memory_report() and
+ * gegl_node_get_memory_report()
+ */
+typedef struct _GeglMemoryReport GeglMemoryReport;
+
+struct _GeglMemoryReport
+{
+  guint64 peak_tile_bytes;    /* most bytes of tile data allocated at once */
+  guint64 buffers_created;
+  guint64 tile_allocations;
+  guint64 conversion_bytes;   /* converted by babl reading or writing buffers */
+  guint64 swap_read_bytes;
+  guint64 swap_written_bytes;
+};
+
+/* the phases blits and processor work are broken down into for their
+ * latency histograms, see gegl_stats_get_blit_latency() and
+ * gegl_processor_get_latency()
+ */
+typedef enum
+{
+  GEGL_LATENCY_PREPARE,  /* preparing the graph and the requested regions */
+  GEGL_LATENCY_COMPUTE,  /* processing, including reading cached results */
+  GEGL_LATENCY_COPY,     /* copying out the result, all a cache hit costs */
+  GEGL_LATENCY_CONVERT,  /* copying out the result converted by babl */
+  GEGL_LATENCY_TOTAL,
+  GEGL_LATENCY_N_PHASES
+} GeglLatencyPhase;
+
+/* blits are told apart by the number of pixels they render */
+typedef enum
+{
+  GEGL_BLIT_SIZE_TILE,      /* up to 128x128 pixels */
+  GEGL_BLIT_SIZE_SMALL,     /* up to 512x512 pixels */
+  GEGL_BLIT_SIZE_VIEWPORT,  /* up to 2048x2048 pixels */
+  GEGL_BLIT_SIZE_LARGE,
+  GEGL_BLIT_SIZE_N_CLASSES
+} GeglBlitSize;
+
 typedef struct _GeglSampler       GeglSampler;
 typedef struct _GeglCurve         GeglCurve;
 typedef struct _GeglPath          GeglPath;
@@ -35,6 +35,40 @@ G_BEGIN_DECLS
 typedef struct _GeglNodeClass   GeglNodeClass;
 typedef struct _GeglNodePrivate GeglNodePrivate;
 
+#define GEGL_NODE_RECT_MEMO_SIZE 8
+
+/* one remembered result of gegl_operation_get_required_for_output or,
+ * when invalidated is set, of gegl_operation_get_invalidated_by_change
+ */
+typedef struct
+{
+  const gchar   *pad;      /* interned */
+  gboolean       invalidated;
+  GeglRectangle  input;
+  GeglRectangle  result;
+} GeglNodeRectMemo;
+
+/* running totals of the renderings of a node, reported by
+ * gegl_to_dot_profile. The cache_requests and cache_hits the cache
+ * policy keeps on the node are not the same counts: they leave out
+ * streamed requests and are halved every GEGL_CACHE_POLICY_WINDOW
+ * requests to follow recent use, where these count every rendering
+ * since the node was created.
+ */
+typedef struct
+{
+  gint64  usecs;       /* spent processing, not counting the inputs */
+  gint64  pixels;      /* computed, not counting cache hits */
+  guint   requests;
+  guint   cache_hits;
+  gsize   peak_bytes;  /* largest output buffer region handed on */
+} GeglNodeProfile;
+
+/* whether renderings are added to the profiles of the nodes, set with
+ * gegl_dot_set_profiling
+ */
+extern gboolean gegl_node_profiling;
+
 struct _GeglNode
 {
   GObject         parent_instance;
@@ -59,6 +93,9 @@ struct _GeglNode
   /* The output pads */
   GSList         *output_pads;
 
+  /* The number of slots handed out to the pads, see gegl_node_get_pad_slot */
+  gint            n_pad_slots;
+
   /* If a node is a graph it means it has children. Typically the
    * children connect to the input/output proxies of their graph
    * node. This results in that the graph node can more or less be
@@ -81,6 +118,25 @@ struct _GeglNode
 
   gint            passthrough;
 
+  /* Measurements and decision of the adaptive cache policy, see
+   * process/gegl-cache-policy.c
+   */
+  gdouble         usecs_per_pixel;
+  guint           cache_requests;
+  guint           cache_hits;
+  gboolean        auto_dont_cache;
+
+  GeglNodeProfile profile;
+
+  /* The most recent region computations of the operation, they only
+   * depend on the properties and the inputs of the node, and are
+   * forgotten when either changes or the node is prepared again.
+   */
+  GeglNodeRectMemo rect_memo[GEGL_NODE_RECT_MEMO_SIZE];
+  gint             rect_memo_count;
+  gint             rect_memo_next;
+  GMutex           rect_memo_mutex;
+
   /*< private >*/
   GeglNodePrivate *priv;
 };
@@ -102,6 +158,8 @@ GeglPad     * gegl_node_get_pad             (GeglNode      *self,
                                              const gchar   *name);
 GSList      * gegl_node_get_pads            (GeglNode      *self);
 GSList      * gegl_node_get_input_pads      (GeglNode      *self);
+gint          gegl_node_get_pad_slot        (GeglNode      *self,
+                                             const gchar   *name);
 GSList      * gegl_node_get_sinks           (GeglNode      *self);
 gint          gegl_node_get_num_sinks       (GeglNode      *self);
 
@@ -133,6 +191,26 @@ void
 gegl_node_emit_computed (GeglNode *node,
                          const GeglRectangle *rect);
 
+gboolean      gegl_node_lookup_rect         (GeglNode            *self,
+                                             gboolean             invalidated,
+                                             const gchar         *pad,
+                                             const GeglRectangle *input,
+                                             GeglRectangle       *result);
+void          gegl_node_remember_rect       (GeglNode            *self,
+                                             gboolean             invalidated,
+                                             const gchar         *pad,
+                                             const GeglRectangle *input,
+                                             const GeglRectangle *result);
+void          gegl_node_forget_rects        (GeglNode            *self);
+
+void          gegl_node_blit_level          (GeglNode            *self,
+                                             gdouble              scale,
+                                             gint                 level,
+                                             const GeglRectangle *roi,
+                                             const Babl          *format,
+                                             gpointer             destination_buf,
+                                             gint                 rowstride);
+
 
 G_END_DECLS
 
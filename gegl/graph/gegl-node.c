@@ -34,6 +34,8 @@
 #include "gegl-pad.h"
 #include "gegl-visitable.h"
 #include "gegl-config.h"
+#include "gegl-latency.h"
+#include "gegl-stats.h"
 
 #include "graph/gegl-visitor.h"
 
@@ -42,6 +44,7 @@
 #include "operation/gegl-operation-meta.h"
 
 #include "process/gegl-eval-manager.h"
+#include "process/gegl-disk-cache.h"
 
 enum
 {
@@ -72,6 +75,7 @@ struct _GeglNodePrivate
   gchar           *name;
   gchar           *debug_name;
   GeglEvalManager *eval_manager;
+  GeglMemoryReport memory_report; /* of the most recent blit or process */
 };
 
 
@@ -226,6 +230,7 @@ gegl_node_init (GeglNode *self)
   self->is_graph    = FALSE;
   self->cache       = NULL;
   g_mutex_init (&self->mutex);
+  g_mutex_init (&self->rect_memo_mutex);
 
 }
 
@@ -302,6 +307,7 @@ gegl_node_finalize (GObject *gobject)
     }
 
   g_mutex_clear (&self->mutex);
+  g_mutex_clear (&self->rect_memo_mutex);
 
   G_OBJECT_CLASS (gegl_node_parent_class)->finalize (gobject);
 }
@@ -405,27 +411,48 @@ gegl_node_local_get_property (GObject    *gobject,
  *
  * Returns: A #GeglPad.
  **/
+static inline GeglPad *
+gegl_node_find_pad (GeglNode    *self,
+                    const gchar *name)
+{
+  GSList *list;
+
+  /* names taken from pads, and the gegl_pad_name_* of the base classes,
+   * are interned and match on the pointer, only other names get their
+   * strings compared
+   */
+  for (list = self->pads; list; list = list->next)
+    {
+      GeglPad *pad = list->data;
+
+      if (pad->name == name || !strcmp (name, pad->name))
+        return pad;
+    }
+
+  return NULL;
+}
+
 GeglPad *
 gegl_node_get_pad (GeglNode    *self,
                    const gchar *name)
 {
-  GSList *list;
-
   g_return_val_if_fail (GEGL_IS_NODE (self), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  if (!self->pads)
-    return NULL;
-
-  for (list = self->pads; list; list = g_slist_next (list))
-    {
-      GeglPad *property = list->data;
+  return gegl_node_find_pad (self, name);
+}
 
-      if (!strcmp (name, gegl_pad_get_name (property)))
-        return property;
-    }
+/* The slot of the pad called name, a small index that is unique among the
+ * pads of the node, for storing values per pad in arrays, or -1 if there is
+ * no such pad.
+ */
+gint
+gegl_node_get_pad_slot (GeglNode    *self,
+                        const gchar *name)
+{
+  GeglPad *pad = gegl_node_find_pad (self, name);
 
-  return NULL;
+  return pad ? pad->slot : -1;
 }
 
 gboolean
@@ -509,6 +536,7 @@ gegl_node_add_pad (GeglNode *self,
   if (gegl_node_get_pad (self, gegl_pad_get_name (pad)))
     return;
 
+  pad->slot  = self->n_pad_slots++;
   self->pads = g_slist_prepend (self->pads, pad);
 
   if (gegl_pad_is_output (pad))
@@ -529,6 +557,12 @@ gegl_node_remove_pad (GeglNode *self,
 
   self->pads = g_slist_remove (self->pads, pad);
 
+  /* slots stay unique among the pads of the node, numbering only
+   * starts over once all pads are gone
+   */
+  if (!self->pads)
+    self->n_pad_slots = 0;
+
   if (gegl_pad_is_output (pad))
     self->output_pads = g_slist_remove (self->output_pads, pad);
 
@@ -619,7 +653,18 @@ gegl_node_invalidated (GeglNode            *node,
   if (!rect)
     rect = &node->have_rect;
 
-  if (node->cache)
+  if (node->cache && node->cache->valid_path)
+    {
+      /* the disk cache entry holds the output of the graph as it was,
+       * a new one is opened for the changed graph
+       */
+      g_signal_handlers_disconnect_by_func (node->cache,
+                                            gegl_node_emit_computed, node);
+      gegl_disk_cache_close (node->cache);
+      g_object_unref (node->cache);
+      node->cache = NULL;
+    }
+  else if (node->cache)
     {
       if (rect && clear_cache)
         gegl_buffer_clear (GEGL_BUFFER (node->cache), rect);
@@ -627,11 +672,17 @@ gegl_node_invalidated (GeglNode            *node,
       gegl_cache_invalidate (node->cache, rect);
     }
   node->valid_have_rect = FALSE;
+  gegl_node_forget_rects (node);
 
   g_signal_emit (node, gegl_node_signals[INVALIDATED], 0,
                  rect, NULL);
 }
 
+/* set while invalidation caused by connecting or disconnecting a pad
+ * propagates
+ */
+static GPrivate connection_changing = G_PRIVATE_INIT (NULL);
+
 static void
 gegl_node_source_invalidated (GeglNode            *source,
                               const GeglRectangle *rect,
@@ -647,6 +698,9 @@ gegl_node_source_invalidated (GeglNode            *source,
              rect->x, rect->y,
              rect->width, rect->height);
 
+  /* the regions computed for destination may depend on its inputs */
+  gegl_node_forget_rects (destination);
+
   if (destination->operation)
     {
       dirty_rect =
@@ -659,9 +713,36 @@ gegl_node_source_invalidated (GeglNode            *source,
       dirty_rect = *rect;
     }
 
+  /* the change does not reach the output of destination, like a crop
+   * outside the dirty area, nothing further down is affected either.
+   * Connection changes alter the graph itself, and an empty rect is
+   * what a node that was never prepared has, those always reach the
+   * root so its eval manager picks up the new graph.
+   */
+  if ((dirty_rect.width <= 0 || dirty_rect.height <= 0) &&
+      rect->width > 0 && rect->height > 0 &&
+      ! g_private_get (&connection_changing))
+    {
+      GEGL_NOTE (GEGL_DEBUG_INVALIDATION, "%s is not affected, stopping",
+                 gegl_node_get_debug_name (destination));
+      destination->valid_have_rect = FALSE;
+      return;
+    }
+
   gegl_node_invalidated (destination, &dirty_rect, FALSE);
 }
 
+static void
+gegl_node_connection_invalidated (GeglNode *source,
+                                  GeglPad  *sink_pad)
+{
+  gpointer previous = g_private_get (&connection_changing);
+
+  g_private_set (&connection_changing, GINT_TO_POINTER (TRUE));
+  gegl_node_source_invalidated (source, &source->have_rect, sink_pad);
+  g_private_set (&connection_changing, previous);
+}
+
 static GSList *
 gegl_node_get_depends_on (GeglNode *self);
 
@@ -755,7 +836,7 @@ gegl_node_connect_from (GeglNode    *sink,
       g_signal_connect (G_OBJECT (real_source), "invalidated",
                         G_CALLBACK (gegl_node_source_invalidated), sink_pad);
 
-      gegl_node_source_invalidated (real_source, &real_source->have_rect, sink_pad);
+      gegl_node_connection_invalidated (real_source, sink_pad);
 
       return TRUE;
     }
@@ -797,7 +878,7 @@ gegl_node_disconnect (GeglNode    *sink,
       source_pad = gegl_connection_get_source_pad (connection);
       source     = gegl_connection_get_source_node (connection);
 
-      gegl_node_source_invalidated (source, &source->have_rect, sink_pad);
+      gegl_node_connection_invalidated (source, sink_pad);
 
       {
         /* disconnecting dirt propagation */
@@ -989,7 +1070,16 @@ gegl_node_blit_buffer (GeglNode            *self,
   if (result)
     {
       if (buffer)
-        gegl_buffer_copy (result, &request, GEGL_ABYSS_NONE, buffer, NULL);
+        {
+          gint64 start = g_get_monotonic_time ();
+
+          gegl_buffer_copy (result, &request, GEGL_ABYSS_NONE, buffer, NULL);
+
+          gegl_latency_add (gegl_buffer_get_format (result) !=
+                            gegl_buffer_get_format (buffer) ?
+                              GEGL_LATENCY_CONVERT : GEGL_LATENCY_COPY,
+                            g_get_monotonic_time () - start);
+        }
       g_object_unref (result);
     }
 }
@@ -1002,6 +1092,147 @@ static inline gboolean gegl_mipmap_rendering_enabled (void)
   return enabled;
 }
 
+/* Render roi at the given scale like gegl_node_blit() without flags does,
+ * but with the graph evaluated at mipmap level; regardless of whether
+ * GEGL_MIPMAP_RENDERING is set. Used by the processor for progressive
+ * rendering.
+ */
+/* copy the rendered roi out of buffer, accounting the time to the copy or
+ * the conversion phase of the blit
+ */
+static void
+gegl_node_blit_copy_out (GeglBuffer          *buffer,
+                         const GeglRectangle *roi,
+                         gdouble              scale,
+                         const Babl          *format,
+                         gpointer             destination_buf,
+                         gint                 rowstride)
+{
+  gint64 start = g_get_monotonic_time ();
+
+  gegl_buffer_get (buffer, roi, scale, format, destination_buf, rowstride,
+                   GEGL_ABYSS_NONE);
+
+  gegl_latency_add (format && format != gegl_buffer_get_format (buffer) ?
+                      GEGL_LATENCY_CONVERT : GEGL_LATENCY_COPY,
+                    g_get_monotonic_time () - start);
+}
+
+void
+gegl_node_blit_level (GeglNode            *self,
+                      gdouble              scale,
+                      gint                 level,
+                      const GeglRectangle *roi,
+                      const Babl          *format,
+                      gpointer             destination_buf,
+                      gint                 rowstride)
+{
+  GeglBuffer *buffer;
+
+  g_return_if_fail (GEGL_IS_NODE (self));
+  g_return_if_fail (roi != NULL);
+
+  if (rowstride == GEGL_AUTO_ROWSTRIDE && format)
+    rowstride = babl_format_get_bytes_per_pixel (format) * roi->width;
+
+  if (scale != 1.0)
+    {
+      const GeglRectangle unscaled_roi = _gegl_get_required_for_scale (format, roi, scale);
+
+      buffer = gegl_node_apply_roi (self, &unscaled_roi, level);
+    }
+  else
+    {
+      buffer = gegl_node_apply_roi (self, roi, 0);
+    }
+  if (buffer && destination_buf)
+    gegl_node_blit_copy_out (buffer, roi, scale, format,
+                             destination_buf, rowstride);
+
+  if (buffer)
+    g_object_unref (buffer);
+}
+
+/* Render roi band by band with a private eval manager that bypasses the
+ * node caches, so no more than a band and the context the operations need
+ * around it is held in memory at a time.
+ */
+static void
+gegl_node_blit_stream (GeglNode            *self,
+                       gdouble              scale,
+                       const GeglRectangle *roi,
+                       const Babl          *format,
+                       gpointer             destination_buf,
+                       gint                 rowstride)
+{
+  GeglEvalManager *eval_manager;
+  gint             tile_height = gegl_config ()->tile_height;
+  gint             band_height;
+  gint             level = 0;
+  gint             y;
+
+  if (scale != 1.0 && gegl_mipmap_rendering_enabled ())
+    level = gegl_level_from_scale (scale);
+
+  band_height = gegl_config ()->chunk_size / MAX (roi->width, 1);
+  band_height = MAX (band_height / tile_height, 1) * tile_height;
+
+  eval_manager = gegl_eval_manager_new (self, "output");
+  gegl_eval_manager_set_streaming (eval_manager, TRUE);
+
+  for (y = roi->y; y < roi->y + roi->height; y += band_height)
+    {
+      GeglRectangle  band = {roi->x, y, roi->width,
+                             MIN (band_height, roi->y + roi->height - y)};
+      GeglRectangle  request = band;
+      GeglBuffer    *buffer;
+
+      if (scale != 1.0)
+        request = _gegl_get_required_for_scale (format, &band, scale);
+
+      buffer = gegl_eval_manager_apply (eval_manager, &request, level);
+
+      if (buffer && destination_buf)
+        gegl_node_blit_copy_out (buffer, &band, scale, format,
+                                 (guchar *) destination_buf +
+                                   (gsize) (y - roi->y) * rowstride,
+                                 rowstride);
+
+      if (buffer)
+        g_object_unref (buffer);
+    }
+
+  g_object_unref (eval_manager);
+}
+
+static void
+gegl_node_set_memory_report (GeglNode               *self,
+                             const GeglMemoryReport *report)
+{
+  self->priv->memory_report = *report;
+
+  GEGL_NOTE (GEGL_DEBUG_PROCESS,
+             "%s used at most %" G_GUINT64_FORMAT " bytes of tiles, "
+             "%" G_GUINT64_FORMAT " buffers, "
+             "%" G_GUINT64_FORMAT " tile allocations, "
+             "%" G_GUINT64_FORMAT " bytes converted, "
+             "%" G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT " bytes of swap read/written",
+             gegl_node_get_debug_name (self),
+             report->peak_tile_bytes, report->buffers_created,
+             report->tile_allocations, report->conversion_bytes,
+             report->swap_read_bytes, report->swap_written_bytes);
+}
+
+void
+gegl_node_get_memory_report (GeglNode         *self,
+                             GeglMemoryReport *report)
+{
+  g_return_if_fail (GEGL_IS_NODE (self));
+  g_return_if_fail (report != NULL);
+
+  *report = self->priv->memory_report;
+}
+
 void
 gegl_node_blit (GeglNode            *self,
                 gdouble              scale,
@@ -1011,32 +1242,29 @@ gegl_node_blit (GeglNode            *self,
                 gint                 rowstride,
                 GeglBlitFlags        flags)
 {
+  GeglStatsReport    start;
+  GeglMemoryReport   report = { 0, };
+  GeglLatencyTiming  timing;
+  GeglLatencyTiming *outer_timing;
+  gint64             start_time;
+
   g_return_if_fail (GEGL_IS_NODE (self));
   g_return_if_fail (roi != NULL);
 
+  gegl_stats_report_begin (&start);
+
+  start_time   = g_get_monotonic_time ();
+  outer_timing = gegl_latency_timing_push (&timing);
+
   if (rowstride == GEGL_AUTO_ROWSTRIDE && format)
     rowstride = babl_format_get_bytes_per_pixel (format) * roi->width;
 
   if (!flags)
     {
-      GeglBuffer *buffer;
-
-      if (scale != 1.0)
-        {
-          const GeglRectangle unscaled_roi = _gegl_get_required_for_scale (format, roi, scale);
-
-          buffer = gegl_node_apply_roi (self, &unscaled_roi,
-              gegl_mipmap_rendering_enabled()?gegl_level_from_scale (scale):0);
-        }
-      else
-        {
-          buffer = gegl_node_apply_roi (self, roi, 0);
-        }
-      if (buffer && destination_buf)
-        gegl_buffer_get (buffer, roi, scale, format, destination_buf, rowstride, GEGL_ABYSS_NONE);
-
-      if (buffer)
-        g_object_unref (buffer);
+      gegl_node_blit_level (self, scale,
+                            gegl_mipmap_rendering_enabled () ?
+                              gegl_level_from_scale (scale) : 0,
+                            roi, format, destination_buf, rowstride);
     }
   else if (flags & GEGL_BLIT_CACHE)
     {
@@ -1062,11 +1290,26 @@ gegl_node_blit (GeglNode            *self,
 
       if (destination_buf && cache)
         {
-          gegl_buffer_get (buffer, roi, scale,
-                           format, destination_buf, rowstride,
-                           GEGL_ABYSS_NONE);
+          gegl_node_blit_copy_out (buffer, roi, scale,
+                                   format, destination_buf, rowstride);
         }
     }
+  else if (flags & GEGL_BLIT_STREAM)
+    {
+      gegl_node_blit_stream (self, scale, roi, format,
+                             destination_buf, rowstride);
+    }
+
+  /* blits made by a processor or by another blit on this thread are
+   * part of that work, only the outermost ones are application requests
+   */
+  if (!outer_timing)
+    gegl_latency_record_blit (roi, g_get_monotonic_time () - start_time,
+                              &timing);
+  gegl_latency_timing_pop (&timing, outer_timing);
+
+  gegl_stats_report_end (&start, &report);
+  gegl_node_set_memory_report (self, &report);
 }
 
 static GSList *
@@ -1185,6 +1428,8 @@ gegl_node_property_changed (GObject    *gobject,
 {
   GeglNode *self = GEGL_NODE (user_data);
 
+  gegl_node_forget_rects (self);
+
   if (arg1 != user_data &&
       ((arg1 &&
         arg1->value_type != GEGL_TYPE_BUFFER) ||
@@ -1213,16 +1458,22 @@ gegl_node_property_changed (GObject    *gobject,
         {
           /* we were called due to a property change */
           GeglRectangle dirty_rect;
+          GeglRectangle old_have_rect;
           GeglRectangle new_have_rect;
 
-          dirty_rect    = self->have_rect;
+          old_have_rect = self->have_rect;
           new_have_rect = gegl_node_get_bounding_box (self);
 
-          gegl_rectangle_bounding_box (&dirty_rect,
-                                       &dirty_rect,
-                                       &new_have_rect);
+          dirty_rect = gegl_operation_get_invalidated_by_property (self->operation,
+                                                                   arg1->name,
+                                                                   &old_have_rect,
+                                                                   &new_have_rect);
 
-          gegl_node_invalidated (self, &dirty_rect, FALSE);
+          if (dirty_rect.width > 0 && dirty_rect.height > 0)
+            gegl_node_invalidated (self, &dirty_rect, FALSE);
+          else
+            GEGL_NOTE (GEGL_DEBUG_INVALIDATION, "%s.%s changed nothing",
+                       gegl_node_get_debug_name (self), arg1->name);
         }
     }
 
@@ -1328,6 +1579,55 @@ gegl_node_get (GeglNode    *self,
   va_end (var_args);
 }
 
+/* TRUE if setting @value on @object would leave @pspec as it is. Objects
+ * may have been changed in place before being set again, so only colors
+ * are compared by value and only when they are different objects.
+ */
+static gboolean
+gegl_node_value_unchanged (GObject      *object,
+                           GParamSpec   *pspec,
+                           const GValue *value)
+{
+  GValue   current   = G_VALUE_INIT;
+  GValue   new_value = G_VALUE_INIT;
+  gboolean unchanged = FALSE;
+
+  if (!(pspec->flags & G_PARAM_READABLE) ||
+      !G_VALUE_HOLDS (value, G_PARAM_SPEC_VALUE_TYPE (pspec)))
+    return FALSE;
+
+  g_value_init (&current, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  g_value_init (&new_value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+  g_object_get_property (object, pspec->name, &current);
+  g_value_copy (value, &new_value);
+  g_param_value_validate (pspec, &new_value);
+
+  if (G_VALUE_HOLDS_OBJECT (&current))
+    {
+      GObject *a = g_value_get_object (&current);
+      GObject *b = g_value_get_object (&new_value);
+
+      if (a != b && GEGL_IS_COLOR (a) && GEGL_IS_COLOR (b))
+        {
+          gdouble color_a[4];
+          gdouble color_b[4];
+
+          gegl_color_get_pixel (GEGL_COLOR (a), babl_format ("RGBA double"), color_a);
+          gegl_color_get_pixel (GEGL_COLOR (b), babl_format ("RGBA double"), color_b);
+          unchanged = memcmp (color_a, color_b, sizeof (color_a)) == 0;
+        }
+    }
+  else if (!G_VALUE_HOLDS_BOXED (&current))
+    {
+      unchanged = g_param_values_cmp (pspec, &current, &new_value) == 0;
+    }
+
+  g_value_unset (&current);
+  g_value_unset (&new_value);
+
+  return unchanged;
+}
+
 void
 gegl_node_set_valist (GeglNode    *self,
                       const gchar *first_property_name,
@@ -1404,7 +1704,12 @@ gegl_node_set_valist (GeglNode    *self,
                   g_value_unset (&value);
                   break;
                 }
-              g_object_set_property (object, property_name, &value);
+              /* setting an operation property to its current value does
+               * not invalidate anything
+               */
+              if (object == G_OBJECT (self) ||
+                  !gegl_node_value_unchanged (object, pspec, &value))
+                g_object_set_property (object, property_name, &value);
               g_value_unset (&value);
             }
         }
@@ -1498,7 +1803,8 @@ gegl_node_set_property (GeglNode     *self,
                      value_string,
                      property_name);
         }
-      g_object_set_property (G_OBJECT (self->operation), property_name, value);
+      if (!gegl_node_value_unchanged (G_OBJECT (self->operation), pspec, value))
+        g_object_set_property (G_OBJECT (self->operation), property_name, value);
       return;
     }
 
@@ -1689,13 +1995,18 @@ gegl_node_get_bounding_box (GeglNode *self)
 void
 gegl_node_process (GeglNode *self) /* XXX: add level argument?  */
 {
-  GeglProcessor *processor;
+  GeglProcessor    *processor;
+  GeglMemoryReport  report;
 
   g_return_if_fail (GEGL_IS_NODE (self));
 
   processor = gegl_node_new_processor (self, NULL);
 
   while (gegl_processor_work (processor, NULL)) ;
+
+  gegl_processor_get_memory_report (processor, &report);
+  gegl_node_set_memory_report (self, &report);
+
   g_object_unref (processor);
 }
 
@@ -1851,6 +2162,7 @@ gegl_node_get_cache (GeglNode *node)
 {
   GeglPad    *pad;
   GeglNode   *real_node;
+  GParamSpec *pspec;
   const Babl *format = NULL;
   g_return_val_if_fail (GEGL_IS_NODE (node), NULL);
 
@@ -1886,9 +2198,12 @@ gegl_node_get_cache (GeglNode *node)
     {
       GeglCache *cache;
 
-      cache = g_object_new (GEGL_TYPE_CACHE,
-                            "format", format,
-                            NULL);
+      cache = gegl_disk_cache_open (node, format);
+
+      if (!cache)
+        cache = g_object_new (GEGL_TYPE_CACHE,
+                              "format", format,
+                              NULL);
 
       gegl_object_set_has_forked (G_OBJECT (cache));
       gegl_node_get_bounding_box (node);
@@ -1897,6 +2212,19 @@ gegl_node_get_cache (GeglNode *node)
       g_signal_connect_swapped (G_OBJECT (cache), "computed",
                                 (GCallback) gegl_node_emit_computed,
                                 node);
+
+      /* operations like gegl:cache ask for their cache to be pinned */
+      pspec = g_object_class_find_property (
+                G_OBJECT_GET_CLASS (node->operation), "pinned");
+
+      if (pspec && pspec->value_type == G_TYPE_BOOLEAN)
+        {
+          gboolean pinned;
+
+          g_object_get (node->operation, "pinned", &pinned, NULL);
+          gegl_cache_set_pinned (cache, pinned);
+        }
+
       node->cache = cache;
     }
 
@@ -2223,3 +2551,70 @@ const char *gegl_operation_get_op_version (const char *op_name)
   return ret;
 }
 
+/* Look up a result of gegl_operation_get_required_for_output, or of
+ * gegl_operation_get_invalidated_by_change when invalidated is TRUE,
+ * remembered for the same pad and input region.
+ */
+gboolean
+gegl_node_lookup_rect (GeglNode            *self,
+                       gboolean             invalidated,
+                       const gchar         *pad,
+                       const GeglRectangle *input,
+                       GeglRectangle       *result)
+{
+  gboolean found = FALSE;
+  gint     i;
+
+  g_mutex_lock (&self->rect_memo_mutex);
+
+  for (i = 0; i < self->rect_memo_count; i++)
+    {
+      GeglNodeRectMemo *memo = &self->rect_memo[i];
+
+      if (memo->invalidated == invalidated &&
+          gegl_rectangle_equal (&memo->input, input) &&
+          (memo->pad == pad || ! strcmp (memo->pad, pad)))
+        {
+          *result = memo->result;
+          found   = TRUE;
+          break;
+        }
+    }
+
+  g_mutex_unlock (&self->rect_memo_mutex);
+
+  return found;
+}
+
+void
+gegl_node_remember_rect (GeglNode            *self,
+                         gboolean             invalidated,
+                         const gchar         *pad,
+                         const GeglRectangle *input,
+                         const GeglRectangle *result)
+{
+  GeglNodeRectMemo *memo;
+
+  g_mutex_lock (&self->rect_memo_mutex);
+
+  /* replace the oldest entry once all are in use */
+  memo = &self->rect_memo[self->rect_memo_next];
+  self->rect_memo_next = (self->rect_memo_next + 1) % GEGL_NODE_RECT_MEMO_SIZE;
+  self->rect_memo_count = MIN (self->rect_memo_count + 1, GEGL_NODE_RECT_MEMO_SIZE);
+
+  memo->pad         = g_intern_string (pad);
+  memo->invalidated = invalidated;
+  memo->input       = *input;
+  memo->result      = *result;
+
+  g_mutex_unlock (&self->rect_memo_mutex);
+}
+
+void
+gegl_node_forget_rects (GeglNode *self)
+{
+  g_mutex_lock (&self->rect_memo_mutex);
+  self->rect_memo_count = 0;
+  self->rect_memo_next  = 0;
+  g_mutex_unlock (&self->rect_memo_mutex);
+}
@@ -272,11 +272,14 @@ void          gegl_node_get_valist       (GeglNode      *node,
  * left as NULL when forcing a rendering of a region.
  * @rowstride: rowstride in bytes, or GEGL_AUTO_ROWSTRIDE to compute the
  * rowstride based on the width and bytes per pixel for the specified format.
- * @flags: an or'ed combination of GEGL_BLIT_DEFAULT, GEGL_BLIT_CACHE and
- * GEGL_BLIT_DIRTY. if cache is enabled, a cache will be set up for subsequent
- * requests of image data from this node. By passing in GEGL_BLIT_DIRTY the
- * function will return with the latest rendered results in the cache without
- * regard to wheter the regions has been rendered or not.
+ * @flags: an or'ed combination of GEGL_BLIT_DEFAULT, GEGL_BLIT_CACHE,
+ * GEGL_BLIT_DIRTY and GEGL_BLIT_STREAM. if cache is enabled, a cache will be
+ * set up for subsequent requests of image data from this node. By passing in
+ * GEGL_BLIT_DIRTY the function will return with the latest rendered results
+ * in the cache without regard to wheter the regions has been rendered or not.
+ * GEGL_BLIT_STREAM is meant for regions that are rendered only once, like
+ * when exporting: the region is rendered in bands without storing results in
+ * the caches of the nodes, it is ignored when combined with GEGL_BLIT_CACHE.
  *
  * Render a rectangular region from a node.
  */
@@ -342,6 +345,18 @@ void          gegl_node_blit_buffer      (GeglNode            *node,
  */
 void          gegl_node_process          (GeglNode      *sink_node);
 
+/**
+ * gegl_node_get_memory_report:
+ * @node: a #GeglNode
+ * @report: (out caller-allocates): a #GeglMemoryReport to fill in.
+ *
+ * Retrieve the memory used by the most recent #gegl_node_blit or
+ * #gegl_node_process of @node, see #gegl_processor_get_memory_report.
+ * The report is all zeros if the node has not been rendered yet.
+ */
+void          gegl_node_get_memory_report (GeglNode         *node,
+                                           GeglMemoryReport *report);
+
 
 /***
  * Reparenting:
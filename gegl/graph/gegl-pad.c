@@ -45,12 +45,22 @@ G_DEFINE_TYPE_WITH_CODE (GeglPad, gegl_pad, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GEGL_TYPE_VISITABLE,
                                                 visitable_init))
 
+const gchar *gegl_pad_name_input  = NULL;
+const gchar *gegl_pad_name_aux    = NULL;
+const gchar *gegl_pad_name_aux2   = NULL;
+const gchar *gegl_pad_name_output = NULL;
+
 static void
 gegl_pad_class_init (GeglPadClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->finalize = finalize;
+
+  gegl_pad_name_input  = g_intern_static_string ("input");
+  gegl_pad_name_aux    = g_intern_static_string ("aux");
+  gegl_pad_name_aux2   = g_intern_static_string ("aux2");
+  gegl_pad_name_output = g_intern_static_string ("output");
 }
 
 static void
@@ -61,6 +71,7 @@ gegl_pad_init (GeglPad *self)
   self->connections = NULL;
   self->format      = NULL;
   self->name        = NULL;
+  self->slot        = -1;
 }
 
 static void
@@ -86,12 +97,6 @@ finalize (GObject *gobject)
       self->param_spec = NULL;
     }
 
-  if (self->name)
-    {
-      g_free (self->name);
-      self->name = NULL;
-    }
-
   G_OBJECT_CLASS (gegl_pad_parent_class)->finalize (gobject);
 }
 
@@ -212,12 +217,13 @@ gegl_pad_get_name (GeglPad *self)
   return self->name;
 }
 
+/* pad names are interned, letting lookups of names taken from other pads
+ * compare pointers instead of strings.
+ */
 void gegl_pad_set_name (GeglPad     *self,
                         const gchar *name)
 {
-  if (self->name)
-    g_free (self->name);
-  self->name = g_strdup (name);
+  self->name = g_intern_string (name);
 }
 
 GeglPad *
@@ -47,7 +47,9 @@ struct _GeglPad
                                  (initially only what it produces, and used
                                   for gegl_operation_get_target.)
                                */
-  gchar         *name;
+  const gchar   *name;        /* interned */
+  gint           slot;        /* index of the pad among the pads of its node,
+                                 see gegl_node_get_pad_slot() */
 };
 
 struct _GeglPadClass
@@ -56,6 +58,14 @@ struct _GeglPadClass
 };
 
 
+/* interned names of the pads the operation base classes create, set up
+ * with the class so that lookups by them only need to compare pointers
+ */
+extern const gchar *gegl_pad_name_input;
+extern const gchar *gegl_pad_name_aux;
+extern const gchar *gegl_pad_name_aux2;
+extern const gchar *gegl_pad_name_output;
+
 GType            gegl_pad_get_type                  (void) G_GNUC_CONST;
 
 const gchar    * gegl_pad_get_name                  (GeglPad        *self);
@@ -20,11 +20,15 @@
 
 #include <glib-object.h>
 #include <string.h>
+#include <math.h>
 
 #include "gegl.h"
 #include "gegl-operation-area-filter.h"
 #include "gegl-operation-context.h"
+#include "graph/gegl-pad.h"
+#include "gegl-operation-context-private.h"
 #include "gegl-types-internal.h"
+#include "graph/gegl-node-private.h"
 
 
 static void          prepare                  (GeglOperation       *operation);
@@ -35,6 +39,11 @@ static GeglRectangle get_required_for_output   (GeglOperation       *operation,
 static GeglRectangle get_invalidated_by_change (GeglOperation       *operation,
                                                  const gchar         *input_pad,
                                                  const GeglRectangle *input_region);
+static gboolean      process                   (GeglOperation        *operation,
+                                                 GeglOperationContext *context,
+                                                 const gchar          *output_prop,
+                                                 const GeglRectangle  *result,
+                                                 gint                  level);
 
 G_DEFINE_TYPE (GeglOperationAreaFilter, gegl_operation_area_filter,
                GEGL_TYPE_OPERATION_FILTER)
@@ -45,6 +54,7 @@ gegl_operation_area_filter_class_init (GeglOperationAreaFilterClass *klass)
   GeglOperationClass *operation_class = GEGL_OPERATION_CLASS (klass);
 
   operation_class->prepare = prepare;
+  operation_class->process = process;
   operation_class->get_bounding_box = get_bounding_box;
   operation_class->get_invalidated_by_change = get_invalidated_by_change;
   operation_class->get_required_for_output = get_required_for_output;
@@ -133,3 +143,263 @@ get_invalidated_by_change (GeglOperation        *operation,
 
   return retval;
 }
+
+void
+gegl_operation_area_filter_class_scale_properties (GeglOperationAreaFilterClass *klass,
+                                                   const gchar                  *first_property_name,
+                                                   ...)
+{
+  GPtrArray   *pspecs = g_ptr_array_new ();
+  const gchar *name;
+  va_list      var_args;
+
+  g_return_if_fail (GEGL_IS_OPERATION_AREA_FILTER_CLASS (klass));
+
+  va_start (var_args, first_property_name);
+
+  for (name = first_property_name; name; name = va_arg (var_args, const gchar *))
+    {
+      GParamSpec *pspec = g_object_class_find_property (G_OBJECT_CLASS (klass),
+                                                        name);
+
+      if (! pspec)
+        {
+          g_warning ("%s: no property named '%s'", G_STRFUNC, name);
+          continue;
+        }
+
+      switch (G_TYPE_FUNDAMENTAL (pspec->value_type))
+        {
+          case G_TYPE_INT:
+          case G_TYPE_FLOAT:
+          case G_TYPE_DOUBLE:
+            g_ptr_array_add (pspecs, pspec);
+            break;
+
+          default:
+            g_warning ("%s: property '%s' is not numeric", G_STRFUNC, name);
+            break;
+        }
+    }
+
+  va_end (var_args);
+
+  /* the array may be inherited from the parent class, leave it be */
+  klass->level_scaled = NULL;
+
+  if (pspecs->len)
+    {
+      g_ptr_array_add (pspecs, NULL);
+      klass->level_scaled = (GParamSpec **) g_ptr_array_free (pspecs, FALSE);
+    }
+  else
+    {
+      g_ptr_array_free (pspecs, TRUE);
+    }
+}
+
+static void
+property_scale (GParamSpec *pspec,
+                GValue     *value,
+                gint        level)
+{
+  gdouble factor = 1.0 / (1 << level);
+
+  switch (G_TYPE_FUNDAMENTAL (pspec->value_type))
+    {
+      case G_TYPE_INT:
+        g_value_set_int (value, floor (g_value_get_int (value) * factor + 0.5));
+        break;
+      case G_TYPE_FLOAT:
+        g_value_set_float (value, g_value_get_float (value) * factor);
+        break;
+      case G_TYPE_DOUBLE:
+        g_value_set_double (value, g_value_get_double (value) * factor);
+        break;
+      default:
+        break;
+    }
+
+  g_param_value_validate (pspec, value);
+}
+
+static gboolean
+level_scaled (GeglOperationAreaFilterClass *klass,
+              GParamSpec                   *pspec)
+{
+  gint i;
+
+  for (i = 0; klass->level_scaled[i]; i++)
+    if (klass->level_scaled[i] == pspec)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* A private copy of @operation, with its scale dependent properties
+ * scaled down to @level and the area following from them. The copy is
+ * processed instead of @operation so the properties and area others see
+ * are never touched.
+ */
+static GeglOperation *
+scaled_operation_new (GeglOperation *operation,
+                      gint           level)
+{
+  GeglOperationAreaFilterClass *klass;
+  GeglOperation                *scaled;
+  GParamSpec                  **pspecs;
+  guint                         n_pspecs;
+  guint                         i;
+
+  klass  = GEGL_OPERATION_AREA_FILTER_GET_CLASS (operation);
+  scaled = g_object_new (G_OBJECT_TYPE (operation), NULL);
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (operation),
+                                           &n_pspecs);
+
+  g_mutex_lock (&operation->node->mutex);
+
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GParamSpec *pspec = pspecs[i];
+      GValue      value = G_VALUE_INIT;
+
+      if (pspec->flags & (GEGL_PARAM_PAD_INPUT | GEGL_PARAM_PAD_OUTPUT |
+                          G_PARAM_CONSTRUCT_ONLY) ||
+          (pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+        continue;
+
+      g_value_init (&value, pspec->value_type);
+      g_object_get_property (G_OBJECT (operation), pspec->name, &value);
+
+      if (level_scaled (klass, pspec))
+        property_scale (pspec, &value, level);
+
+      g_object_set_property (G_OBJECT (scaled), pspec->name, &value);
+      g_value_unset (&value);
+    }
+
+  g_mutex_unlock (&operation->node->mutex);
+
+  g_free (pspecs);
+
+  /* prepare would set the formats of the pads of the node, which were
+   * negotiated before processing started, only the area is updated
+   */
+  klass->update_area (scaled);
+
+  /* not attached, the node does not know about the copy, the copy only
+   * reads the formats negotiated for the node
+   */
+  scaled->node = operation->node;
+
+  return scaled;
+}
+
+/* Runs the level 0 process of the operation on the input scaled down to
+ * @level, with its scale dependent properties and area scaled as well.
+ */
+static gboolean
+process_scaled (GeglOperation        *operation,
+                GeglOperationContext *context,
+                const GeglRectangle  *result,
+                gint                  level)
+{
+  GeglOperation                *scaled;
+  GeglOperationAreaFilter      *area;
+  GeglOperationContext         *scaled_context;
+  const Babl                   *in_format;
+  const Babl                   *out_format;
+  GeglBuffer                   *input;
+  GeglBuffer                   *output;
+  GeglBuffer                   *scaled_input;
+  GeglBuffer                   *scaled_output;
+  GeglRectangle                 scaled_result;
+  GeglRectangle                 scaled_need;
+  gpointer                      data;
+  gboolean                      success;
+
+  in_format  = gegl_operation_get_format (operation, "input");
+  out_format = gegl_operation_get_format (operation, "output");
+
+  input  = gegl_operation_context_get_source (context, gegl_pad_name_input);
+  output = gegl_operation_context_get_target (context, gegl_pad_name_output);
+
+  scaled_result.x      = result->x >> level;
+  scaled_result.y      = result->y >> level;
+  scaled_result.width  = ((result->x + result->width  + (1 << level) - 1) >> level) -
+                         scaled_result.x;
+  scaled_result.height = ((result->y + result->height + (1 << level) - 1) >> level) -
+                         scaled_result.y;
+
+  scaled = scaled_operation_new (operation, level);
+  area   = GEGL_OPERATION_AREA_FILTER (scaled);
+
+  scaled_need.x      = scaled_result.x - area->left;
+  scaled_need.y      = scaled_result.y - area->top;
+  scaled_need.width  = scaled_result.width  + area->left + area->right;
+  scaled_need.height = scaled_result.height + area->top  + area->bottom;
+
+  data = gegl_malloc (scaled_need.width * scaled_need.height *
+                      MAX (babl_format_get_bytes_per_pixel (in_format),
+                           babl_format_get_bytes_per_pixel (out_format)));
+
+  scaled_input = gegl_buffer_new (&scaled_need, in_format);
+
+  gegl_buffer_get (input, &scaled_need, 1.0 / (1 << level), in_format, data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  gegl_buffer_set (scaled_input, &scaled_need, 0, in_format, data,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  /* through the filter process, threaded like at level 0, streaming so
+   * the output is not the cache of the node
+   */
+  scaled_context = gegl_operation_context_new (scaled);
+  scaled_context->streaming = TRUE;
+  gegl_operation_context_set_need_rect (scaled_context, &scaled_result);
+  gegl_operation_context_set_result_rect (scaled_context, &scaled_result);
+  gegl_operation_context_set_object (scaled_context, "input",
+                                     G_OBJECT (scaled_input));
+
+  success = GEGL_OPERATION_CLASS (gegl_operation_area_filter_parent_class)->process (
+              scaled, scaled_context, "output", &scaled_result, 0);
+
+  scaled_output = GEGL_BUFFER (gegl_operation_context_get_object (scaled_context,
+                                                                  "output"));
+
+  if (success && scaled_output)
+    {
+      gegl_buffer_get (scaled_output, &scaled_result, 1.0, out_format, data,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      gegl_buffer_set (output, &scaled_result, level, out_format, data,
+                       GEGL_AUTO_ROWSTRIDE);
+    }
+
+  gegl_operation_context_destroy (scaled_context);
+  scaled->node = NULL;
+  g_object_unref (scaled);
+
+  gegl_free (data);
+  g_object_unref (scaled_input);
+  g_clear_object (&input);
+
+  return success;
+}
+
+static gboolean
+process (GeglOperation        *operation,
+         GeglOperationContext *context,
+         const gchar          *output_prop,
+         const GeglRectangle  *result,
+         gint                  level)
+{
+  GeglOperationAreaFilterClass *klass;
+
+  klass = GEGL_OPERATION_AREA_FILTER_GET_CLASS (operation);
+
+  if (level > 0 && klass->level_scaled && klass->update_area &&
+      ! strcmp (output_prop, "output"))
+    return process_scaled (operation, context, result, level);
+
+  return GEGL_OPERATION_CLASS (gegl_operation_area_filter_parent_class)->process (
+           operation, context, output_prop, result, level);
+}
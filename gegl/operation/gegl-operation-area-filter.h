@@ -51,11 +51,31 @@ typedef struct _GeglOperationAreaFilterClass GeglOperationAreaFilterClass;
 struct _GeglOperationAreaFilterClass
 {
   GeglOperationFilterClass parent_class;
-  gpointer                 pad[4];
+  GParamSpec             **level_scaled; /* properties scaled by the level,
+                                            NULL terminated */
+  /* set left, right, top and bottom from the properties, without touching
+   * anything else, needed with level scaled properties
+   */
+  void                   (*update_area) (GeglOperation *operation);
+  gpointer                 pad[2];
 };
 
 GType gegl_operation_area_filter_get_type (void) G_GNUC_CONST;
 
+/* Declare properties that are distances in pixels (radii, offsets), like
+ * "unit" "pixel-distance" properties are.  When such an operation is
+ * processed at a mipmap level above 0, its process is run at level 0 on
+ * the input scaled down to the level, with these properties and the area
+ * divided by 1 << level, and the result is stored at the level.  This
+ * makes operations that do not handle @level themselves give correct
+ * previews at reduced cost.  The area for the scaled properties is found
+ * with the update_area method of @klass, which must be set.
+ */
+void  gegl_operation_area_filter_class_scale_properties
+                                  (GeglOperationAreaFilterClass *klass,
+                                   const gchar                  *first_property_name,
+                                   ...) G_GNUC_NULL_TERMINATED;
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (GeglOperationAreaFilter, g_object_unref)
 
 G_END_DECLS
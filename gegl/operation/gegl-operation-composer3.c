@@ -24,7 +24,10 @@
 #include "gegl.h"
 #include "gegl-operation-composer3.h"
 #include "gegl-operation-context.h"
+#include "gegl-types-internal.h"
+#include "graph/gegl-pad.h"
 #include "gegl-config.h"
+#include "gegl-trace.h"
 
 static gboolean gegl_operation_composer3_process
 (GeglOperation        *operation,
@@ -123,10 +126,17 @@ typedef struct ThreadData
 static void thread_process (gpointer thread_data, gpointer unused)
 {
   ThreadData *data = thread_data;
+
+  GEGL_TRACE_START ();
+
   if (!data->klass->process (data->operation,
         data->input, data->aux, data->aux2, 
         data->output, &data->roi, data->level))
     data->success = FALSE;
+
+  GEGL_TRACE_END ("thread", gegl_node_get_operation (data->operation->node),
+                  &data->roi, data->level);
+
   g_atomic_int_add (data->pending, -1);
 }
 
@@ -164,18 +174,18 @@ gegl_operation_composer3_process (GeglOperation        *operation,
 
   if (result->width == 0 || result->height == 0)
   {
-    output = gegl_operation_context_get_target (context, "output");
+    output = gegl_operation_context_get_target (context, gegl_pad_name_output);
     return TRUE;
   }
 
-  input = gegl_operation_context_get_source (context, "input");
+  input = gegl_operation_context_get_source (context, gegl_pad_name_input);
   output = gegl_operation_context_get_output_maybe_in_place (operation,
                                                              context,
                                                              input,
                                                              result);
 
-  aux   = gegl_operation_context_get_source (context, "aux");
-  aux2  = gegl_operation_context_get_source (context, "aux2");
+  aux   = gegl_operation_context_get_source (context, gegl_pad_name_aux);
+  aux2  = gegl_operation_context_get_source (context, gegl_pad_name_aux2);
 
   /* A composer with a NULL aux, can still be valid, the
    * subclass has to handle it.
@@ -23,6 +23,16 @@
 
 G_BEGIN_DECLS
 
+/* the number of pads whose values are stored in the slots of a context
+ * rather than its list of properties
+ */
+#define GEGL_OPERATION_CONTEXT_SLOTS 8
+
+/* the bytes of pixels kept in buffers waiting to be recycled as the
+ * output of want_in_place operations
+ */
+#define GEGL_BUFFER_POOL_BYTES (16 * 1024 * 1024)
+
 
 /**
  * When a node in a GEGL graph does processing, it needs context such
@@ -34,7 +44,10 @@ struct _GeglOperationContext
 {
   GeglOperation *operation;
 
-  GSList        *property;    /* used internally for data being exchanged */
+  GValue         slots[GEGL_OPERATION_CONTEXT_SLOTS];
+                              /* the data exchanged on the pads of the
+                                 node, indexed by the slot of the pad */
+  GSList        *property;    /* data exchanged under other names */
   GeglRectangle  need_rect;   /* the rectangle needed from the operation */
   GeglRectangle  result_rect; /* the result computation rectangle for the operation ,
                                  (will differ if the needed rect extends beyond
@@ -60,11 +73,16 @@ struct _GeglOperationContext
                                                                    2 = 1:4,
                                                                    4 = 1:8,
                                                                    6 = 1:16 .. */
+  gboolean       streaming;     /* results are consumed once, compute them
+                                   into temporary buffers instead of the
+                                   node cache */
 };
 
 GeglOperationContext *gegl_operation_context_new       (GeglOperation        *operation);
 void                  gegl_operation_context_destroy   (GeglOperationContext *self);
 
+void            gegl_operation_context_pool_cleanup    (void);
+
 void            gegl_operation_context_set_property    (GeglOperationContext *self,
                                                         const gchar          *name,
                                                         const GValue         *value) G_GNUC_DEPRECATED;
@@ -33,6 +33,16 @@
 
 #include "operation/gegl-operation.h"
 
+/* Buffers handed out to operations that write their complete output
+ * (want_in_place) are recycled through this pool once the last context
+ * holding them lets go, saving the construction, tile-storage setup and
+ * first-touch tile allocation for the next chunk of the same shape. The
+ * pool keeps at most GEGL_BUFFER_POOL_BYTES worth of pixels.
+ */
+static GMutex  buffer_pool_mutex = { 0, };
+static GQueue  buffer_pool       = G_QUEUE_INIT;
+static guint64 buffer_pool_bytes = 0;
+
 static GValue *
 gegl_operation_context_add_value (GeglOperationContext *self,
                                   const gchar          *property_name);
@@ -96,6 +106,110 @@ gegl_operation_context_get_property (GeglOperationContext *context,
     }
 }
 
+static GQuark
+gegl_buffer_pooled_quark (void)
+{
+  static GQuark the_quark = 0;
+
+  if (G_UNLIKELY (the_quark == 0))
+    the_quark = g_quark_from_static_string ("gegl-buffer-pooled");
+
+  return the_quark;
+}
+
+static guint64
+buffer_pool_size (GeglBuffer *buffer)
+{
+  const GeglRectangle *extent = gegl_buffer_get_extent (buffer);
+
+  return (guint64) extent->width * extent->height *
+         babl_format_get_bytes_per_pixel (gegl_buffer_get_format (buffer));
+}
+
+static GeglBuffer *
+buffer_pool_acquire (const GeglRectangle *extent,
+                     const Babl          *format)
+{
+  GeglBuffer *buffer = NULL;
+  GList      *iter;
+
+  g_mutex_lock (&buffer_pool_mutex);
+  for (iter = buffer_pool.head; iter; iter = iter->next)
+    {
+      GeglBuffer *candidate = iter->data;
+
+      if (gegl_buffer_get_format (candidate) == format &&
+          gegl_rectangle_equal (gegl_buffer_get_extent (candidate), extent))
+        {
+          g_queue_delete_link (&buffer_pool, iter);
+          buffer_pool_bytes -= buffer_pool_size (candidate);
+          buffer = candidate;
+          break;
+        }
+    }
+  g_mutex_unlock (&buffer_pool_mutex);
+
+  if (!buffer)
+    {
+      buffer = gegl_buffer_new (extent, format);
+      g_object_set_qdata (G_OBJECT (buffer), gegl_buffer_pooled_quark (),
+                          (void*)0xf);
+    }
+
+  return buffer;
+}
+
+/* takes over the reference held by the caller */
+static void
+buffer_pool_release (GeglBuffer *buffer)
+{
+  GList   *evicted = NULL;
+  guint64  size    = buffer_pool_size (buffer);
+
+  if (size > GEGL_BUFFER_POOL_BYTES)
+    {
+      g_object_unref (buffer);
+      return;
+    }
+
+  g_mutex_lock (&buffer_pool_mutex);
+  g_queue_push_head (&buffer_pool, buffer);
+  buffer_pool_bytes += size;
+
+  /* the least recently released buffers go first */
+  while (buffer_pool_bytes > GEGL_BUFFER_POOL_BYTES)
+    {
+      GeglBuffer *oldest = g_queue_pop_tail (&buffer_pool);
+
+      buffer_pool_bytes -= buffer_pool_size (oldest);
+      evicted = g_list_prepend (evicted, oldest);
+    }
+  g_mutex_unlock (&buffer_pool_mutex);
+
+  g_list_free_full (evicted, g_object_unref);
+}
+
+static gboolean
+buffer_is_recyclable (GObject *object)
+{
+  return object &&
+         g_object_get_qdata (object, gegl_buffer_pooled_quark ()) != NULL &&
+         g_atomic_int_get (&object->ref_count) == 1 &&
+         !gegl_object_get_has_forked (object);
+}
+
+void
+gegl_operation_context_pool_cleanup (void)
+{
+  GeglBuffer *buffer;
+
+  g_mutex_lock (&buffer_pool_mutex);
+  while ((buffer = g_queue_pop_head (&buffer_pool)))
+    g_object_unref (buffer);
+  buffer_pool_bytes = 0;
+  g_mutex_unlock (&buffer_pool_mutex);
+}
+
 typedef struct Property
 {
   gchar *name;
@@ -111,14 +225,52 @@ property_new (const gchar *property_name)
   return property;
 }
 
+static void
+value_unset (GValue *value)
+{
+  GObject *object = NULL;
+
+  if (G_VALUE_HOLDS_OBJECT (value))
+    object = g_value_get_object (value);
+
+  if (buffer_is_recyclable (object))
+    {
+      g_object_ref (object);
+      g_value_unset (value);
+      buffer_pool_release (GEGL_BUFFER (object));
+    }
+  else
+    {
+      g_value_unset (value); /* does an unref */
+    }
+}
+
 static void
 property_destroy (Property *property)
 {
   g_free (property->name);
-  g_value_unset (&property->value); /* does an unref */
+  value_unset (&property->value);
   g_slice_free (Property, property);
 }
 
+/* the slot storing the value of the pad called property_name, or -1 when
+ * it is kept in the property list
+ */
+static inline gint
+context_slot (GeglOperationContext *self,
+              const gchar          *property_name)
+{
+  gint slot;
+
+  /* without a node there are no pads, the properties are kept in the list */
+  if (!self->operation->node)
+    return -1;
+
+  slot = gegl_node_get_pad_slot (self->operation->node, property_name);
+
+  return slot < GEGL_OPERATION_CONTEXT_SLOTS ? slot : -1;
+}
+
 static gint
 lookup_property (gconstpointer a,
                  gconstpointer property_name)
@@ -133,6 +285,10 @@ gegl_operation_context_get_value (GeglOperationContext *self,
                                   const gchar          *property_name)
 {
   Property *property = NULL;
+  gint      slot     = context_slot (self, property_name);
+
+  if (slot >= 0)
+    return G_IS_VALUE (&self->slots[slot]) ? &self->slots[slot] : NULL;
 
   {
     GSList *found;
@@ -152,8 +308,15 @@ gegl_operation_context_remove_property (GeglOperationContext *self,
                                         const gchar          *property_name)
 {
   Property *property = NULL;
+  gint      slot     = context_slot (self, property_name);
+  GSList   *found;
+
+  if (slot >= 0 && G_IS_VALUE (&self->slots[slot]))
+    {
+      value_unset (&self->slots[slot]);
+      return;
+    }
 
-  GSList *found;
   found = g_slist_find_custom (self->property, property_name, lookup_property);
   if (found)
     property = found->data;
@@ -173,8 +336,21 @@ gegl_operation_context_add_value (GeglOperationContext *self,
                                   const gchar          *property_name)
 {
   Property *property = NULL;
+  gint      slot     = context_slot (self, property_name);
   GSList   *found;
 
+  if (slot >= 0)
+    {
+      GValue *value = &self->slots[slot];
+
+      if (G_IS_VALUE (value))
+        g_value_reset (value);
+      else
+        g_value_init (value, GEGL_TYPE_BUFFER);
+
+      return value;
+    }
+
   found = g_slist_find_custom (self->property, property_name, lookup_property);
 
   if (found)
@@ -207,6 +383,12 @@ gegl_operation_context_new (GeglOperation *operation)
 void
 gegl_operation_context_purge (GeglOperationContext *self)
 {
+  gint slot;
+
+  for (slot = 0; slot < GEGL_OPERATION_CONTEXT_SLOTS; slot++)
+    if (G_IS_VALUE (&self->slots[slot]))
+      value_unset (&self->slots[slot]);
+
   while (self->property)
     {
       Property *property = self->property->data;
@@ -326,8 +508,10 @@ gegl_operation_context_get_target (GeglOperationContext *context,
       else
         output = gegl_buffer_new (GEGL_RECTANGLE (0, 0, 0, 0), format);
     }
-  else if (node->dont_cache == FALSE &&
-      ! GEGL_OPERATION_CLASS (G_OBJECT_GET_CLASS (operation))->no_cache)
+  else if (context->streaming == FALSE &&
+           node->dont_cache == FALSE &&
+           node->auto_dont_cache == FALSE &&
+           ! GEGL_OPERATION_CLASS (G_OBJECT_GET_CLASS (operation))->no_cache)
     {
       GeglBuffer    *cache;
       cache = GEGL_BUFFER (gegl_node_get_cache (node));
@@ -352,6 +536,11 @@ gegl_operation_context_get_target (GeglOperationContext *context,
     {
       if (linear_buffers)
         output = gegl_buffer_linear_new (result, format);
+      else if (GEGL_OPERATION_GET_CLASS (operation)->want_in_place)
+        /* the contents of a recycled buffer are stale, this is only safe
+         * for operations that write every pixel of their result
+         */
+        output = buffer_pool_acquire (result, format);
       else
         output = gegl_buffer_new (result, format);
     }
@@ -24,7 +24,10 @@
 #include "gegl.h"
 #include "gegl-operation-filter.h"
 #include "gegl-operation-context.h"
+#include "gegl-types-internal.h"
+#include "graph/gegl-pad.h"
 #include "gegl-config.h"
+#include "gegl-trace.h"
 
 static gboolean gegl_operation_filter_process
                                       (GeglOperation        *operation,
@@ -120,9 +123,16 @@ typedef struct ThreadData
 static void thread_process (gpointer thread_data, gpointer unused)
 {
   ThreadData *data = thread_data;
+
+  GEGL_TRACE_START ();
+
   if (!data->klass->process (data->operation,
                        data->input, data->output, &data->roi, data->level))
     data->success = FALSE;
+
+  GEGL_TRACE_END ("thread", gegl_node_get_operation (data->operation->node),
+                  &data->roi, data->level);
+
   g_atomic_int_add (data->pending, -1);
 }
 
@@ -159,7 +169,7 @@ gegl_operation_filter_process (GeglOperation        *operation,
       return FALSE;
     }
 
-  input  = gegl_operation_context_get_source (context, "input");
+  input  = gegl_operation_context_get_source (context, gegl_pad_name_input);
   output = gegl_operation_context_get_output_maybe_in_place (operation,
                                                              context,
                                                              input,
@@ -40,9 +40,10 @@ gegl_operation_meta_class_init (GeglOperationMetaClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
-  object_class->finalize               = finalize;
-  object_class->constructed            = constructed;
-  GEGL_OPERATION_CLASS (klass)->detect = detect;
+  object_class->finalize                      = finalize;
+  object_class->constructed                   = constructed;
+  GEGL_OPERATION_CLASS (klass)->detect        = detect;
+  GEGL_OPERATION_CLASS (klass)->memoize_rects = TRUE;
 }
 
 static void
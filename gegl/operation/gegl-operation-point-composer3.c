@@ -25,7 +25,10 @@
 #include "gegl-operation-point-composer3.h"
 #include "gegl-operation-context.h"
 #include "gegl-types-internal.h"
+#include "graph/gegl-pad.h"
 #include "gegl-config.h"
+#include "gegl-trace.h"
+#include "gegl-stats.h"
 #include <sys/types.h>
 #include <unistd.h>
 #include <string.h>
@@ -52,6 +55,14 @@ typedef struct ThreadData
   const Babl *aux_fish;
   const Babl *aux2_fish;
   const Babl *output_fish;
+  const Babl *in_buf_format;
+  const Babl *in_format;
+  const Babl *aux_buf_format;
+  const Babl *aux_format;
+  const Babl *aux2_buf_format;
+  const Babl *aux2_format;
+  const Babl *out_format;
+  const Babl *output_buf_format;
 } ThreadData;
 
 static void thread_process (gpointer thread_data, gpointer unused)
@@ -64,19 +75,27 @@ static void thread_process (gpointer thread_data, gpointer unused)
   guchar *output = data->output;
   glong samples = data->roi.width * data->roi.height;
 
+  GEGL_TRACE_START ();
+
   if (data->input_fish && input)
     {
-      babl_process (data->input_fish, data->input, data->in_tmp, samples);
+      gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                               data->in_buf_format, data->in_format,
+                               data->input_fish, data->input, data->in_tmp, samples);
       input = data->in_tmp;
     }
   if (data->aux_fish && aux)
     {
-      babl_process (data->aux_fish, data->aux, data->aux_tmp, samples);
+      gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                               data->aux_buf_format, data->aux_format,
+                               data->aux_fish, data->aux, data->aux_tmp, samples);
       aux = data->aux_tmp;
     }
   if (data->aux2_fish && aux2)
     {
-      babl_process (data->aux2_fish, data->aux2, data->aux2_tmp, samples);
+      gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                               data->aux2_buf_format, data->aux2_format,
+                               data->aux2_fish, data->aux2, data->aux2_tmp, samples);
       aux2 = data->aux2_tmp;
     }
   if (data->output_fish)
@@ -89,7 +108,12 @@ static void thread_process (gpointer thread_data, gpointer unused)
     data->success = FALSE;
   
   if (data->output_fish)
-    babl_process (data->output_fish, data->output_tmp, data->output, samples);
+    gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                             data->out_format, data->output_buf_format,
+                             data->output_fish, data->output_tmp, data->output, samples);
+
+  GEGL_TRACE_END ("thread", gegl_node_get_operation (data->operation->node),
+                  &data->roi, data->level);
 
   g_atomic_int_add (data->pending, -1);
 }
@@ -127,18 +151,18 @@ gegl_operation_composer3_process (GeglOperation        *operation,
 
   if (result->width == 0 || result->height == 0)
   {
-    output = gegl_operation_context_get_target (context, "output");
+    output = gegl_operation_context_get_target (context, gegl_pad_name_output);
     return TRUE;
   }
 
-  input  = gegl_operation_context_get_source (context, "input");
+  input  = gegl_operation_context_get_source (context, gegl_pad_name_input);
   output = gegl_operation_context_get_output_maybe_in_place (operation,
                                                              context,
                                                              input,
                                                              result);
 
-  aux   = gegl_operation_context_get_source (context, "aux");
-  aux2  = gegl_operation_context_get_source (context, "aux2");
+  aux   = gegl_operation_context_get_source (context, gegl_pad_name_aux);
+  aux2  = gegl_operation_context_get_source (context, gegl_pad_name_aux2);
 
   /* A composer with a NULL aux, can still be valid, the
    * subclass has to handle it.
@@ -271,6 +295,8 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
             if (in_buf_format != in_format)
             {
               thread_data[j].input_fish = babl_fish (in_buf_format, in_format);
+              thread_data[j].in_buf_format = in_buf_format;
+              thread_data[j].in_format = in_format;
               thread_data[j].in_tmp = gegl_temp_buffer (temp_id++, in_bpp * result->width * result->height);
             }
             else
@@ -297,6 +323,8 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
             if (aux_buf_format != aux_format)
             {
               thread_data[j].aux_fish = babl_fish (aux_buf_format, aux_format);
+              thread_data[j].aux_buf_format = aux_buf_format;
+              thread_data[j].aux_format = aux_format;
               thread_data[j].aux_tmp = gegl_temp_buffer (temp_id++, aux_bpp * result->width * result->height);
             }
             else
@@ -325,6 +353,8 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
             if (aux2_buf_format != aux2_format)
             {
               thread_data[j].aux2_fish = babl_fish (aux2_buf_format, aux2_format);
+              thread_data[j].aux2_buf_format = aux2_buf_format;
+              thread_data[j].aux2_format = aux2_format;
               thread_data[j].aux2_tmp = gegl_temp_buffer (temp_id++, aux2_bpp * result->width * result->height);
             }
             else
@@ -344,6 +374,8 @@ gegl_operation_point_composer3_process (GeglOperation       *operation,
           if (output_buf_format != gegl_buffer_get_format (output))
           {
             thread_data[j].output_fish = babl_fish (out_format, output_buf_format);
+            thread_data[j].out_format = out_format;
+            thread_data[j].output_buf_format = output_buf_format;
             thread_data[j].output_tmp = gegl_temp_buffer (temp_id++, out_bpp * result->width * result->height);
           }
           else
@@ -26,7 +26,10 @@
 #include "gegl-operation-point-filter.h"
 #include "gegl-operation-context.h"
 #include "gegl-config.h"
+#include "gegl-trace.h"
+#include "gegl-stats.h"
 #include "gegl-types-internal.h"
+#include "graph/gegl-pad.h"
 #include <sys/types.h>
 #include <unistd.h>
 #include <string.h>
@@ -50,6 +53,10 @@ typedef struct ThreadData
   guchar                          *output_tmp;
   const Babl *input_fish;
   const Babl *output_fish;
+  const Babl *in_buf_format;
+  const Babl *in_format;
+  const Babl *out_format;
+  const Babl *output_buf_format;
 } ThreadData;
 
 static void thread_process (gpointer thread_data, gpointer unused)
@@ -60,9 +67,13 @@ static void thread_process (gpointer thread_data, gpointer unused)
   guchar *output = data->output;
   glong samples = data->roi.width * data->roi.height;
 
+  GEGL_TRACE_START ();
+
   if (data->input_fish && input)
     {
-      babl_process (data->input_fish, data->input, data->in_tmp, samples);
+      gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                               data->in_buf_format, data->in_format,
+                               data->input_fish, data->input, data->in_tmp, samples);
       input = data->in_tmp;
     }
   if (data->output_fish)
@@ -75,7 +86,12 @@ static void thread_process (gpointer thread_data, gpointer unused)
     data->success = FALSE;
   
   if (data->output_fish)
-    babl_process (data->output_fish, data->output_tmp, data->output, samples);
+    gegl_stats_babl_process (GEGL_CONVERSION_SITE_POINT_OP,
+                             data->out_format, data->output_buf_format,
+                             data->output_fish, data->output_tmp, data->output, samples);
+
+  GEGL_TRACE_END ("thread", gegl_node_get_operation (data->operation->node),
+                  &data->roi, data->level);
 
   g_atomic_int_add (data->pending, -1);
 }
@@ -121,11 +137,11 @@ gegl_operation_filter_process (GeglOperation        *operation,
 
   if (result->width == 0 || result->height == 0)
   {
-    output = gegl_operation_context_get_target (context, "output");
+    output = gegl_operation_context_get_target (context, gegl_pad_name_output);
     return TRUE;
   }
 
-  input  = gegl_operation_context_get_source (context, "input");
+  input  = gegl_operation_context_get_source (context, gegl_pad_name_input);
   output = gegl_operation_context_get_output_maybe_in_place (operation,
                                                              context,
                                                              input,
@@ -312,6 +328,8 @@ gegl_operation_point_filter_process (GeglOperation       *operation,
             if (in_buf_format != in_format)
             {
               thread_data[j].input_fish = babl_fish (in_buf_format, in_format);
+              thread_data[j].in_buf_format = in_buf_format;
+              thread_data[j].in_format = in_format;
               thread_data[j].in_tmp = gegl_temp_buffer (temp_id++, in_bpp * result->width * result->height);
             }
             else
@@ -329,6 +347,8 @@ gegl_operation_point_filter_process (GeglOperation       *operation,
           if (output_buf_format != gegl_buffer_get_format (output))
           {
             thread_data[j].output_fish = babl_fish (out_format, output_buf_format);
+            thread_data[j].out_format = out_format;
+            thread_data[j].output_buf_format = output_buf_format;
             thread_data[j].output_tmp = gegl_temp_buffer (temp_id++, out_bpp * result->width * result->height);
           }
           else
@@ -25,6 +25,7 @@
 #include "gegl-types-internal.h"
 #include "gegl-operation-sink.h"
 #include "gegl-operation-context.h"
+#include "graph/gegl-pad.h"
 
 static gboolean      gegl_operation_sink_process                 (GeglOperation        *operation,
                                                                   GeglOperationContext *context,
@@ -90,7 +91,7 @@ gegl_operation_sink_process (GeglOperation        *operation,
 
   g_assert (klass->process);
 
-  input = gegl_operation_context_get_source (context, "input");
+  input = gegl_operation_context_get_source (context, gegl_pad_name_input);
   if (input)
     {
       success = klass->process (operation, input, result, level);
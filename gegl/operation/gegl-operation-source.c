@@ -24,7 +24,10 @@
 #include "gegl.h"
 #include "gegl-operation-source.h"
 #include "gegl-operation-context.h"
+#include "gegl-types-internal.h"
+#include "graph/gegl-pad.h"
 #include "gegl-config.h"
+#include "gegl-trace.h"
 
 static gboolean gegl_operation_source_process
                              (GeglOperation        *operation,
@@ -94,9 +97,16 @@ typedef struct ThreadData
 static void thread_process (gpointer thread_data, gpointer unused)
 {
   ThreadData *data = thread_data;
+
+  GEGL_TRACE_START ();
+
   if (!data->klass->process (data->operation,
                        data->output, &data->roi, data->level))
     data->success = FALSE;
+
+  GEGL_TRACE_END ("thread", gegl_node_get_operation (data->operation->node),
+                  &data->roi, data->level);
+
   g_atomic_int_add (data->pending, -1);
 }
 
@@ -129,7 +139,7 @@ gegl_operation_source_process (GeglOperation        *operation,
     }
 
   g_assert (klass->process);
-  output = gegl_operation_context_get_target (context, "output");
+  output = gegl_operation_context_get_target (context, gegl_pad_name_output);
 
   if (gegl_operation_use_threading (operation, result))
   {
@@ -218,11 +218,53 @@ gegl_operation_get_invalidated_by_change (GeglOperation       *self,
     return *input_region;
 
   if (klass->get_invalidated_by_change)
-    return klass->get_invalidated_by_change (self, input_pad, input_region);
+    {
+      if (!klass->memoize_rects || !self->node)
+        return klass->get_invalidated_by_change (self, input_pad, input_region);
+
+      if (gegl_node_lookup_rect (self->node, TRUE, input_pad, input_region, &retval))
+        return retval;
+
+      retval = klass->get_invalidated_by_change (self, input_pad, input_region);
+
+      gegl_node_remember_rect (self->node, TRUE, input_pad, input_region, &retval);
+
+      return retval;
+    }
 
   return *input_region;
 }
 
+GeglRectangle
+gegl_operation_get_invalidated_by_property (GeglOperation       *self,
+                                            const gchar         *property_name,
+                                            const GeglRectangle *old_bounding_box,
+                                            const GeglRectangle *new_bounding_box)
+{
+  GeglOperationClass *klass;
+  GeglRectangle       retval = { 0, };
+
+  g_return_val_if_fail (GEGL_IS_OPERATION (self), retval);
+  g_return_val_if_fail (property_name != NULL, retval);
+  g_return_val_if_fail (old_bounding_box != NULL, retval);
+  g_return_val_if_fail (new_bounding_box != NULL, retval);
+
+  /* the properties of a passthrough node do not affect its output */
+  if (self->node && self->node->passthrough)
+    return retval;
+
+  klass = GEGL_OPERATION_GET_CLASS (self);
+
+  if (klass->get_invalidated_by_property)
+    return klass->get_invalidated_by_property (self, property_name,
+                                               old_bounding_box,
+                                               new_bounding_box);
+
+  gegl_rectangle_bounding_box (&retval, old_bounding_box, new_bounding_box);
+
+  return retval;
+}
+
 static GeglRectangle
 get_required_for_output (GeglOperation        *operation,
                          const gchar         *input_pad,
@@ -245,6 +287,7 @@ gegl_operation_get_required_for_output (GeglOperation        *operation,
                                         const GeglRectangle *roi)
 {
   GeglOperationClass *klass = GEGL_OPERATION_GET_CLASS (operation);
+  GeglRectangle       result;
 
   if (roi->width == 0 ||
       roi->height == 0)
@@ -255,7 +298,21 @@ gegl_operation_get_required_for_output (GeglOperation        *operation,
 
   g_assert (klass->get_required_for_output);
 
-  return klass->get_required_for_output (operation, input_pad, roi);
+  /* transform chains and meta operations are asked for the same regions
+   * over and over while the graph does not change, for other operations
+   * the memo costs more than it saves
+   */
+  if (!klass->memoize_rects || !operation->node)
+    return klass->get_required_for_output (operation, input_pad, roi);
+
+  if (gegl_node_lookup_rect (operation->node, FALSE, input_pad, roi, &result))
+    return result;
+
+  result = klass->get_required_for_output (operation, input_pad, roi);
+
+  gegl_node_remember_rect (operation->node, FALSE, input_pad, roi, &result);
+
+  return result;
 }
 
 
@@ -87,7 +87,14 @@ struct _GeglOperationClass
                                   to accelerate rendering; this allows opting in/out
                                   in the sub-classes of these.
                                 */
-  guint64         bit_pad:60;
+  guint           memoize_rects:1; /* remember the regions computed by
+                                      get_required_for_output and
+                                      get_invalidated_by_change for the
+                                      node, for operations asked for the
+                                      same regions over and over, like
+                                      meta operations and transforms.
+                                    */
+  guint64         bit_pad:59;
 
   /* attach this operation with a GeglNode, override this if you are creating a
    * GeglGraph, it is already defined for Filters/Sources/Composers.
@@ -151,13 +158,37 @@ struct _GeglOperationClass
 
   GeglClRunData *cl_data;
 
-  gpointer      pad[9];
+  /* Formats, in order of preference, the operation can process with the
+   * same format on its "input" and "output" pads. Graph preparation uses
+   * this to follow the format of the source and avoid conversions between
+   * operations; the format actually chosen must be looked up with
+   * gegl_operation_get_format() when processing. Returns a NULL terminated
+   * array owned by the operation, or NULL to keep the format set in prepare.
+   */
+  const Babl  **(*get_supported_formats)     (GeglOperation *operation);
+
+  /* The region of the output changed by setting a property, given the
+   * bounding box from before and after the change. Defaults to both
+   * bounding boxes, returning an empty rectangle stops the change from
+   * invalidating anything.
+   */
+  GeglRectangle (*get_invalidated_by_property) (GeglOperation       *operation,
+                                                const gchar         *property_name,
+                                                const GeglRectangle *old_bounding_box,
+                                                const GeglRectangle *new_bounding_box);
+
+  gpointer      pad[7];
 };
 
 GeglRectangle   gegl_operation_get_invalidated_by_change
                                              (GeglOperation *operation,
                                               const gchar   *input_pad,
                                               const GeglRectangle *roi);
+GeglRectangle   gegl_operation_get_invalidated_by_property
+                                             (GeglOperation *operation,
+                                              const gchar   *property_name,
+                                              const GeglRectangle *old_bounding_box,
+                                              const GeglRectangle *new_bounding_box);
 GeglRectangle   gegl_operation_get_bounding_box  (GeglOperation *operation);
 
 /* retrieves the bounding box of an input pad */
@@ -0,0 +1,211 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Adaptive cache placement: with a cache budget configured, nodes only
+ * keep writing their results into their GeglCache when recomputing them
+ * is expensive compared to the memory the cache costs. The cost of a
+ * node is its measured time per pixel, weighted by how often requests
+ * for it were served from its cache; nodes are kept in order of benefit
+ * per byte until the budget is used up.
+ */
+
+#include "config.h"
+
+#include <glib-object.h>
+
+#include "gegl.h"
+#include "gegl-types-internal.h"
+#include "gegl-debug.h"
+#include "gegl-config.h"
+
+#include "graph/gegl-node-private.h"
+#include "graph/gegl-pad.h"
+#include "operation/gegl-operation.h"
+
+#include "process/gegl-cache-policy.h"
+
+/* below this many microseconds per pixel recomputing is about as cheap as
+ * fetching the pixels from a cache
+ */
+#define GEGL_CACHE_POLICY_MIN_COST  0.01
+
+/* counts are halved when reaching this, letting old behavior fade out */
+#define GEGL_CACHE_POLICY_WINDOW    256
+
+typedef struct
+{
+  GeglNode *node;
+  gdouble   benefit; /* microseconds saved by fully caching the node */
+  gdouble   density; /* benefit per byte */
+  guint64   bytes;
+} Candidate;
+
+/* the same node can be processed by several processors at once, its
+ * measurements and decision are only touched with this held
+ */
+static GMutex policy_mutex;
+
+void
+gegl_cache_policy_record (GeglNode *node,
+                          gint64    pixels,
+                          glong     usecs,
+                          gboolean  cached)
+{
+  /* without a budget nothing is decided, and this is called for every
+   * node on every chunk
+   */
+  if (pixels <= 0 || gegl_config ()->cache_budget == 0)
+    return;
+
+  g_mutex_lock (&policy_mutex);
+
+  node->cache_requests++;
+
+  if (cached)
+    {
+      node->cache_hits++;
+    }
+  else if (usecs > 0)
+    {
+      gdouble usecs_per_pixel = (gdouble) usecs / pixels;
+
+      if (node->usecs_per_pixel == 0.0)
+        node->usecs_per_pixel = usecs_per_pixel;
+      else
+        node->usecs_per_pixel = node->usecs_per_pixel * 0.75 +
+                                usecs_per_pixel * 0.25;
+    }
+
+  if (node->cache_requests >= GEGL_CACHE_POLICY_WINDOW)
+    {
+      node->cache_requests /= 2;
+      node->cache_hits     /= 2;
+    }
+
+  g_mutex_unlock (&policy_mutex);
+}
+
+static gint
+candidate_compare (gconstpointer a,
+                   gconstpointer b)
+{
+  const Candidate *ca = a;
+  const Candidate *cb = b;
+
+  if (ca->density > cb->density)
+    return -1;
+  if (ca->density < cb->density)
+    return 1;
+  return 0;
+}
+
+static void
+gegl_cache_policy_decide (GeglNode *node,
+                          gboolean  keep,
+                          gdouble   benefit)
+{
+  if (node->auto_dont_cache == !keep)
+    return;
+
+  node->auto_dont_cache = !keep;
+
+  GEGL_NOTE (GEGL_DEBUG_CACHE,
+             "%s caching for %s (%.3f usecs/px, %u/%u hits, benefit %.0f)",
+             keep ? "Enabling" : "Disabling",
+             gegl_node_get_debug_name (node),
+             node->usecs_per_pixel,
+             node->cache_hits, node->cache_requests,
+             benefit);
+}
+
+void
+gegl_cache_policy_update (GList               *dfs_path,
+                          const GeglRectangle *extent)
+{
+  guint64  budget = gegl_config ()->cache_budget;
+  GArray  *candidates;
+  GList   *iter;
+  guint    i;
+
+  if (budget == 0 || !dfs_path)
+    return;
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (Candidate));
+
+  g_mutex_lock (&policy_mutex);
+
+  /* the requested node is where results are read back from, it always
+   * keeps its cache and is not part of the ranking, even when an earlier
+   * traversal ranked it out as an intermediate node
+   */
+  iter = g_list_last (dfs_path);
+  gegl_cache_policy_decide (GEGL_NODE (iter->data), TRUE, 0.0);
+
+  for (iter = dfs_path; iter->next; iter = iter->next)
+    {
+      GeglNode      *node = GEGL_NODE (iter->data);
+      GeglPad       *pad  = gegl_node_get_pad (node, "output");
+      GeglRectangle  area;
+      const Babl    *format;
+      Candidate      candidate;
+      gdouble        reuse;
+
+      if (node->dont_cache ||
+          !node->operation ||
+          GEGL_OPERATION_GET_CLASS (node->operation)->no_cache ||
+          !pad ||
+          node->usecs_per_pixel == 0.0)
+        continue;
+
+      format = gegl_pad_get_format (pad);
+      gegl_rectangle_intersect (&area, &node->have_rect, extent);
+
+      reuse = (gdouble) node->cache_hits / node->cache_requests;
+
+      candidate.node    = node;
+      candidate.bytes   = (guint64) area.width * area.height *
+                          (format ? babl_format_get_bytes_per_pixel (format) : 16);
+      candidate.benefit = node->usecs_per_pixel * (1.0 + reuse) *
+                          ((gdouble) area.width * area.height);
+      candidate.density = candidate.bytes ?
+                          candidate.benefit / candidate.bytes : 0.0;
+
+      if (node->usecs_per_pixel < GEGL_CACHE_POLICY_MIN_COST)
+        {
+          gegl_cache_policy_decide (node, FALSE, candidate.benefit);
+          continue;
+        }
+
+      g_array_append_val (candidates, candidate);
+    }
+
+  g_array_sort (candidates, candidate_compare);
+
+  for (i = 0; i < candidates->len; i++)
+    {
+      Candidate *candidate = &g_array_index (candidates, Candidate, i);
+      gboolean   keep      = candidate->bytes <= budget;
+
+      if (keep)
+        budget -= candidate->bytes;
+
+      gegl_cache_policy_decide (candidate->node, keep, candidate->benefit);
+    }
+
+  g_mutex_unlock (&policy_mutex);
+
+  g_array_free (candidates, TRUE);
+}
@@ -0,0 +1,39 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_CACHE_POLICY_H__
+#define __GEGL_CACHE_POLICY_H__
+
+G_BEGIN_DECLS
+
+/* record that @node was asked for @pixels pixels, taking @usecs to compute
+ * them, or none at all if the request was fulfilled by its cache.
+ */
+void     gegl_cache_policy_record (GeglNode *node,
+                                   gint64    pixels,
+                                   glong     usecs,
+                                   gboolean  cached);
+
+/* decide which nodes of a traversal, given as a dfs ordered list ending
+ * with the requested node, keep storing their results in their caches,
+ * expecting them to eventually cache @extent.
+ */
+void     gegl_cache_policy_update (GList               *dfs_path,
+                                   const GeglRectangle *extent);
+
+G_END_DECLS
+
+#endif /* __GEGL_CACHE_POLICY_H__ */
@@ -0,0 +1,586 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Persistent render cache: with a disk cache directory configured, node
+ * caches are backed by files named after a digest of everything that
+ * determines their content, the operations, property values and source
+ * files of the graph upstream of the node. A later process building the
+ * same graph finds the pixels, and the rectangles they are valid for,
+ * already there.
+ *
+ * Each entry consists of <key>.gegl, a GeglBuffer file holding the tiles
+ * of all levels, <key>.valid, the valid rectangles saved by the cache, and
+ * <key>.lock while a process has the entry open. Entries not in use are
+ * removed least recently used first when the directory grows beyond the
+ * configured size.
+ */
+
+#include "config.h"
+
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifdef G_OS_UNIX
+#include <signal.h>
+#endif
+
+#ifdef G_OS_WIN32
+#include <process.h>
+#define getpid() _getpid()
+#endif
+
+#include <glib-object.h>
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+#include "gegl-types-internal.h"
+#include "gegl-debug.h"
+#include "gegl-config.h"
+
+#include "graph/gegl-node-private.h"
+#include "graph/gegl-pad.h"
+#include "operation/gegl-operation.h"
+#include "property-types/gegl-paramspecs.h"
+
+#include "process/gegl-disk-cache.h"
+
+#define GEGL_DISK_CACHE_LOCK_KEY "gegl-disk-cache-lock"
+
+static void
+append_double (GString *str,
+               gdouble  value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append (str, g_ascii_dtostr (buf, sizeof (buf), value));
+  g_string_append_c (str, ' ');
+}
+
+/* append a stable representation of the value of @pspec on @node to
+ * @checksum, returns FALSE for values that have none.
+ */
+static gboolean
+gegl_disk_cache_hash_property (GChecksum  *checksum,
+                               GeglNode   *node,
+                               GParamSpec *pspec)
+{
+  GValue   value = G_VALUE_INIT;
+  GType    type  = G_PARAM_SPEC_VALUE_TYPE (pspec);
+  gchar   *str   = NULL;
+  gboolean ok    = TRUE;
+
+  g_value_init (&value, type);
+  g_object_get_property (G_OBJECT (node->operation), pspec->name, &value);
+
+  if (type == G_TYPE_FLOAT || type == G_TYPE_DOUBLE)
+    {
+      gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+      g_ascii_dtostr (buf, sizeof (buf), type == G_TYPE_FLOAT ?
+                                         g_value_get_float (&value) :
+                                         g_value_get_double (&value));
+      str = g_strdup (buf);
+    }
+  else if (G_IS_PARAM_SPEC_STRING (pspec) &&
+           (GEGL_IS_PARAM_SPEC_FILE_PATH (pspec) ||
+            GEGL_IS_PARAM_SPEC_URI (pspec)))
+    {
+      /* the content of source files is identified by their size and
+       * modification time
+       */
+      const gchar *name     = g_value_get_string (&value);
+      gchar       *filename = NULL;
+      GStatBuf     st;
+
+      if (name && GEGL_IS_PARAM_SPEC_URI (pspec))
+        filename = g_filename_from_uri (name, NULL, NULL);
+      else if (name)
+        filename = g_strdup (name);
+
+      if (filename && g_stat (filename, &st) == 0)
+        str = g_strdup_printf ("'%s' %" G_GINT64_FORMAT " %" G_GINT64_FORMAT,
+                               name, (gint64) st.st_size, (gint64) st.st_mtime);
+      else if (name && name[0] && !filename)
+        ok = FALSE; /* a remote uri, we can not tell if it changed */
+      else
+        str = g_strdup_printf ("'%s'", name ? name : "");
+
+      g_free (filename);
+    }
+  else if (G_TYPE_IS_FUNDAMENTAL (type) && type != G_TYPE_POINTER &&
+           type != G_TYPE_OBJECT && type != G_TYPE_BOXED)
+    {
+      /* integers, booleans, enums, flags and strings */
+      str = g_strdup_value_contents (&value);
+    }
+  else if (g_type_is_a (type, G_TYPE_ENUM) || g_type_is_a (type, G_TYPE_FLAGS))
+    {
+      str = g_strdup_value_contents (&value);
+    }
+  else if (type == G_TYPE_POINTER && GEGL_IS_PARAM_SPEC_FORMAT (pspec))
+    {
+      const Babl *format = g_value_get_pointer (&value);
+
+      str = g_strdup (format ? babl_get_name (format) : "");
+    }
+  else if (G_TYPE_IS_OBJECT (type) && !g_value_get_object (&value))
+    {
+      str = g_strdup ("NULL");
+    }
+  else if (type == GEGL_TYPE_COLOR)
+    {
+      GString *components = g_string_new (NULL);
+      gdouble  rgba[4];
+      gint     i;
+
+      gegl_color_get_pixel (g_value_get_object (&value),
+                            babl_format ("RGBA double"), rgba);
+      for (i = 0; i < 4; i++)
+        append_double (components, rgba[i]);
+
+      str = g_string_free (components, FALSE);
+    }
+  else if (type == GEGL_TYPE_PATH)
+    {
+      str = gegl_path_to_string (g_value_get_object (&value));
+    }
+  else if (type == GEGL_TYPE_CURVE)
+    {
+      GeglCurve *curve  = g_value_get_object (&value);
+      GString   *points = g_string_new (NULL);
+      gdouble    min_y, max_y;
+      guint      i;
+
+      gegl_curve_get_y_bounds (curve, &min_y, &max_y);
+      append_double (points, min_y);
+      append_double (points, max_y);
+
+      for (i = 0; i < gegl_curve_num_points (curve); i++)
+        {
+          gdouble x, y;
+
+          gegl_curve_get_point (curve, i, &x, &y);
+          append_double (points, x);
+          append_double (points, y);
+        }
+
+      str = g_string_free (points, FALSE);
+    }
+  else
+    {
+      /* buffers, audio fragments and other objects we can not identify */
+      ok = FALSE;
+    }
+
+  if (ok)
+    {
+      g_checksum_update (checksum, (const guchar *) pspec->name, -1);
+      g_checksum_update (checksum, (const guchar *) "=", 1);
+      g_checksum_update (checksum, (const guchar *) str, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+    }
+  else
+    {
+      GEGL_NOTE (GEGL_DEBUG_CACHE, "%s.%s prevents disk caching",
+                 gegl_node_get_debug_name (node), pspec->name);
+    }
+
+  g_free (str);
+  g_value_unset (&value);
+
+  return ok;
+}
+
+/* the digest of @node, memoized in @digests since graphs can share nodes */
+static const gchar *
+gegl_disk_cache_hash_node (GeglNode   *node,
+                           GHashTable *digests)
+{
+  const gchar  *operation = gegl_node_get_operation (node);
+  GChecksum    *checksum;
+  GParamSpec  **properties;
+  guint         n_properties;
+  GSList       *iter;
+  gchar        *digest = NULL;
+  guint         i;
+
+  if (g_hash_table_contains (digests, node))
+    return g_hash_table_lookup (digests, node);
+
+  /* keep cycles and failed nodes from being visited again */
+  g_hash_table_insert (digests, node, NULL);
+
+  if (!node->operation || !operation)
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  g_checksum_update (checksum, (const guchar *) operation, -1);
+  g_checksum_update (checksum, (const guchar *) " ", 1);
+  g_checksum_update (checksum,
+                     (const guchar *) gegl_operation_get_op_version (operation), -1);
+  if (gegl_node_get_passthrough (node))
+    g_checksum_update (checksum, (const guchar *) " passthrough", -1);
+  g_checksum_update (checksum, (const guchar *) "\n", 1);
+
+  properties = gegl_operation_list_properties (operation, &n_properties);
+
+  for (i = 0; i < n_properties; i++)
+    {
+      /* pads are covered by the connections below */
+      if (properties[i]->flags & (GEGL_PARAM_PAD_INPUT | GEGL_PARAM_PAD_OUTPUT))
+        continue;
+
+      if (!gegl_disk_cache_hash_property (checksum, node, properties[i]))
+        break;
+    }
+
+  g_free (properties);
+
+  if (i < n_properties)
+    goto out;
+
+  for (iter = gegl_node_get_input_pads (node); iter; iter = iter->next)
+    {
+      GeglPad     *pad    = iter->data;
+      GeglPad     *source = gegl_pad_get_connected_to (pad);
+      const gchar *source_digest = "none";
+
+      if (source)
+        {
+          source_digest = gegl_disk_cache_hash_node (gegl_pad_get_node (source),
+                                                     digests);
+          if (!source_digest)
+            goto out;
+        }
+
+      g_checksum_update (checksum, (const guchar *) gegl_pad_get_name (pad), -1);
+      g_checksum_update (checksum, (const guchar *) "<", 1);
+      if (source)
+        {
+          g_checksum_update (checksum,
+                             (const guchar *) gegl_pad_get_name (source), -1);
+          g_checksum_update (checksum, (const guchar *) "@", 1);
+        }
+      g_checksum_update (checksum, (const guchar *) source_digest, -1);
+      g_checksum_update (checksum, (const guchar *) "\n", 1);
+    }
+
+  digest = g_strdup (g_checksum_get_string (checksum));
+  g_hash_table_insert (digests, node, digest);
+
+out:
+  g_checksum_free (checksum);
+
+  return digest;
+}
+
+gchar *
+gegl_disk_cache_get_key (GeglNode   *node,
+                         const Babl *format)
+{
+  GHashTable  *digests;
+  const gchar *digest;
+  gchar       *key = NULL;
+
+  g_return_val_if_fail (GEGL_IS_NODE (node), NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+
+  digests = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  digest = gegl_disk_cache_hash_node (node, digests);
+
+  if (digest)
+    {
+      gchar *data = g_strdup_printf ("%s %s %i.%i.%i", digest,
+                                     babl_get_name (format),
+                                     GEGL_MAJOR_VERSION,
+                                     GEGL_MINOR_VERSION,
+                                     GEGL_MICRO_VERSION);
+
+      key = g_compute_checksum_for_string (G_CHECKSUM_SHA256, data, -1);
+      g_free (data);
+    }
+
+  g_hash_table_unref (digests);
+
+  return key;
+}
+
+static gboolean
+gegl_disk_cache_lock_is_stale (const gchar *lock_path)
+{
+#ifdef G_OS_UNIX
+  gchar    *contents = NULL;
+  gboolean  stale    = FALSE;
+
+  if (g_file_get_contents (lock_path, &contents, NULL, NULL))
+    {
+      gint pid = atoi (contents);
+
+      stale = pid <= 0 || (kill (pid, 0) != 0 && errno == ESRCH);
+      g_free (contents);
+    }
+
+  return stale;
+#else
+  return FALSE;
+#endif
+}
+
+static gboolean
+gegl_disk_cache_lock (const gchar *lock_path)
+{
+  gchar *pid;
+  gint   fd;
+
+  fd = g_open (lock_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+
+  if (fd == -1 && errno == EEXIST &&
+      gegl_disk_cache_lock_is_stale (lock_path))
+    {
+      g_unlink (lock_path);
+      fd = g_open (lock_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    }
+
+  if (fd == -1)
+    return FALSE;
+
+  pid = g_strdup_printf ("%i\n", (gint) getpid ());
+  if (write (fd, pid, strlen (pid)) < 0)
+    g_warning ("failed to write %s: %s", lock_path, g_strerror (errno));
+  g_free (pid);
+  close (fd);
+
+  return TRUE;
+}
+
+static void
+gegl_disk_cache_unlock (gpointer lock_path)
+{
+  g_unlink (lock_path);
+  g_free (lock_path);
+}
+
+GeglCache *
+gegl_disk_cache_open (GeglNode   *node,
+                      const Babl *format)
+{
+  GeglConfig  *config = gegl_config ();
+  GeglCache   *cache;
+  gchar       *key;
+  gchar       *base;
+  gchar       *path;
+  gchar       *valid_path;
+  gchar       *lock_path;
+  gboolean     reused;
+
+  if (!config->disk_cache || !config->disk_cache[0])
+    return NULL;
+
+  key = gegl_disk_cache_get_key (node, format);
+  if (!key)
+    return NULL;
+
+  if (g_mkdir_with_parents (config->disk_cache, S_IRUSR | S_IWUSR | S_IXUSR) != 0)
+    {
+      g_warning ("failed to create disk cache directory %s", config->disk_cache);
+      g_free (key);
+      return NULL;
+    }
+
+  base       = g_build_filename (config->disk_cache, key, NULL);
+  path       = g_strconcat (base, ".gegl", NULL);
+  valid_path = g_strconcat (base, ".valid", NULL);
+  lock_path  = g_strconcat (base, ".lock", NULL);
+  g_free (base);
+
+  /* another node or process is using the entry, it is not safe to share */
+  if (!gegl_disk_cache_lock (lock_path))
+    {
+      GEGL_NOTE (GEGL_DEBUG_CACHE, "disk cache %s of %s is in use",
+                 key, gegl_node_get_debug_name (node));
+      g_free (key);
+      g_free (path);
+      g_free (valid_path);
+      g_free (lock_path);
+      return NULL;
+    }
+
+  reused = g_file_test (path, G_FILE_TEST_EXISTS) &&
+           g_file_test (valid_path, G_FILE_TEST_EXISTS);
+
+  if (!reused)
+    {
+      /* leftovers of an entry that was never completely saved */
+      g_unlink (path);
+      g_unlink (valid_path);
+
+      gegl_disk_cache_trim (config->disk_cache_size);
+    }
+
+  cache = g_object_new (GEGL_TYPE_CACHE,
+                        "format", format,
+                        "path",   path,
+                        NULL);
+
+  if (!gegl_cache_attach_file (cache, valid_path))
+    g_warning ("ignoring corrupt disk cache entry %s", valid_path);
+
+  /* mark the entry as recently used */
+  g_utime (valid_path, NULL);
+
+  g_object_set_data_full (G_OBJECT (cache), GEGL_DISK_CACHE_LOCK_KEY,
+                          lock_path, gegl_disk_cache_unlock);
+
+  GEGL_NOTE (GEGL_DEBUG_CACHE, "%s disk cache %s for %s",
+             reused ? "Reusing" : "Creating",
+             key, gegl_node_get_debug_name (node));
+
+  g_free (key);
+  g_free (path);
+  g_free (valid_path);
+
+  return cache;
+}
+
+void
+gegl_disk_cache_close (GeglCache *cache)
+{
+  g_return_if_fail (GEGL_IS_CACHE (cache));
+
+  gegl_cache_detach_file (cache);
+  g_object_set_data (G_OBJECT (cache), GEGL_DISK_CACHE_LOCK_KEY, NULL);
+}
+
+typedef struct
+{
+  gchar   *base;
+  guint64  size;
+  gint64   used;
+} Entry;
+
+static gint
+entry_compare (gconstpointer a,
+               gconstpointer b)
+{
+  const Entry *ea = a;
+  const Entry *eb = b;
+
+  if (ea->used < eb->used)
+    return -1;
+  if (ea->used > eb->used)
+    return 1;
+  return 0;
+}
+
+void
+gegl_disk_cache_trim (guint64 max_size)
+{
+  const gchar *dirname = gegl_config ()->disk_cache;
+  GArray      *entries;
+  GDir        *dir;
+  const gchar *name;
+  guint64      total = 0;
+  guint        i;
+
+  if (!dirname || !(dir = g_dir_open (dirname, 0, NULL)))
+    return;
+
+  entries = g_array_new (FALSE, FALSE, sizeof (Entry));
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      Entry     entry;
+      GStatBuf  st;
+      gchar    *path;
+
+      if (!g_str_has_suffix (name, ".gegl"))
+        continue;
+
+      entry.base = g_build_filename (dirname, name, NULL);
+      entry.base[strlen (entry.base) - strlen (".gegl")] = '\0';
+      entry.size = 0;
+      entry.used = 0;
+
+      path = g_strconcat (entry.base, ".gegl", NULL);
+      if (g_stat (path, &st) == 0)
+        {
+          entry.size += st.st_size;
+          entry.used  = st.st_mtime;
+        }
+      g_free (path);
+
+      path = g_strconcat (entry.base, ".valid", NULL);
+      if (g_stat (path, &st) == 0)
+        {
+          entry.size += st.st_size;
+          entry.used  = MAX (entry.used, (gint64) st.st_mtime);
+        }
+      g_free (path);
+
+      total += entry.size;
+      g_array_append_val (entries, entry);
+    }
+
+  g_dir_close (dir);
+
+  g_array_sort (entries, entry_compare);
+
+  for (i = 0; i < entries->len; i++)
+    {
+      Entry *entry = &g_array_index (entries, Entry, i);
+      gchar *path;
+
+      if (total > max_size)
+        {
+          path = g_strconcat (entry->base, ".lock", NULL);
+
+          /* taking the lock keeps other processes from opening the
+           * entry while it is removed, entries in use keep theirs
+           */
+          if (gegl_disk_cache_lock (path))
+            {
+              gchar *gegl_path  = g_strconcat (entry->base, ".gegl", NULL);
+              gchar *valid_path = g_strconcat (entry->base, ".valid", NULL);
+
+              GEGL_NOTE (GEGL_DEBUG_CACHE, "Removing disk cache entry %s "
+                         "(%" G_GUINT64_FORMAT " bytes)",
+                         entry->base, entry->size);
+
+              /* the entry is invalid as soon as its valid rectangles are gone */
+              g_unlink (valid_path);
+              g_unlink (gegl_path);
+              g_unlink (path);
+              total -= entry->size;
+
+              g_free (gegl_path);
+              g_free (valid_path);
+            }
+
+          g_free (path);
+        }
+
+      g_free (entry->base);
+    }
+
+  g_array_free (entries, TRUE);
+}
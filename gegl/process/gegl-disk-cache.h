@@ -0,0 +1,48 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GEGL_DISK_CACHE_H__
+#define __GEGL_DISK_CACHE_H__
+
+#include "buffer/gegl-cache.h"
+
+G_BEGIN_DECLS
+
+/* a hex digest identifying the output of @node in @format, computed from
+ * the operations, properties and source files of the graph feeding it, or
+ * NULL if some part of that graph can not be identified this way.
+ */
+gchar     * gegl_disk_cache_get_key (GeglNode   *node,
+                                     const Babl *format);
+
+/* a cache for @node stored in the disk cache directory, filled with what
+ * earlier processes computed for the same graph, or NULL if the disk cache
+ * is disabled or can not be used for @node.
+ */
+GeglCache * gegl_disk_cache_open    (GeglNode   *node,
+                                     const Babl *format);
+
+/* save what @cache holds and stop updating its disk cache entry. */
+void        gegl_disk_cache_close   (GeglCache  *cache);
+
+/* remove the least recently used entries from the disk cache until it
+ * takes at most @max_size bytes.
+ */
+void        gegl_disk_cache_trim    (guint64     max_size);
+
+G_END_DECLS
+
+#endif /* __GEGL_DISK_CACHE_H__ */
@@ -26,6 +26,7 @@
 #include "gegl-types-internal.h"
 #include "gegl-eval-manager.h"
 #include "gegl-instrument.h"
+#include "gegl-latency.h"
 
 #include "graph/gegl-node-private.h"
 
@@ -99,6 +100,7 @@ gegl_eval_manager_prepare (GeglEvalManager *self)
       else
         gegl_graph_rebuild (self->traversal, self->node);
 
+      gegl_graph_set_streaming (self->traversal, self->streaming);
       gegl_graph_prepare (self->traversal);
 
       self->state = READY;
@@ -112,12 +114,29 @@ gegl_eval_manager_get_bounding_box (GeglEvalManager     *self)
   return gegl_graph_get_bounding_box (self->traversal);
 }
 
+/* results of a streaming eval manager bypass the node caches, for
+ * renderings that are only requested once.
+ */
+void
+gegl_eval_manager_set_streaming (GeglEvalManager *self,
+                                 gboolean         streaming)
+{
+  g_return_if_fail (GEGL_IS_EVAL_MANAGER (self));
+
+  self->streaming = streaming;
+
+  if (self->traversal)
+    gegl_graph_set_streaming (self->traversal, streaming);
+}
+
 GeglBuffer *
 gegl_eval_manager_apply (GeglEvalManager     *self,
                          const GeglRectangle *roi,
                          gint                 level)
 {
   GeglBuffer  *object;
+  gint64       start;
+  gint64       prepared;
 
   g_return_val_if_fail (GEGL_IS_EVAL_MANAGER (self), NULL);
   g_return_val_if_fail (GEGL_IS_NODE (self->node), NULL);
@@ -125,6 +144,8 @@ gegl_eval_manager_apply (GeglEvalManager     *self,
   if (level >= GEGL_CACHE_VALID_MIPMAPS)
     level = GEGL_CACHE_VALID_MIPMAPS-1;
 
+  start = g_get_monotonic_time ();
+
   GEGL_INSTRUMENT_START();
   gegl_eval_manager_prepare (self);
   GEGL_INSTRUMENT_END ("gegl", "prepare-graph");
@@ -133,9 +154,15 @@ gegl_eval_manager_apply (GeglEvalManager     *self,
   gegl_graph_prepare_request (self->traversal, roi, level);
   GEGL_INSTRUMENT_END ("gegl", "prepare-request");
 
+  prepared = g_get_monotonic_time ();
+  gegl_latency_add (GEGL_LATENCY_PREPARE, prepared - start);
+
   GEGL_INSTRUMENT_START();
   object = gegl_graph_process (self->traversal, level);
-  GEGL_INSTRUMENT_END ("gegl", "process");
+  GEGL_INSTRUMENT_END_PIXELS ("gegl", "process",
+                              (gint64) roi->width * roi->height);
+
+  gegl_latency_add (GEGL_LATENCY_COMPUTE, g_get_monotonic_time () - prepared);
 
   return object;
 }
@@ -52,6 +52,7 @@ struct _GeglEvalManager
 
   GeglGraphTraversal    *traversal;
   GeglEvalManagerStates  state;
+  gboolean               streaming;
 
 };
 
@@ -65,6 +66,8 @@ GType             gegl_eval_manager_get_type (void) G_GNUC_CONST;
 
 void              gegl_eval_manager_prepare  (GeglEvalManager     *self);
 GeglRectangle     gegl_eval_manager_get_bounding_box (GeglEvalManager     *self);
+void              gegl_eval_manager_set_streaming    (GeglEvalManager     *self,
+                                                      gboolean             streaming);
 
 GeglBuffer *      gegl_eval_manager_apply    (GeglEvalManager     *self,
                                               const GeglRectangle *roi,
@@ -82,7 +82,15 @@ gegl_graph_dump_request (GeglNode            *node,
   {
     GeglNode *cur_node = GEGL_NODE (list_iter->data);
     GeglOperationContext *context = g_hash_table_lookup (path->contexts, cur_node);
-    
+
+    if (!context)
+      {
+        printf ("%s: merged with %s\n", gegl_node_get_debug_name (cur_node),
+                gegl_node_get_debug_name (g_hash_table_lookup (path->duplicates,
+                                                               cur_node)));
+        continue;
+      }
+
     if (!context->cached)
       printf ("%s: result: ", gegl_node_get_debug_name (cur_node));
     else
@@ -26,6 +26,10 @@ struct _GeglGraphTraversal
   GList *bfs_path;
   gboolean rects_dirty;
   GeglBuffer *shared_empty;
+  gint conversions_removed;
+  GHashTable *duplicates; /* node -> the identical node computed instead */
+  GHashTable *merged;     /* node -> GSList of the nodes it stands in for */
+  gboolean streaming;     /* results are not written to the node caches */
 };
 
 #endif /* __GEGL_GRAPH_TRAVERSAL_PRIVATE_H__ */
@@ -19,12 +19,15 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib-object.h>
 
 #include "gegl-types-internal.h"
 #include "gegl.h"
 #include "gegl-debug.h"
 #include "gegl-instrument.h"
+#include "gegl-trace.h"
 
 #include "buffer/gegl-region.h"
 
@@ -33,11 +36,13 @@
 #include "graph/gegl-visitable.h"
 #include "graph/gegl-connection.h"
 
+#include "process/gegl-cache-policy.h"
 #include "process/gegl-graph-traversal.h"
 #include "process/gegl-graph-traversal-private.h"
 #include "process/gegl-list-visitor.h"
 
 #include "operation/gegl-operation.h"
+#include "operation/gegl-operation-sink.h"
 #include "operation/gegl-operation-context.h"
 #include "operation/gegl-operation-context-private.h"
 
@@ -53,6 +58,7 @@ static GList *gegl_graph_get_connected_output_contexts (GeglGraphTraversal *path
 static void   _gegl_graph_do_build                     (GeglGraphTraversal *path,
                                                         GeglNode           *node);
 static GeglBuffer *gegl_graph_get_shared_empty         (GeglGraphTraversal *path);
+static void   gegl_graph_merge_duplicates              (GeglGraphTraversal *path);
 
 static void
 _gegl_graph_do_build (GeglGraphTraversal *path, GeglNode *node)
@@ -81,6 +87,191 @@ _gegl_graph_do_build (GeglGraphTraversal *path, GeglNode *node)
                                           (GDestroyNotify)gegl_operation_context_destroy);
   path->rects_dirty = FALSE;
   g_object_unref (list_visitor);
+
+  gegl_graph_merge_duplicates (path);
+}
+
+/* Two nodes compute the same output when they run the same operation
+ * with the same property values on the same inputs, objects are compared
+ * by identity except for colors.
+ */
+static gboolean
+gegl_graph_same_properties (GeglNode *a,
+                            GeglNode *b)
+{
+  GParamSpec **properties;
+  guint        n_properties;
+  gboolean     same = TRUE;
+  guint        i;
+
+  properties = gegl_operation_list_properties (gegl_node_get_operation (a),
+                                               &n_properties);
+
+  for (i = 0; same && i < n_properties; i++)
+    {
+      GParamSpec *pspec = properties[i];
+      GValue      value_a = G_VALUE_INIT;
+      GValue      value_b = G_VALUE_INIT;
+
+      if (pspec->flags & (GEGL_PARAM_PAD_INPUT | GEGL_PARAM_PAD_OUTPUT))
+        continue;
+
+      g_value_init (&value_a, pspec->value_type);
+      g_value_init (&value_b, pspec->value_type);
+      g_object_get_property (G_OBJECT (a->operation), pspec->name, &value_a);
+      g_object_get_property (G_OBJECT (b->operation), pspec->name, &value_b);
+
+      if (pspec->value_type == GEGL_TYPE_COLOR &&
+          g_value_get_object (&value_a) && g_value_get_object (&value_b))
+        {
+          gdouble color_a[4];
+          gdouble color_b[4];
+
+          gegl_color_get_pixel (g_value_get_object (&value_a),
+                                babl_format ("RGBA double"), color_a);
+          gegl_color_get_pixel (g_value_get_object (&value_b),
+                                babl_format ("RGBA double"), color_b);
+          same = memcmp (color_a, color_b, sizeof (color_a)) == 0;
+        }
+      else
+        {
+          same = g_param_values_cmp (pspec, &value_a, &value_b) == 0;
+        }
+
+      g_value_unset (&value_a);
+      g_value_unset (&value_b);
+    }
+
+  g_free (properties);
+
+  return same;
+}
+
+static GeglNode *
+gegl_graph_get_canonical (GeglGraphTraversal *path,
+                          GeglNode           *node)
+{
+  GeglNode *canonical = g_hash_table_lookup (path->duplicates, node);
+
+  return canonical ? canonical : node;
+}
+
+/* Common subexpression elimination: nodes computing the same thing as a
+ * node earlier in the dfs path are not processed, their consumers get the
+ * output of that node instead. The graph itself is left untouched, nodes
+ * are only merged within this traversal.
+ */
+static void
+gegl_graph_merge_duplicates (GeglGraphTraversal *path)
+{
+  GHashTable *signatures;
+  GList      *iter;
+  GeglNode   *root;
+
+  path->duplicates = g_hash_table_new (NULL, NULL);
+  path->merged     = g_hash_table_new_full (NULL, NULL, NULL,
+                                            (GDestroyNotify) g_slist_free);
+
+  if (!path->dfs_path)
+    return;
+
+  signatures = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                      g_free, (GDestroyNotify) g_slist_free);
+  root = GEGL_NODE (g_list_last (path->dfs_path)->data);
+
+  /* sources come first in the dfs path, so the inputs of a node are
+   * already mapped to their canonical nodes when it is visited
+   */
+  for (iter = path->dfs_path; iter; iter = iter->next)
+    {
+      GeglNode *node = GEGL_NODE (iter->data);
+      GString  *signature;
+      GSList   *candidates;
+      GSList   *candidate;
+      GSList   *pads;
+
+      /* the requested node is where the result is read from, and sinks
+       * are run for their side effects
+       */
+      if (node == root || !node->operation ||
+          GEGL_IS_OPERATION_SINK (node->operation) ||
+          !gegl_node_has_pad (node, "output"))
+        continue;
+
+      signature = g_string_new (gegl_node_get_operation (node));
+      if (gegl_node_get_passthrough (node))
+        g_string_append (signature, " passthrough");
+
+      for (pads = gegl_node_get_input_pads (node); pads; pads = pads->next)
+        {
+          GeglPad *source = gegl_pad_get_connected_to (pads->data);
+
+          g_string_append_printf (signature, " %s=",
+                                  gegl_pad_get_name (pads->data));
+          if (source)
+            g_string_append_printf (signature, "%p.%s",
+                                    gegl_graph_get_canonical (path,
+                                      gegl_pad_get_node (source)),
+                                    gegl_pad_get_name (source));
+        }
+
+      candidates = g_hash_table_lookup (signatures, signature->str);
+
+      for (candidate = candidates; candidate; candidate = candidate->next)
+        if (gegl_graph_same_properties (candidate->data, node))
+          break;
+
+      if (candidate)
+        {
+          GeglNode *canonical = candidate->data;
+          GSList   *merged    = g_hash_table_lookup (path->merged, canonical);
+
+          g_hash_table_insert (path->duplicates, node, canonical);
+          g_hash_table_steal (path->merged, canonical);
+          g_hash_table_insert (path->merged, canonical,
+                               g_slist_prepend (merged, node));
+
+          GEGL_NOTE (GEGL_DEBUG_PROCESS, "Merging %s into identical %s",
+                     gegl_node_get_debug_name (node),
+                     gegl_node_get_debug_name (canonical));
+
+          g_string_free (signature, TRUE);
+        }
+      else if (candidates)
+        {
+          /* appending keeps the head, and with it the table entry, valid */
+          candidates = g_slist_append (candidates, node);
+          g_string_free (signature, TRUE);
+        }
+      else
+        {
+          g_hash_table_insert (signatures, g_string_free (signature, FALSE),
+                               g_slist_prepend (NULL, node));
+        }
+    }
+
+  g_hash_table_unref (signatures);
+
+  /* the bfs path orders consumers before their sources in the graph as
+   * it is. A canonical node can be closer to the root than a consumer of
+   * a node merged into it and be visited before that consumer adds to
+   * its need rect. The canonical node comes first of its group in the
+   * dfs path, and with that before all their consumers, so the reversed
+   * dfs path visits every consumer before what it is fed by.
+   */
+  if (g_hash_table_size (path->duplicates))
+    {
+      g_list_free (path->bfs_path);
+      path->bfs_path = g_list_reverse (g_list_copy (path->dfs_path));
+    }
+}
+
+/* the nodes whose consumers are fed by @node in this traversal */
+static GSList *
+gegl_graph_get_merged (GeglGraphTraversal *path,
+                       GeglNode           *node)
+{
+  return g_hash_table_lookup (path->merged, node);
 }
 
 /**
@@ -115,6 +306,8 @@ gegl_graph_rebuild (GeglGraphTraversal *path, GeglNode *node)
   g_list_free (path->dfs_path);
   g_list_free (path->bfs_path);
   g_hash_table_unref (path->contexts);
+  g_hash_table_unref (path->duplicates);
+  g_hash_table_unref (path->merged);
 
   /* Replaces everything but shared_empty */
   _gegl_graph_do_build (path, node);
@@ -126,12 +319,30 @@ gegl_graph_free (GeglGraphTraversal *path)
   g_list_free (path->dfs_path);
   g_list_free (path->bfs_path);
   g_hash_table_unref (path->contexts);
+  g_hash_table_unref (path->duplicates);
+  g_hash_table_unref (path->merged);
   if (path->shared_empty)
     g_object_unref (path->shared_empty);
 
   g_free (path);
 }
 
+/**
+ * gegl_graph_set_streaming:
+ * @path: The traversal path
+ * @streaming: whether to bypass the node caches
+ *
+ * When streaming, the nodes of @path compute into buffers that only live
+ * as long as their consumers need them instead of into their caches, for
+ * requests that will not be repeated. Caches that already hold valid
+ * results are still used.
+ */
+void
+gegl_graph_set_streaming (GeglGraphTraversal *path,
+                          gboolean            streaming)
+{
+  path->streaming = streaming;
+}
 
 /**
  * gegl_graph_get_bounding_box:
@@ -153,6 +364,101 @@ gegl_graph_get_bounding_box (GeglGraphTraversal *path)
   return *GEGL_RECTANGLE(0, 0, 0, 0);
 }
 
+/* Number of input pads in the graph whose format differs from the format
+ * of the output pad feeding them, each of these is a babl conversion of
+ * every pixel passing through. Formats found in @formats take precedence
+ * over the ones currently set on the pads.
+ */
+static gint
+gegl_graph_count_conversions (GeglGraphTraversal *path,
+                              GHashTable         *formats)
+{
+  GList *list_iter;
+  gint   count = 0;
+
+  for (list_iter = path->dfs_path; list_iter; list_iter = list_iter->next)
+    {
+      GeglNode *node = GEGL_NODE (list_iter->data);
+      GSList   *pads;
+
+      for (pads = gegl_node_get_input_pads (node); pads; pads = pads->next)
+        {
+          GeglPad    *pad    = pads->data;
+          GeglPad    *source = gegl_pad_get_connected_to (pad);
+          const Babl *in_format;
+          const Babl *out_format;
+
+          if (!source)
+            continue;
+
+          in_format = formats ? g_hash_table_lookup (formats, pad) : NULL;
+          if (!in_format)
+            in_format = gegl_pad_get_format (pad);
+          out_format = formats ? g_hash_table_lookup (formats, source) : NULL;
+          if (!out_format)
+            out_format = gegl_pad_get_format (source);
+
+          if (in_format && out_format && in_format != out_format)
+            count++;
+        }
+    }
+
+  return count;
+}
+
+/* Let operations that can work in more than one format follow the format
+ * of their sources, remembering the format chosen by prepare in @formats.
+ * Nodes are visited with their sources first, so the choice propagates
+ * down chains of such operations.
+ */
+static void
+gegl_graph_negotiate_format (GeglNode   *node,
+                             GHashTable *formats)
+{
+  GeglOperation       *operation = node->operation;
+  GeglOperationClass  *klass     = GEGL_OPERATION_GET_CLASS (operation);
+  const Babl         **supported;
+  GeglPad             *input_pad;
+  GeglPad             *output_pad;
+  GeglPad             *source;
+  const Babl          *source_format;
+  gint                 i;
+
+  if (!klass->get_supported_formats)
+    return;
+
+  input_pad  = gegl_node_get_pad (node, "input");
+  output_pad = gegl_node_get_pad (node, "output");
+  if (!input_pad || !output_pad)
+    return;
+
+  source = gegl_pad_get_connected_to (input_pad);
+  if (!source)
+    return;
+
+  source_format = gegl_pad_get_format (source);
+  if (!source_format || source_format == gegl_pad_get_format (input_pad))
+    return;
+
+  supported = klass->get_supported_formats (operation);
+
+  for (i = 0; supported && supported[i]; i++)
+    if (supported[i] == source_format)
+      {
+        if (!g_hash_table_contains (formats, input_pad))
+          {
+            g_hash_table_insert (formats, input_pad,
+                                 (gpointer) gegl_pad_get_format (input_pad));
+            g_hash_table_insert (formats, output_pad,
+                                 (gpointer) gegl_pad_get_format (output_pad));
+          }
+
+        gegl_operation_set_format (operation, "input", source_format);
+        gegl_operation_set_format (operation, "output", source_format);
+        break;
+      }
+}
+
 /**
  * gegl_graph_prepare:
  * @path: The traversal path
@@ -162,7 +468,8 @@ gegl_graph_get_bounding_box (GeglGraphTraversal *path)
 void
 gegl_graph_prepare (GeglGraphTraversal *path)
 {
-  GList *list_iter = NULL;
+  GList      *list_iter = NULL;
+  GHashTable *formats   = g_hash_table_new (NULL, NULL);
 
   for (list_iter = path->dfs_path; list_iter; list_iter = list_iter->next)
   {
@@ -173,6 +480,8 @@ gegl_graph_prepare (GeglGraphTraversal *path)
     g_mutex_lock (&node->mutex);
 
     gegl_operation_prepare (operation);
+    gegl_node_forget_rects (node);
+    gegl_graph_negotiate_format (node, formats);
     node->have_rect = gegl_operation_get_bounding_box (operation);
     node->valid_have_rect = TRUE;
 
@@ -191,7 +500,8 @@ gegl_graph_prepare (GeglGraphTraversal *path)
         parent = gegl_node_get_parent (parent);
       }
 
-    if (!g_hash_table_contains (path->contexts, node))
+    if (!g_hash_table_contains (path->contexts, node) &&
+        !g_hash_table_contains (path->duplicates, node))
       {
         GeglOperationContext *context = gegl_operation_context_new (node->operation);
 
@@ -200,6 +510,32 @@ gegl_graph_prepare (GeglGraphTraversal *path)
                              context);
       }
   }
+
+  path->conversions_removed = 0;
+  if (g_hash_table_size (formats))
+    {
+      path->conversions_removed = gegl_graph_count_conversions (path, formats) -
+                                  gegl_graph_count_conversions (path, NULL);
+
+      GEGL_NOTE (GEGL_DEBUG_PROCESS,
+                 "Format negotiation removed %i conversions",
+                 path->conversions_removed);
+    }
+  g_hash_table_unref (formats);
+}
+
+/**
+ * gegl_graph_get_conversions_removed:
+ * @path: The traversal path
+ *
+ * Return value: The number of babl conversions between nodes that the
+ * format negotiation of the last gegl_graph_prepare avoided, negative if
+ * it introduced conversions further down the graph.
+ */
+gint
+gegl_graph_get_conversions_removed (GeglGraphTraversal *path)
+{
+  return path->conversions_removed;
 }
 
 /**
@@ -230,6 +566,9 @@ gegl_graph_prepare_request (GeglGraphTraversal  *path,
           GeglNode *node = GEGL_NODE (list_iter->data);
           GeglOperationContext *context = g_hash_table_lookup (path->contexts, node);
 
+          if (!context)
+            continue;
+
           /* We only need to reset the need rect, result will always get overwritten */
           gegl_operation_context_set_need_rect (context, &empty_rect);
 
@@ -262,7 +601,11 @@ gegl_graph_prepare_request (GeglGraphTraversal  *path,
       GeglOperationContext *context;
       GeglRectangle        *request;
       GSList               *input_pads;
-      
+
+      /* merged nodes are requested through the node they were merged into */
+      if (g_hash_table_contains (path->duplicates, node))
+        continue;
+
       context = g_hash_table_lookup (path->contexts, node);
       g_return_if_fail (context);
       
@@ -279,7 +622,7 @@ gegl_graph_prepare_request (GeglGraphTraversal  *path,
           gint i;
           for (i = level; i >=0 && !context->cached; i--)
           {
-            if (gegl_region_rect_in (node->cache->valid_region[level], request) == GEGL_OVERLAP_RECTANGLE_IN)
+            if (gegl_cache_is_valid (node->cache, request, level))
             {
               /* This node is cached and the cache fulfills our need rect */
               context->cached = TRUE;
@@ -305,7 +648,8 @@ gegl_graph_prepare_request (GeglGraphTraversal  *path,
 
             if (source_pad)
               {
-                GeglNode             *source_node    = gegl_pad_get_node (source_pad);
+                GeglNode             *source_node    = gegl_graph_get_canonical (path,
+                                                         gegl_pad_get_node (source_pad));
                 GeglOperationContext *source_context = g_hash_table_lookup (path->contexts, source_node);
                 const gchar          *pad_name       = gegl_pad_get_name (input_pads->data);
 
@@ -372,6 +716,44 @@ gegl_graph_get_shared_empty (GeglGraphTraversal *path)
   return path->shared_empty;
 }
 
+static void
+gegl_graph_profile_record (GeglNode             *node,
+                           GeglOperationContext *context,
+                           GeglBuffer           *result,
+                           gint64                usecs)
+{
+  GeglNodeProfile *profile = &node->profile;
+  gint64           pixels  = (gint64) context->need_rect.width *
+                                      context->need_rect.height;
+
+  if (pixels <= 0)
+    return;
+
+  g_mutex_lock (&node->mutex);
+
+  profile->requests++;
+
+  if (context->cached)
+    {
+      profile->cache_hits++;
+    }
+  else
+    {
+      profile->usecs  += usecs;
+      profile->pixels += pixels;
+    }
+
+  if (result)
+    {
+      gsize bytes = pixels * babl_format_get_bytes_per_pixel (
+                               gegl_buffer_get_format (result));
+
+      profile->peak_bytes = MAX (profile->peak_bytes, bytes);
+    }
+
+  g_mutex_unlock (&node->mutex);
+}
+
 
 /**
  * gegl_graph_process:
@@ -401,11 +783,17 @@ gegl_graph_process (GeglGraphTraversal *path,
     {
       GeglNode *node = GEGL_NODE (list_iter->data);
       GeglOperation *operation = node->operation;
+      long      node_ticks;
       g_return_val_if_fail (node, NULL);
       g_return_val_if_fail (operation, NULL);
-      
+
+      if (g_hash_table_contains (path->duplicates, node))
+        continue;
+
       GEGL_INSTRUMENT_START();
 
+      node_ticks = gegl_ticks ();
+
       operation_result = NULL;
 
       if (last_context)
@@ -440,12 +828,16 @@ gegl_graph_process (GeglGraphTraversal *path,
                   gegl_operation_context_set_object (context, "input", G_OBJECT (gegl_graph_get_shared_empty(path)));
                 }
 
-              context->level = level;
+              context->level     = level;
+              context->streaming = path->streaming;
 
               /* note: this hard-coding of "output" makes some more custom
                * graph topologies harder than neccesary.
                */
+              GEGL_TRACE_START ();
               gegl_operation_process (operation, context, "output", &context->need_rect, context->level);
+              GEGL_TRACE_END ("process", gegl_node_get_operation (node),
+                              &context->need_rect, context->level);
               operation_result = GEGL_BUFFER (gegl_operation_context_get_object (context, "output"));
 
               if (operation_result && operation_result == (GeglBuffer *)operation->node->cache)
@@ -462,6 +854,13 @@ gegl_graph_process (GeglGraphTraversal *path,
           GeglPad *output_pad = gegl_node_get_pad (node, "output");
           GList   *targets = gegl_graph_get_connected_output_contexts (path, output_pad);
           GList   *targets_iter;
+          GSList  *merged;
+
+          /* also feed the consumers of the nodes merged into this one */
+          for (merged = gegl_graph_get_merged (path, node); merged; merged = merged->next)
+            targets = g_list_concat (targets,
+                                     gegl_graph_get_connected_output_contexts (path,
+                                       gegl_node_get_pad (merged->data, "output")));
 
           GEGL_NOTE (GEGL_DEBUG_PROCESS,
                      "Will deliver the results of %s:%s to %d targets",
@@ -481,7 +880,23 @@ gegl_graph_process (GeglGraphTraversal *path,
         }
       last_context = context;
 
-      GEGL_INSTRUMENT_END ("process", gegl_node_get_operation (node));
+      node_ticks = gegl_ticks () - node_ticks;
+
+      if (gegl_node_profiling)
+        gegl_graph_profile_record (node, context, operation_result, node_ticks);
+
+      /* a one-off request says nothing about how the results are reused */
+      if (!path->streaming)
+        gegl_cache_policy_record (node,
+                                  (gint64) context->need_rect.width *
+                                           context->need_rect.height,
+                                  node_ticks,
+                                  context->cached);
+
+      GEGL_INSTRUMENT_END_PIXELS ("process", gegl_node_get_operation (node),
+                                  context->cached ? 0 :
+                                  (gint64) context->need_rect.width *
+                                           context->need_rect.height);
     }
   if (last_context)
     {
@@ -490,6 +905,16 @@ gegl_graph_process (GeglGraphTraversal *path,
       else if (gegl_node_has_pad (last_context->operation->node, "output"))
         result = g_object_ref (gegl_graph_get_shared_empty (path));
       gegl_operation_context_purge (last_context);
+
+      /* nothing was cached when streaming, keep the cache placement */
+      if (!path->streaming)
+        {
+          if (gegl_rectangle_is_infinite_plane (&last_context->operation->node->have_rect))
+            gegl_cache_policy_update (path->dfs_path, &last_context->need_rect);
+          else
+            gegl_cache_policy_update (path->dfs_path,
+                                      &last_context->operation->node->have_rect);
+        }
     }
 
   return result;
@@ -32,6 +32,11 @@ void                gegl_graph_prepare_request  (GeglGraphTraversal  *path,
 GeglBuffer         *gegl_graph_process          (GeglGraphTraversal  *path,
                                                  gint                 level);
 
+void                gegl_graph_set_streaming    (GeglGraphTraversal  *path,
+                                                 gboolean             streaming);
+
 GeglRectangle       gegl_graph_get_bounding_box (GeglGraphTraversal  *path);
+gint                gegl_graph_get_conversions_removed
+                                                (GeglGraphTraversal  *path);
 
 #endif /* __GEGL_GRAPH_TRAVERSAL_H__ */
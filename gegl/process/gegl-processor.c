@@ -32,6 +32,9 @@
 #include "operation/gegl-operation-sink.h"
 
 #include "gegl-config.h"
+#include "gegl-instrument.h"
+#include "gegl-latency.h"
+#include "gegl-stats.h"
 #include "gegl-processor.h"
 #include "gegl-processor-private.h"
 
@@ -47,7 +50,8 @@ enum
   PROP_NODE,
   PROP_CHUNK_SIZE,
   PROP_PROGRESS,
-  PROP_RECTANGLE
+  PROP_RECTANGLE,
+  PROP_TARGET_LATENCY
 };
 
 
@@ -67,6 +71,10 @@ static void      gegl_processor_set_node     (GeglProcessor         *processor,
 static void      gegl_processor_constructed  (GObject               *object);
 static gdouble   gegl_processor_progress     (GeglProcessor         *processor);
 static gint      gegl_processor_get_band_size(gint                   size) G_GNUC_CONST;
+static gboolean  gegl_processor_is_progressive (GeglProcessor       *processor);
+static gdouble   gegl_processor_progressive_fraction
+                                             (GeglProcessor         *processor,
+                                              gdouble                level_progress);
 
 
 struct _GeglProcessor
@@ -78,14 +86,29 @@ struct _GeglProcessor
   GeglRectangle    rectangle_unscaled;
   GeglNode        *input;
   gint             level;
+  gint             target_level;      /* level refinement ends at */
+  gint             progressive_level; /* coarsest level rendered first when
+                                         doing progressive rendering, if
+                                         not greater than target_level
+                                         progressive rendering is off */
   GeglOperationContext *context;
 
   GeglRegion      *valid_region;     /* used when doing unbuffered rendering */
   GeglRegion      *queued_region;
   GSList          *dirty_rectangles;
   gint             chunk_size;
+  gboolean         opencl_chunks;    /* chunk_size was set for OpenCL */
+  gdouble          target_latency;   /* in milliseconds, 0.0 keeps chunk_size
+                                        fixed */
+  gdouble          usecs_per_pixel;  /* measured cost of rendering a chunk,
+                                        a moving average */
 
   gdouble          progress;
+
+  GeglMemoryReport memory_report;    /* accumulated over all work done */
+  GeglLatencyHistogram *latency;     /* of the work calls, one per
+                                        GeglLatencyPhase, allocated by
+                                        the first */
 };
 
 
@@ -130,12 +153,21 @@ gegl_processor_class_init (GeglProcessorClass *klass)
                                                      1, 4096 * 4096, gegl_config()->chunk_size,
                                                      G_PARAM_READWRITE |
                                                      G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_class_install_property (gobject_class, PROP_TARGET_LATENCY,
+                                   g_param_spec_double ("target-latency",
+                                                        "Target latency",
+                                                        "Time in milliseconds each chunk should take to render, the chunk size is adapted to the measured cost of the graph. 0.0 uses a fixed chunk size.",
+                                                        0.0, 60000.0, 0.0,
+                                                        G_PARAM_READWRITE));
 }
 
 static void
 gegl_processor_init (GeglProcessor *processor)
 {
-  processor->level            = 0;
+  processor->level             = 0;
+  processor->target_level      = 0;
+  processor->progressive_level = 0;
   processor->node             = NULL;
   processor->real_node        = NULL;
   processor->input            = NULL;
@@ -143,6 +175,8 @@ gegl_processor_init (GeglProcessor *processor)
   processor->queued_region    = NULL;
   processor->dirty_rectangles = NULL;
   processor->chunk_size       = 128 * 128;
+  processor->target_latency   = 0.0;
+  processor->usecs_per_pixel  = 0.0;
 }
 
 static void
@@ -190,6 +224,8 @@ gegl_processor_finalize (GObject *self_object)
       gegl_region_destroy (processor->valid_region);
     }
 
+  g_free (processor->latency);
+
   G_OBJECT_CLASS (gegl_processor_parent_class)->finalize (self_object);
 }
 
@@ -215,6 +251,10 @@ gegl_processor_set_property (GObject      *gobject,
         gegl_processor_set_rectangle (self, g_value_get_pointer (value));
         break;
 
+      case PROP_TARGET_LATENCY:
+        self->target_latency = g_value_get_double (value);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -246,6 +286,10 @@ gegl_processor_get_property (GObject    *gobject,
         g_value_set_double (value, gegl_processor_progress (self));
         break;
 
+      case PROP_TARGET_LATENCY:
+        g_value_set_double (value, self->target_latency);
+        break;
+
       default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, property_id, pspec);
         break;
@@ -318,6 +362,17 @@ gegl_processor_set_node (GeglProcessor *processor,
   g_object_notify (G_OBJECT (processor), "node");
 }
 
+/* Progressive rendering is only done when rendering into the cache of the
+ * input node, the results of every level are then kept around as mipmaps.
+ */
+static gboolean
+gegl_processor_is_progressive (GeglProcessor *processor)
+{
+  return processor->progressive_level > processor->target_level &&
+         processor->valid_region == NULL &&
+         processor->context == NULL;
+}
+
 static void
 set_scaled_rectangle (GeglProcessor *processor)
 {
@@ -379,6 +434,14 @@ gegl_processor_set_rectangle (GeglProcessor       *processor,
       processor->dirty_rectangles = NULL;
     }
 
+  /* a new rectangle restarts progressive refinement at the coarsest level */
+  if (gegl_processor_is_progressive (processor) &&
+      processor->level != processor->progressive_level)
+    {
+      processor->level = processor->progressive_level;
+      set_scaled_rectangle (processor);
+    }
+
   /* if the node's operation is a sink and it needs the full content then
    * a context will be set up together with a cache and
    * needed and result rectangles */
@@ -444,6 +507,55 @@ gegl_processor_get_band_size (gint size)
   return band_size;
 }
 
+/* Updates the measured per pixel cost of rendering the processor's graph,
+ * and if a target latency is set derives the chunk size expected to take
+ * that long to render.
+ */
+static void
+gegl_processor_record_cost (GeglProcessor       *processor,
+                            const GeglRectangle *rect,
+                            long                 usecs)
+{
+  gint64  pixels = (gint64) rect->width * rect->height;
+  gdouble usecs_per_pixel;
+  gdouble pixels_in_target;
+  gint    chunk_size;
+
+  /* slivers left over from splitting are dominated by per-chunk overhead
+   * and do not give a meaningful sample */
+  if (pixels < 32 * 32 || usecs <= 0)
+    return;
+
+  usecs_per_pixel = (gdouble) usecs / pixels;
+
+  if (processor->usecs_per_pixel > 0.0)
+    processor->usecs_per_pixel = 0.75 * processor->usecs_per_pixel +
+                                 0.25 * usecs_per_pixel;
+  else
+    processor->usecs_per_pixel = usecs_per_pixel;
+
+  /* OpenCL rendering uses its own fixed chunk size */
+  if (processor->target_latency <= 0.0 || processor->opencl_chunks)
+    return;
+
+  /* max_area in render_rectangle is scaled by the level, compensate so
+   * the chunk size is the one that yields the target area */
+  pixels_in_target = processor->target_latency * 1000.0 /
+                     processor->usecs_per_pixel;
+  chunk_size = CLAMP (pixels_in_target /
+                        ((1 << processor->level) * (1 << processor->level)),
+                      32 * 32, 4096 * 4096);
+
+  if (chunk_size != processor->chunk_size)
+    {
+      GEGL_NOTE (GEGL_DEBUG_PROCESS, "processor for %s: %.3f usecs/px, chunk size %i → %i",
+                 gegl_node_get_debug_name (processor->node),
+                 processor->usecs_per_pixel,
+                 processor->chunk_size, chunk_size);
+      processor->chunk_size = chunk_size;
+    }
+}
+
 /* If the processor's dirty rectangle is too big then it will be cut, added
  * to the processor's list of dirty rectangles and TRUE will be returned.
  * If the rectangle is small enough it will be processed, using a buffer or
@@ -519,7 +631,7 @@ render_rectangle (GeglProcessor *processor)
           gboolean found_full = FALSE;
           for (gint level = processor->level; level >= 0; level--)
           {
-            if (gegl_region_rect_in (cache->valid_region[level], dr) == GEGL_OVERLAP_RECTANGLE_IN)
+            if (gegl_cache_is_valid (cache, dr, level))
             {
               found_full = TRUE;
               break;
@@ -533,16 +645,27 @@ render_rectangle (GeglProcessor *processor)
             {
               /* create a buffer and initialise it */
               guchar *buf;
+              long    ticks;
 
               buf = g_malloc (dr->width * dr->height * pxsize);
               g_assert (buf);
 
               /* FIXME: Check if the node caches naturaly, if so the buffer_set call isn't needed */
 
-              /* do the image calculations using the buffer */
-              gegl_node_blit (processor->input, 1.0/(1<<processor->level),
-                              dr, format, buf,
-                              GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+              /* do the image calculations using the buffer, when refining
+               * progressively the graph is evaluated directly at the
+               * coarse level instead of being downscaled from level 0
+               */
+              ticks = gegl_ticks ();
+              if (gegl_processor_is_progressive (processor))
+                gegl_node_blit_level (processor->input, 1.0/(1<<processor->level),
+                                      processor->level,
+                                      dr, format, buf, GEGL_AUTO_ROWSTRIDE);
+              else
+                gegl_node_blit (processor->input, 1.0/(1<<processor->level),
+                                dr, format, buf,
+                                GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+              gegl_processor_record_cost (processor, dr, gegl_ticks () - ticks);
 
               /* copy the buffer data into the cache */
               {
@@ -561,9 +684,12 @@ render_rectangle (GeglProcessor *processor)
         }
       else
         {
+           long ticks = gegl_ticks ();
+
            gegl_node_blit (processor->real_node, 1.0/(1<<processor->level),
                            dr, NULL, NULL,
                            GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+           gegl_processor_record_cost (processor, dr, gegl_ticks () - ticks);
            gegl_region_union_with_rect (processor->valid_region, dr);
            g_slice_free (GeglRectangle, dr);
         }
@@ -614,6 +740,29 @@ area_left (GeglRegion    *area,
   return sum;
 }
 
+/* returns the area of rectangle not rendered yet */
+static gint
+gegl_processor_area_left (GeglProcessor *processor,
+                          GeglRectangle *rectangle)
+{
+  GeglRectangle *rectangles;
+  gint           n_rectangles;
+  gint           i;
+  gint           sum = 0;
+
+  if (processor->valid_region)
+    return area_left (processor->valid_region, rectangle);
+
+  gegl_cache_get_missing (gegl_node_get_cache (processor->input), rectangle,
+                          processor->level, &rectangles, &n_rectangles);
+
+  for (i = 0; i < n_rectangles; i++)
+    sum += rect_area (&rectangles[i]);
+  g_free (rectangles);
+
+  return sum;
+}
+
 /* returns true if everything is rendered */
 static gboolean
 gegl_processor_is_rendered (GeglProcessor *processor)
@@ -627,24 +776,14 @@ gegl_processor_is_rendered (GeglProcessor *processor)
 static gdouble
 gegl_processor_progress (GeglProcessor *processor)
 {
-  GeglRegion *valid_region;
   gint        valid;
   gint        wanted;
   gdouble     ret;
 
   g_return_val_if_fail (processor->input != NULL, 1);
 
-  if (processor->valid_region)
-    {
-      valid_region = processor->valid_region;
-    }
-  else
-    {
-      valid_region = gegl_node_get_cache (processor->input)->valid_region[processor->level];
-    }
-
   wanted = rect_area (&(processor->rectangle));
-  valid  = wanted - area_left (valid_region, &(processor->rectangle));
+  valid  = wanted - gegl_processor_area_left (processor, &(processor->rectangle));
   if (wanted == 0)
     {
       if (gegl_processor_is_rendered (processor))
@@ -661,9 +800,40 @@ gegl_processor_progress (GeglProcessor *processor)
         }
     }
 
+  if (gegl_processor_is_progressive (processor))
+    ret = gegl_processor_progressive_fraction (processor, MIN (ret, 1.0));
+
   return ret;
 }
 
+/* Maps the progress within the level currently being rendered to the
+ * progress of the whole progressive refinement, each level is weighted
+ * by its pixel count relative to the coarsest level.
+ */
+static gdouble
+gegl_processor_progressive_fraction (GeglProcessor *processor,
+                                     gdouble        level_progress)
+{
+  gdouble total = 0.0;
+  gdouble done  = 0.0;
+  gint    level;
+
+  for (level = processor->progressive_level;
+       level >= processor->target_level;
+       level--)
+    {
+      gdouble weight = 1 << (2 * (processor->progressive_level - level));
+
+      if (level > processor->level)
+        done += weight;
+      else if (level == processor->level)
+        done += weight * level_progress;
+      total += weight;
+    }
+
+  return done / total;
+}
+
 /* Processes the rectangle (might be only splitting it to smaller ones) and
  * updates the progress indicator */
 static gboolean
@@ -671,17 +841,7 @@ gegl_processor_render (GeglProcessor *processor,
                        GeglRectangle *rectangle,
                        gdouble       *progress)
 {
-  GeglRegion *valid_region;
-
-  if (processor->valid_region)
-    {
-      valid_region = processor->valid_region;
-    }
-  else
-    {
-      g_return_val_if_fail (processor->input != NULL, FALSE);
-      valid_region = gegl_node_get_cache (processor->input)->valid_region[processor->level];
-    }
+  g_return_val_if_fail (processor->input != NULL, FALSE);
 
   {
     gboolean more_work = render_rectangle (processor);
@@ -695,12 +855,25 @@ gegl_processor_render (GeglProcessor *processor,
             if (rectangle)
               {
                 wanted = rect_area (rectangle);
-                valid  = wanted - area_left (valid_region, rectangle);
+                valid  = wanted - gegl_processor_area_left (processor, rectangle);
               }
             else
               {
-                valid  = region_area (valid_region);
-                wanted = region_area (processor->queued_region);
+                GeglRectangle *rectangles;
+                gint           n_rectangles;
+                gint           i;
+
+                gegl_region_get_rectangles (processor->queued_region,
+                                            &rectangles, &n_rectangles);
+                wanted = 0;
+                valid  = 0;
+                for (i = 0; i < n_rectangles; i++)
+                  {
+                    wanted += rect_area (&rectangles[i]);
+                    valid  += rect_area (&rectangles[i]) -
+                              gegl_processor_area_left (processor, &rectangles[i]);
+                  }
+                g_free (rectangles);
               }
             if (wanted == 0)
               {
@@ -719,14 +892,25 @@ gegl_processor_render (GeglProcessor *processor,
   if (rectangle)
     { /* we're asked to work on a specific rectangle thus we only focus
          on it */
-      GeglRegion    *region = gegl_region_rectangle (rectangle);
       GeglRectangle *rectangles;
       gint           n_rectangles;
       gint           i;
 
-      gegl_region_subtract (region, valid_region);
-      gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
-      gegl_region_destroy (region);
+      if (processor->valid_region)
+        {
+          GeglRegion *region = gegl_region_rectangle (rectangle);
+
+          gegl_region_subtract (region, processor->valid_region);
+          gegl_region_get_rectangles (region, &rectangles, &n_rectangles);
+          gegl_region_destroy (region);
+        }
+      else
+        {
+          /* the cache hands out its missing parts aligned to its tiles */
+          gegl_cache_get_missing (gegl_node_get_cache (processor->input),
+                                  rectangle, processor->level,
+                                  &rectangles, &n_rectangles);
+        }
 
       for (i = 0; i < n_rectangles && i < 1; i++)
         {
@@ -744,7 +928,7 @@ gegl_processor_render (GeglProcessor *processor,
       if (n_rectangles != 0)
         {
           if (progress)
-            *progress = 1.0 - ((double) area_left (valid_region, rectangle) /
+            *progress = 1.0 - ((double) gegl_processor_area_left (processor, rectangle) /
                                rect_area (rectangle));
           return TRUE;
         }
@@ -787,16 +971,16 @@ gegl_processor_render (GeglProcessor *processor,
 
 /* Will call gegl_processor_render and when there is no more work to be done,
  * it will write the result to the destination */
-gboolean
-gegl_processor_work (GeglProcessor *processor,
-                     gdouble       *progress)
+static gboolean
+gegl_processor_work_real (GeglProcessor *processor,
+                          gdouble       *progress)
 {
   gboolean   more_work = FALSE;
 
   if (gegl_config()->use_opencl)
     {
       if (gegl_cl_is_accelerated ()
-          && processor->chunk_size != GEGL_CL_CHUNK_SIZE)
+          && !processor->opencl_chunks)
         {
           GeglListVisitor *visitor = g_object_new (GEGL_TYPE_LIST_VISITOR, NULL);
           GList *iterator = NULL;
@@ -809,7 +993,8 @@ gegl_processor_work (GeglProcessor *processor,
               if (GEGL_OPERATION_GET_CLASS(node->operation)->cl_data
                   || GEGL_OPERATION_GET_CLASS(node->operation)->opencl_support)
                 {
-                  processor->chunk_size = GEGL_CL_CHUNK_SIZE;
+                  processor->chunk_size    = GEGL_CL_CHUNK_SIZE;
+                  processor->opencl_chunks = TRUE;
                   break;
                 }
             }
@@ -822,6 +1007,26 @@ gegl_processor_work (GeglProcessor *processor,
   more_work = gegl_processor_render (processor, &processor->rectangle, progress);
   if (more_work)
     {
+      if (progress && gegl_processor_is_progressive (processor))
+        *progress = gegl_processor_progressive_fraction (processor, *progress);
+      return TRUE;
+    }
+
+  /* the current level is complete and available in the cache, continue
+   * refining at the next finer level
+   */
+  if (gegl_processor_is_progressive (processor) &&
+      processor->level > processor->target_level)
+    {
+      GEGL_NOTE (GEGL_DEBUG_PROCESS, "progressive rendering of %s done at level %i",
+                 gegl_node_get_debug_name (processor->node), processor->level);
+
+      processor->level--;
+      set_scaled_rectangle (processor);
+
+      if (progress)
+        *progress = gegl_processor_progressive_fraction (processor, 0.0);
+
       return TRUE;
     }
 
@@ -846,6 +1051,63 @@ gegl_processor_work (GeglProcessor *processor,
   return FALSE;
 }
 
+gboolean
+gegl_processor_work (GeglProcessor *processor,
+                     gdouble       *progress)
+{
+  GeglStatsReport    start;
+  GeglLatencyTiming  timing;
+  GeglLatencyTiming *outer_timing;
+  gint64             start_time;
+  gboolean           more_work;
+  gint               i;
+
+  gegl_stats_report_begin (&start);
+
+  start_time   = g_get_monotonic_time ();
+  outer_timing = gegl_latency_timing_push (&timing);
+
+  more_work = gegl_processor_work_real (processor, progress);
+
+  timing.phases[GEGL_LATENCY_TOTAL] = g_get_monotonic_time () - start_time;
+  gegl_latency_timing_pop (&timing, outer_timing);
+
+  if (!processor->latency)
+    processor->latency = g_new0 (GeglLatencyHistogram, GEGL_LATENCY_N_PHASES);
+
+  for (i = 0; i < GEGL_LATENCY_N_PHASES; i++)
+    gegl_latency_histogram_record (&processor->latency[i], timing.phases[i]);
+
+  gegl_stats_report_end (&start, &processor->memory_report);
+
+  return more_work;
+}
+
+gint64
+gegl_processor_get_latency (GeglProcessor    *processor,
+                            GeglLatencyPhase  phase,
+                            gdouble           percentile)
+{
+  g_return_val_if_fail (GEGL_IS_PROCESSOR (processor), 0);
+  g_return_val_if_fail (phase < GEGL_LATENCY_N_PHASES, 0);
+
+  if (!processor->latency)
+    return 0;
+
+  return gegl_latency_histogram_percentile (&processor->latency[phase],
+                                            percentile);
+}
+
+void
+gegl_processor_get_memory_report (GeglProcessor    *processor,
+                                  GeglMemoryReport *report)
+{
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+  g_return_if_fail (report != NULL);
+
+  *report = processor->memory_report;
+}
+
 GeglProcessor *
 gegl_node_new_processor (GeglNode            *node,
                          const GeglRectangle *rectangle)
@@ -861,12 +1123,47 @@ gegl_node_new_processor (GeglNode            *node,
 void gegl_processor_set_level (GeglProcessor *processor,
                                gint           level)
 {
-  processor->level = level;
+  processor->target_level = level;
+  processor->level        = MAX (level, processor->progressive_level);
   set_scaled_rectangle (processor);
 }
 void gegl_processor_set_scale (GeglProcessor *processor,
                                gdouble        scale)
 {
-  processor->level = gegl_level_from_scale (scale);
+  gegl_processor_set_level (processor, gegl_level_from_scale (scale));
+}
+
+gint gegl_processor_get_level (GeglProcessor *processor)
+{
+  g_return_val_if_fail (GEGL_IS_PROCESSOR (processor), 0);
+
+  return processor->level;
+}
+
+void gegl_processor_set_progressive (GeglProcessor *processor,
+                                     gint           coarsest_level)
+{
+  GSList *iter;
+
+  g_return_if_fail (GEGL_IS_PROCESSOR (processor));
+  g_return_if_fail (processor->real_node != NULL);
+
+  if (GEGL_IS_OPERATION_SINK (processor->real_node->operation))
+    {
+      g_warning ("progressive rendering is not supported for sink nodes");
+      return;
+    }
+
+  processor->progressive_level = CLAMP (coarsest_level, 0,
+                                        GEGL_CACHE_VALID_MIPMAPS - 1);
+  processor->level = MAX (processor->target_level,
+                          processor->progressive_level);
+
+  /* queued work is in the coordinates of the previous level */
+  for (iter = processor->dirty_rectangles; iter; iter = g_slist_next (iter))
+    g_slice_free (GeglRectangle, iter->data);
+  g_slist_free (processor->dirty_rectangles);
+  processor->dirty_rectangles = NULL;
+
   set_scaled_rectangle (processor);
 }
@@ -47,6 +47,35 @@ void gegl_processor_set_level (GeglProcessor *processor,
 void gegl_processor_set_scale (GeglProcessor *processor,
                                gdouble        scale);
 
+/**
+ * gegl_processor_get_level:
+ * @processor: a #GeglProcessor
+ *
+ * Returns the mipmap level the processor is currently rendering at. When
+ * rendering progressively, it moves to the next finer level as soon as a
+ * level is complete. Once the first level is complete, the last preview
+ * delivered to the node's cache is one level coarser than the returned
+ * level, until gegl_processor_work() returns FALSE and the returned level
+ * is complete too.
+ */
+gint gegl_processor_get_level (GeglProcessor *processor);
+
+/**
+ * gegl_processor_set_progressive:
+ * @processor: a #GeglProcessor
+ * @coarsest_level: the mipmap level to render first, 0 disables
+ * progressive rendering.
+ *
+ * Make the processor render its rectangle coarse-to-fine, first at
+ * @coarsest_level and then refining one level at a time until the level set
+ * with gegl_processor_set_level() or gegl_processor_set_scale() is reached.
+ * The result of every level is stored in the cache of the node being
+ * processed, making a low resolution preview available early. Not
+ * supported when processing sink nodes.
+ */
+void gegl_processor_set_progressive (GeglProcessor *processor,
+                                     gint           coarsest_level);
+
 /**
  * gegl_processor_set_rectangle:
  * @processor: a #GeglProcessor
@@ -79,6 +108,34 @@ void           gegl_processor_set_rectangle (GeglProcessor       *processor,
 gboolean       gegl_processor_work          (GeglProcessor *processor,
                                              gdouble       *progress);
 
+/**
+ * gegl_processor_get_memory_report:
+ * @processor: a #GeglProcessor
+ * @report: (out caller-allocates): a #GeglMemoryReport to fill in.
+ *
+ * Retrieve what the work done by @processor so far used: the most bytes
+ * held in tiles at once, the number of buffers created and tiles
+ * allocated, the bytes converted by babl reading and writing buffers
+ * and the swap traffic. The peak is measured process wide, it includes
+ * tiles held by anything else happening during the processing.
+ */
+void           gegl_processor_get_memory_report (GeglProcessor    *processor,
+                                                 GeglMemoryReport *report);
+
+/**
+ * gegl_processor_get_latency:
+ * @processor: a #GeglProcessor
+ * @phase: the phase of the work, or GEGL_LATENCY_TOTAL
+ * @percentile: the percentile to return, such as 50.0 or 99.0
+ *
+ * Returns the latency in microseconds that @percentile percent of the
+ * gegl_processor_work() calls on @processor spent at most in @phase,
+ * with a precision of about 3%, or 0 before any work was done.
+ */
+gint64         gegl_processor_get_latency   (GeglProcessor    *processor,
+                                             GeglLatencyPhase  phase,
+                                             gdouble           percentile);
+
 G_END_DECLS
 
 #endif /* __GEGL_PROCESSOR_H__ */
@@ -28,6 +28,7 @@ property_double (blur_radius, _("Blur radius"), 4.0)
   value_range   (0.0, 1000.0)
   ui_range      (0.0, 100.0)
   ui_gamma      (1.5)
+  ui_meta       ("unit", "pixel-distance")
 
 property_double (edge_preservation, _("Edge preservation"), 8.0)
   description   (_("Amount of edge preservation"))
@@ -52,12 +53,17 @@ bilateral_filter (GeglBuffer          *src,
 
 #include <stdio.h>
 
-static void prepare (GeglOperation *operation)
+static void update_area (GeglOperation *operation)
 {
   GeglOperationAreaFilter *area = GEGL_OPERATION_AREA_FILTER (operation);
   GeglProperties              *o = GEGL_PROPERTIES (operation);
 
   area->left = area->right = area->top = area->bottom = ceil (o->blur_radius);
+}
+
+static void prepare (GeglOperation *operation)
+{
+  update_area (operation);
   gegl_operation_set_format (operation, "input", babl_format ("RGBA float"));
   gegl_operation_set_format (operation, "output", babl_format ("RGBA float"));
 }
@@ -285,6 +291,10 @@ gegl_op_class_init (GeglOpClass *klass)
 
   operation_class->opencl_support = TRUE;
 
+  GEGL_OPERATION_AREA_FILTER_CLASS (klass)->update_area = update_area;
+  gegl_operation_area_filter_class_scale_properties (
+    GEGL_OPERATION_AREA_FILTER_CLASS (klass), "blur-radius", NULL);
+
   gegl_operation_class_set_keys (operation_class,
            "name", "gegl:bilateral-filter",
            "title", _("Bilateral Filter"),
@@ -27,6 +27,7 @@ property_int (radius, _("Radius"), 4)
    value_range (0, 1000)
    ui_range    (0, 100)
    ui_gamma   (1.5)
+   ui_meta     ("unit", "pixel-distance")
 
 #else
 
@@ -163,9 +164,10 @@ ver_blur (GeglBuffer          *src,
 
 #undef SRC_OFFSET
 
-static void prepare (GeglOperation *operation)
+static void
+update_area (GeglOperation *operation)
 {
-  GeglProperties              *o;
+  GeglProperties          *o;
   GeglOperationAreaFilter *op_area;
 
   op_area = GEGL_OPERATION_AREA_FILTER (operation);
@@ -175,6 +177,11 @@ static void prepare (GeglOperation *operation)
   op_area->right  =
   op_area->top    =
   op_area->bottom = o->radius;
+}
+
+static void prepare (GeglOperation *operation)
+{
+  update_area (operation);
 
   gegl_operation_set_format (operation, "input",  babl_format ("RaGaBaA float"));
   gegl_operation_set_format (operation, "output", babl_format ("RaGaBaA float"));
@@ -389,6 +396,10 @@ gegl_op_class_init (GeglOpClass *klass)
 
   operation_class->opencl_support = TRUE;
 
+  GEGL_OPERATION_AREA_FILTER_CLASS (klass)->update_area = update_area;
+  gegl_operation_area_filter_class_scale_properties (
+    GEGL_OPERATION_AREA_FILTER_CLASS (klass), "radius", NULL);
+
   gegl_operation_class_set_keys (operation_class,
       "name",        "gegl:box-blur",
       "title",       _("Box Blur"),
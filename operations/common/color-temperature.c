@@ -88,6 +88,23 @@ static void prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", format);
 }
 
+/* Scaling the color channels gives the same result with and without
+ * premultiplied alpha, so either can be used to avoid a conversion.
+ */
+static const Babl **
+get_supported_formats (GeglOperation *operation)
+{
+  static const Babl *formats[3] = { NULL, };
+
+  if (!formats[0])
+    {
+      formats[1] = babl_format ("RaGaBaA float");
+      formats[0] = babl_format ("RGBA float");
+    }
+
+  return formats;
+}
+
 static void
 finalize (GObject *object)
 {
@@ -270,6 +287,7 @@ gegl_op_class_init (GeglOpClass *klass)
   object_class->notify   = notify;
 
   operation_class->prepare = prepare;
+  operation_class->get_supported_formats = get_supported_formats;
 
   point_filter_class->process    = process;
   point_filter_class->cl_process = cl_process;
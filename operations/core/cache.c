@@ -24,6 +24,8 @@
 #ifdef GEGL_PROPERTIES
   property_object (cache, _("Cache"), GEGL_TYPE_BUFFER)
       description (_("NULL or a GeglBuffer containing cached rendering results, this is a special buffer where gegl_buffer_list_valid_rectangles returns the part of the cache that is valid."))
+  property_boolean (pinned, _("Pinned"), FALSE)
+      description (_("Keep the cached tiles in memory ahead of other buffers, up to the tile-cache-pinned-size of GeglConfig"))
 #else
 
 #define GEGL_OP_POINT_FILTER
@@ -44,6 +46,41 @@ prepare (GeglOperation *operation)
   gegl_operation_set_format (operation, "output", format);
 }
 
+/* pinning changes where the cached tiles are kept, not the pixels */
+static GeglRectangle
+get_invalidated_by_property (GeglOperation       *operation,
+                             const gchar         *property_name,
+                             const GeglRectangle *old_box,
+                             const GeglRectangle *new_box)
+{
+  GeglRectangle result = { 0, 0, 0, 0 };
+
+  if (! strcmp (property_name, "pinned"))
+    return result;
+
+  gegl_rectangle_bounding_box (&result, old_box, new_box);
+
+  return result;
+}
+
+/* a cache created later is pinned by gegl_node_get_cache */
+static void
+notify (GObject    *object,
+        GParamSpec *pspec)
+{
+  if (strcmp (pspec->name, "pinned") == 0)
+    {
+      GeglOperation  *operation = GEGL_OPERATION (object);
+      GeglProperties *o         = GEGL_PROPERTIES (object);
+
+      if (operation->node && operation->node->cache)
+        gegl_cache_set_pinned (operation->node->cache, o->pinned);
+    }
+
+  if (G_OBJECT_CLASS (gegl_op_parent_class)->notify)
+    G_OBJECT_CLASS (gegl_op_parent_class)->notify (object, pspec);
+}
+
 static gboolean
 process (GeglOperation       *operation,
          void                *in_buf,
@@ -75,15 +112,20 @@ process (GeglOperation       *operation,
 static void
 gegl_op_class_init (GeglOpClass *klass)
 {
+  GObjectClass                  *object_class;
   GeglOperationClass            *operation_class;
   GeglOperationPointFilterClass *point_filter_class;
 
+  object_class       = G_OBJECT_CLASS (klass);
   operation_class    = GEGL_OPERATION_CLASS (klass);
   point_filter_class = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
 
+  object_class->notify = notify;
+
   operation_class->no_cache      = FALSE;
   operation_class->want_in_place = FALSE;
   operation_class->prepare       = prepare;
+  operation_class->get_invalidated_by_property = get_invalidated_by_property;
   point_filter_class->process    = process;
 
   gegl_operation_class_set_keys (operation_class,
@@ -123,6 +123,60 @@ gegl_crop_get_invalidated_by_change (GeglOperation       *operation,
   return result;
 }
 
+/* moving a single edge of the crop only changes the strip between its old
+ * and new position
+ */
+static GeglRectangle
+gegl_crop_get_invalidated_by_property (GeglOperation       *operation,
+                                       const gchar         *property_name,
+                                       const GeglRectangle *old_box,
+                                       const GeglRectangle *new_box)
+{
+  GeglRectangle result = { 0, 0, 0, 0 };
+  gint          old_end;
+  gint          new_end;
+
+  if (gegl_rectangle_equal (old_box, new_box))
+    return result;
+
+  gegl_rectangle_bounding_box (&result, old_box, new_box);
+
+  if (old_box->x == new_box->x && old_box->width == new_box->width)
+    {
+      old_end = old_box->y + old_box->height;
+      new_end = new_box->y + new_box->height;
+
+      if (old_box->y == new_box->y)
+        {
+          result.y      = MIN (old_end, new_end);
+          result.height = ABS (old_end - new_end);
+        }
+      else if (old_end == new_end)
+        {
+          result.y      = MIN (old_box->y, new_box->y);
+          result.height = ABS (old_box->y - new_box->y);
+        }
+    }
+  else if (old_box->y == new_box->y && old_box->height == new_box->height)
+    {
+      old_end = old_box->x + old_box->width;
+      new_end = new_box->x + new_box->width;
+
+      if (old_box->x == new_box->x)
+        {
+          result.x     = MIN (old_end, new_end);
+          result.width = ABS (old_end - new_end);
+        }
+      else if (old_end == new_end)
+        {
+          result.x     = MIN (old_box->x, new_box->x);
+          result.width = ABS (old_box->x - new_box->x);
+        }
+    }
+
+  return result;
+}
+
 static GeglRectangle
 gegl_crop_get_required_for_output (GeglOperation       *operation,
                                    const gchar         *input_pad,
@@ -215,6 +269,7 @@ gegl_op_class_init (GeglOpClass *klass)
   operation_class->get_bounding_box          = gegl_crop_get_bounding_box;
   operation_class->detect                    = gegl_crop_detect;
   operation_class->get_invalidated_by_change = gegl_crop_get_invalidated_by_change;
+  operation_class->get_invalidated_by_property = gegl_crop_get_invalidated_by_property;
   operation_class->get_required_for_output   = gegl_crop_get_required_for_output;
 
   gegl_operation_class_set_keys (operation_class,
@@ -167,6 +167,7 @@ op_transform_class_init (OpTransformClass *klass)
   op_class->prepare                   = gegl_transform_prepare;
   op_class->no_cache                  = TRUE;
   op_class->threaded                  = TRUE;
+  op_class->memoize_rects             = TRUE;
 
   klass->create_matrix = NULL;
 
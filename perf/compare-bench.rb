@@ -0,0 +1,78 @@
+#!/usr/bin/env ruby
+#
+# ruby program comparing two benchmark runs, as written by the perf tests
+# when GEGL_BENCH_JSON is set. A measurement has regressed when its median
+# throughput dropped by more than the threshold and is also slower than
+# the p95 throughput of the baseline, making noise unlikely. Exits with 1
+# when anything regressed.
+#
+#   compare-bench.rb [--threshold percent] baseline.json current.json
+
+require 'json'
+
+threshold = 5.0
+args = ARGV.dup
+if (i = args.index('--threshold'))
+  threshold = args[i + 1].to_f
+  args.slice!(i, 2)
+end
+
+if args.length != 2
+  $stderr.puts "usage: #{$0} [--threshold percent] baseline.json current.json"
+  exit 2
+end
+
+def load_runs(path)
+  runs = Hash.new
+  File.open(path).each { |line|
+    next if line.strip.empty?
+    run = JSON.parse(line)
+    key = [run['id'], run['opencl'], run['threads'], run['width'], run['height']]
+    runs[key] = run
+  }
+  runs
+end
+
+def describe(key)
+  id, opencl, threads, width, height = key
+  desc = id.dup
+  desc += " (OpenCL)" if opencl
+  desc += " [#{width}x#{height}]" if width > 0
+  desc += " [#{threads} threads]"
+  desc
+end
+
+baseline = load_runs(args[0])
+current  = load_runs(args[1])
+regressions = 0
+
+current.keys.sort_by { |key| describe(key) }.each { |key|
+  run  = current[key]
+  base = baseline[key]
+
+  if !base
+    printf("  new      %-50s %10.2f MB/s\n", describe(key), run['median_mbps'])
+    next
+  end
+
+  change = (run['median_mbps'] / base['median_mbps'] - 1.0) * 100.0
+  status = "  ok     "
+  if change < -threshold && run['median_mbps'] < base['p95_mbps']
+    status = "! SLOWER "
+    regressions += 1
+  elsif change > threshold && run['p95_mbps'] > base['median_mbps']
+    status = "  faster "
+  end
+
+  printf("%s %-50s %10.2f -> %10.2f MB/s %+7.1f%%\n", status, describe(key),
+         base['median_mbps'], run['median_mbps'], change)
+}
+
+baseline.keys.each { |key|
+  printf("  missing  %s\n", describe(key)) if !current[key]
+}
+
+if regressions > 0
+  puts "#{regressions} regression(s) beyond #{threshold}%"
+  exit 1
+end
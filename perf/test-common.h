@@ -1,12 +1,40 @@
+
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include "gegl.h"
 #include "gegl/opencl/gegl-cl-init.h"
 
+/* The benchmarks are tuned through environment variables:
+ *
+ *   GEGL_BENCH_WARMUP   runs discarded before measuring, default 1
+ *   GEGL_BENCH_REPS     measured runs, default 16
+ *   GEGL_BENCH_THREADS  thread counts to sweep, such as "1,2,4,8"
+ *   GEGL_BENCH_SIZES    buffer sizes to sweep, such as "512,1024x2048"
+ *   GEGL_BENCH_JSON     file to append a JSON record per measurement to
+ *
+ * Each measurement prints a "@ id: N megabytes/second" line with its
+ * median throughput, as read by create-report.rb, the JSON records also
+ * carry the p95 and the individual samples for compare-bench.rb.
+ */
+
 static long ticks_start;
 
+/* median throughput of the latest measurement, 0.0 when it was skipped */
+static gdouble bench_last_mbps;
+
 typedef void (*t_run_perf)(GeglBuffer *buffer);
 
+typedef struct
+{
+  gint    warmup;
+  gint    reps;
+  GArray *threads; /* gint */
+  GArray *sizes;   /* GeglRectangle, only width and height are used */
+  FILE   *json;
+} BenchConfig;
+
 long babl_ticks (void); /* using babl_ticks instead of gegl_ticks
                            to be able to go further back in time */
 
@@ -27,6 +55,189 @@ void bench(const gchar *id,
            GeglBuffer  *buffer,
            t_run_perf   test_func );
 
+static gint
+bench_env_int (const gchar *name,
+               gint         def)
+{
+  const gchar *value = g_getenv (name);
+
+  if (value && atoi (value) > 0)
+    return atoi (value);
+
+  return def;
+}
+
+static gint
+bench_threads (void)
+{
+  gint threads;
+
+  g_object_get (gegl_config (), "threads", &threads, NULL);
+
+  return threads;
+}
+
+static BenchConfig *
+bench_config (void)
+{
+  static BenchConfig *config = NULL;
+  const gchar        *value;
+
+  if (config)
+    return config;
+
+  config = g_new0 (BenchConfig, 1);
+  config->warmup  = bench_env_int ("GEGL_BENCH_WARMUP", 1);
+  config->reps    = bench_env_int ("GEGL_BENCH_REPS", 16);
+  config->threads = g_array_new (FALSE, FALSE, sizeof (gint));
+  config->sizes   = g_array_new (FALSE, FALSE, sizeof (GeglRectangle));
+
+  value = g_getenv ("GEGL_BENCH_THREADS");
+  if (value)
+    {
+      gchar **items = g_strsplit (value, ",", 0);
+      gint    max   = 0;
+      gint    i;
+
+      for (i = 0; items[i]; i++)
+        {
+          gint threads = MAX (atoi (items[i]), 1);
+
+          g_array_append_val (config->threads, threads);
+          max = MAX (max, threads);
+        }
+      g_strfreev (items);
+
+      /* the worker pools are sized when first used, make them large
+       * enough for the whole sweep
+       */
+      if (max)
+        g_object_set (gegl_config (), "threads", max, NULL);
+    }
+
+  value = g_getenv ("GEGL_BENCH_SIZES");
+  if (value)
+    {
+      gchar **items = g_strsplit (value, ",", 0);
+      gint    i;
+
+      for (i = 0; items[i]; i++)
+        {
+          GeglRectangle size = { 0, };
+          gchar        *x    = strchr (items[i], 'x');
+
+          size.width  = atoi (items[i]);
+          size.height = x ? atoi (x + 1) : size.width;
+
+          if (size.width > 0 && size.height > 0)
+            g_array_append_val (config->sizes, size);
+        }
+      g_strfreev (items);
+    }
+
+  value = g_getenv ("GEGL_BENCH_JSON");
+  if (value)
+    {
+      config->json = fopen (value, "a");
+      if (!config->json)
+        g_warning ("unable to open %s for writing", value);
+    }
+
+  return config;
+}
+
+static gint
+bench_compare_double (gconstpointer a,
+                      gconstpointer b)
+{
+  gdouble da = *(const gdouble *) a;
+  gdouble db = *(const gdouble *) b;
+
+  return (da > db) - (da < db);
+}
+
+/* nearest rank percentile of the n sorted values */
+static gdouble
+bench_percentile (const gdouble *sorted,
+                  gint           n,
+                  gdouble        percentile)
+{
+  gint rank = (gint) (percentile / 100.0 * n + 0.999999);
+
+  return sorted[CLAMP (rank, 1, n) - 1];
+}
+
+static void
+bench_json_double (FILE        *file,
+                   const gchar *name,
+                   gdouble      value)
+{
+  gchar str[G_ASCII_DTOSTR_BUF_SIZE];
+
+  fprintf (file, ", \"%s\": %s", name,
+           g_ascii_formatd (str, sizeof (str), "%.6f", value));
+}
+
+/* report the run times in seconds of moving bytes per run */
+static void
+bench_report (const gchar *id,
+              const gchar *suffix,
+              gboolean     opencl,
+              gint         width,
+              gint         height,
+              glong        bytes,
+              gdouble     *samples,
+              gint         n)
+{
+  BenchConfig *config = bench_config ();
+  gdouble      mbytes = bytes / 1024.0 / 1024.0;
+  gdouble      median, p95, sum = 0.0;
+  gint         i;
+
+  qsort (samples, n, sizeof (gdouble), bench_compare_double);
+
+  for (i = 0; i < n; i++)
+    sum += samples[i];
+
+  median = bench_percentile (samples, n, 50.0);
+  p95    = bench_percentile (samples, n, 95.0);
+
+  bench_last_mbps = mbytes / median;
+
+  g_print ("@ %s%s: %.2f megabytes/second\n", id, suffix, bench_last_mbps);
+
+  if (config->json)
+    {
+      gchar *escaped = g_strescape (id, NULL);
+
+      fprintf (config->json,
+               "{\"id\": \"%s\", \"opencl\": %s, \"threads\": %d, "
+               "\"width\": %d, \"height\": %d, \"bytes\": %ld, "
+               "\"warmup\": %d, \"reps\": %d",
+               escaped, opencl ? "true" : "false", bench_threads (),
+               width, height, bytes, n > 1 ? config->warmup : 0, n);
+      bench_json_double (config->json, "median_s", median);
+      bench_json_double (config->json, "p95_s", p95);
+      bench_json_double (config->json, "min_s", samples[0]);
+      bench_json_double (config->json, "mean_s", sum / n);
+      bench_json_double (config->json, "median_mbps", mbytes / median);
+      bench_json_double (config->json, "p95_mbps", mbytes / p95);
+
+      fprintf (config->json, ", \"samples_s\": [");
+      for (i = 0; i < n; i++)
+        {
+          gchar str[G_ASCII_DTOSTR_BUF_SIZE];
+
+          fprintf (config->json, "%s%s", i ? ", " : "",
+                   g_ascii_formatd (str, sizeof (str), "%.6f", samples[i]));
+        }
+      fprintf (config->json, "]}\n");
+      fflush (config->json);
+
+      g_free (escaped);
+    }
+}
+
 void test_start (void)
 {
   ticks_start = babl_ticks ();
@@ -36,9 +247,9 @@ void test_end_suffix (const gchar *id,
                       const gchar *suffix,
                       glong        bytes)
 {
-  long ticks = babl_ticks ()-ticks_start;
-  g_print ("@ %s%s: %.2f megabytes/second\n",
-       id, suffix, (bytes / 1024.0 / 1024.0)  / (ticks / 1000000.0));
+  gdouble seconds = (babl_ticks () - ticks_start) / 1000000.0;
+
+  bench_report (id, suffix, FALSE, 0, 0, bytes, &seconds, 1);
 }
 
 void test_end (const gchar *id,
@@ -47,7 +258,7 @@ void test_end (const gchar *id,
     test_end_suffix (id, "", bytes);
 }
 
-/* create a test buffer of random data in -0.5 to 2.0 range 
+/* create a test buffer of random data in -0.5 to 2.0 range
  */
 GeglBuffer *test_buffer (gint width,
                          gint height,
@@ -65,12 +276,49 @@ GeglBuffer *test_buffer (gint width,
   return buffer;
 }
 
+static void
+bench_measure (const gchar *id,
+               const gchar *suffix,
+               GeglBuffer  *buffer,
+               t_run_perf   test_func,
+               gboolean     opencl)
+{
+  BenchConfig         *config  = bench_config ();
+  const GeglRectangle *extent  = gegl_buffer_get_extent (buffer);
+  gdouble             *samples = g_new (gdouble, config->reps);
+  gint                 i;
+
+  for (i = 0; i < config->warmup; i++)
+    test_func (buffer);
+
+  for (i = 0; i < config->reps; i++)
+    {
+      test_start ();
+      test_func (buffer);
+      samples[i] = (babl_ticks () - ticks_start) / 1000000.0;
+    }
+
+  bench_report (id, suffix, opencl, extent->width, extent->height,
+                gegl_buffer_get_pixel_count (buffer) * 16,
+                samples, config->reps);
+
+  g_free (samples);
+}
+
 void do_bench (const gchar *id,
                GeglBuffer  *buffer,
                t_run_perf   test_func,
                gboolean     opencl)
 {
+  /* saved before bench_config () first raises it for a thread sweep */
+  gint         threads = bench_threads ();
+  BenchConfig *config  = bench_config ();
   gchar* suffix = "";
+  gint   n_sizes   = MAX (config->sizes->len, 1);
+  gint   n_threads = MAX (config->threads->len, 1);
+  gint   s, t;
+
+  bench_last_mbps = 0.0;
 
   g_object_set(G_OBJECT(gegl_config()),
                "use-opencl", opencl,
@@ -84,17 +332,47 @@ void do_bench (const gchar *id,
     suffix = " (OpenCL)";
   }
 
-  // warm up
-  test_func(buffer);
-
-#define ITERATIONS 16
-  test_start ();
-  for (int i=0; i<ITERATIONS; ++i)
+  for (s = 0; s < n_sizes; s++)
     {
-      test_func(buffer);
+      GeglBuffer *sized;
+      GString    *sized_suffix = g_string_new (suffix);
+
+      if (config->sizes->len)
+        {
+          GeglRectangle *size = &g_array_index (config->sizes, GeglRectangle, s);
+
+          sized = test_buffer (size->width, size->height,
+                               gegl_buffer_get_format (buffer));
+          g_string_append_printf (sized_suffix, " [%dx%d]",
+                                  size->width, size->height);
+        }
+      else
+        {
+          sized = g_object_ref (buffer);
+        }
+
+      for (t = 0; t < n_threads; t++)
+        {
+          GString *full_suffix = g_string_new (sized_suffix->str);
+
+          if (config->threads->len)
+            {
+              gint count = g_array_index (config->threads, gint, t);
+
+              g_object_set (gegl_config (), "threads", count, NULL);
+              g_string_append_printf (full_suffix, " [%d threads]", count);
+            }
+
+          bench_measure (id, full_suffix->str, sized, test_func, opencl);
+
+          g_string_free (full_suffix, TRUE);
+        }
+
+      g_string_free (sized_suffix, TRUE);
+      g_object_unref (sized);
     }
-  test_end_suffix (id, suffix, gegl_buffer_get_pixel_count (buffer) * 16 * ITERATIONS);
-#undef ITERATIONS
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
 }
 
 void bench (const gchar *id,
@@ -104,4 +382,3 @@ void bench (const gchar *id,
   do_bench(id, buffer, test_func, FALSE );
   do_bench(id, buffer, test_func, TRUE );
 }
-
@@ -0,0 +1,238 @@
+#include "test-common.h"
+#include "gegl-plugin.h"
+
+/* Benchmarks every registered operation producing output, with default
+ * properties, in a standard graph: filters and composers are fed a
+ * random buffer on all their inputs, sources are cropped to its size.
+ * Each is measured at 1 and at all threads, and with OpenCL when
+ * available, a summary of the slowest operations and those gaining
+ * nothing from threads follows. An optional regular expression limits
+ * the operations benchmarked.
+ */
+
+#define WIDTH  512
+#define HEIGHT 512
+
+/* a threaded operation is expected to at least gain this much */
+#define MIN_SPEEDUP 1.25
+
+#define SLOWEST 20
+
+typedef struct
+{
+  const gchar *name;
+  gdouble      single; /* megabytes/second at 1 thread */
+  gdouble      multi;  /* megabytes/second at all threads */
+} OperationResult;
+
+static const gchar *current_operation;
+
+static GeglNode *
+operation_graph (GeglNode    *gegl,
+                 const gchar *operation,
+                 GeglBuffer  *buffer,
+                 GeglBuffer **result)
+{
+  const gchar *inputs[] = { "input", "aux", "aux2" };
+  GeglNode    *node, *crop, *sink;
+  gint         i;
+
+  node = gegl_node_new_child (gegl, "operation", operation, NULL);
+  crop = gegl_node_new_child (gegl, "operation", "gegl:crop",
+                              "width",  (gdouble) WIDTH,
+                              "height", (gdouble) HEIGHT,
+                              NULL);
+  sink = gegl_node_new_child (gegl, "operation", "gegl:buffer-sink",
+                              "buffer", result,
+                              NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (inputs); i++)
+    if (gegl_node_has_pad (node, inputs[i]))
+      {
+        GeglNode *source = gegl_node_new_child (gegl,
+                                                "operation", "gegl:buffer-source",
+                                                "buffer", buffer,
+                                                NULL);
+        gegl_node_connect_to (source, "output", node, inputs[i]);
+      }
+
+  gegl_node_link_many (node, crop, sink, NULL);
+
+  return sink;
+}
+
+static void
+run_operation (GeglBuffer *buffer)
+{
+  GeglBuffer *result = NULL;
+  GeglNode   *gegl   = gegl_node_new ();
+  GeglNode   *sink;
+
+  sink = operation_graph (gegl, current_operation, buffer, &result);
+  gegl_node_process (sink);
+
+  g_object_unref (gegl);
+  g_clear_object (&result);
+}
+
+static gboolean
+operation_renders (const gchar *operation,
+                   GeglBuffer  *buffer)
+{
+  GeglBuffer    *result = NULL;
+  GeglNode      *gegl   = gegl_node_new ();
+  GeglNode      *sink;
+  GeglRectangle  box;
+
+  sink = operation_graph (gegl, operation, buffer, &result);
+  box  = gegl_node_get_bounding_box (gegl_node_get_producer (sink, "input", NULL));
+
+  g_object_unref (gegl);
+
+  return box.width > 0 && box.height > 0;
+}
+
+static void
+collect_operations (GType   type,
+                    GList **operations)
+{
+  GType *children;
+  guint  count;
+  gint   i;
+
+  children = g_type_children (type, &count);
+
+  for (i = 0; i < count; i++)
+    {
+      GeglOperationClass *operation_class = g_type_class_ref (children[i]);
+      const gchar        *name;
+
+      name = gegl_operation_class_get_key (operation_class, "name");
+
+      if (name &&
+          !g_type_is_a (children[i], GEGL_TYPE_OPERATION_SINK) &&
+          !g_type_is_a (children[i], GEGL_TYPE_OPERATION_TEMPORAL))
+        *operations = g_list_prepend (*operations, (gpointer) name);
+
+      collect_operations (children[i], operations);
+    }
+
+  g_free (children);
+}
+
+static gint
+compare_single (gconstpointer a,
+                gconstpointer b)
+{
+  const OperationResult *ra = a;
+  const OperationResult *rb = b;
+
+  return (ra->single > rb->single) - (ra->single < rb->single);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GeglBuffer *buffer;
+  GRegex     *regex      = NULL;
+  GList      *operations = NULL;
+  GList      *iter;
+  GArray     *results;
+  gint        threads    = MIN (g_get_num_processors (), 16);
+  guint       i;
+
+  /* fewer repetitions than for the hand written tests, there are a lot
+   * of operations to get through
+   */
+  if (!g_getenv ("GEGL_BENCH_REPS"))
+    g_setenv ("GEGL_BENCH_REPS", "4", TRUE);
+
+  gegl_init (&argc, &argv);
+
+  if (argc > 1)
+    regex = g_regex_new (argv[1], 0, 0, NULL);
+
+  /* the worker pools are sized when first used */
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  buffer  = test_buffer (WIDTH, HEIGHT, babl_format ("RGBA float"));
+  results = g_array_new (FALSE, TRUE, sizeof (OperationResult));
+
+  collect_operations (GEGL_TYPE_OPERATION, &operations);
+  operations = g_list_sort (operations, (GCompareFunc) strcmp);
+
+  for (iter = operations; iter; iter = g_list_next (iter))
+    {
+      OperationResult result = { iter->data, 0.0, 0.0 };
+
+      if (regex && !g_regex_match (regex, result.name, 0, NULL))
+        continue;
+
+      if (!operation_renders (result.name, buffer))
+        {
+          g_print ("%s: nothing to render with default properties, skipped\n",
+                   result.name);
+          continue;
+        }
+
+      current_operation = result.name;
+
+      g_object_set (gegl_config (), "threads", 1, NULL);
+      do_bench (result.name, buffer, run_operation, FALSE);
+      result.single = bench_last_mbps;
+
+      g_object_set (gegl_config (), "threads", threads, NULL);
+      if (threads > 1)
+        {
+          gchar *id = g_strdup_printf ("%s [%d threads]", result.name, threads);
+
+          do_bench (id, buffer, run_operation, FALSE);
+          result.multi = bench_last_mbps;
+          g_free (id);
+        }
+      else
+        {
+          result.multi = result.single;
+        }
+
+      do_bench (result.name, buffer, run_operation, TRUE);
+
+      g_array_append_val (results, result);
+    }
+
+  g_array_sort (results, compare_single);
+
+  g_print ("\nslowest operations, in megapixels/second at 1 thread:\n");
+  for (i = 0; i < MIN (results->len, SLOWEST); i++)
+    {
+      OperationResult *result = &g_array_index (results, OperationResult, i);
+
+      g_print ("  %-40s %10.2f\n", result->name, result->single / 16.0);
+    }
+
+  if (threads > 1)
+    {
+      g_print ("\noperations gaining less than %.2fx from %d threads:\n",
+               MIN_SPEEDUP, threads);
+      for (i = 0; i < results->len; i++)
+        {
+          OperationResult *result = &g_array_index (results, OperationResult, i);
+
+          if (result->single > 0.0 &&
+              result->multi < result->single * MIN_SPEEDUP)
+            g_print ("  %-40s %10.2fx\n", result->name,
+                     result->multi / result->single);
+        }
+    }
+
+  g_array_free (results, TRUE);
+  g_list_free (operations);
+  g_object_unref (buffer);
+  if (regex)
+    g_regex_unref (regex);
+
+  gegl_exit ();
+
+  return 0;
+}
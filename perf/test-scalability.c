@@ -0,0 +1,315 @@
+#include "test-common.h"
+
+/* Runs representative graphs at 1, 2, 4 ... up to all threads, or at the
+ * counts given in GEGL_BENCH_THREADS, and reports the speedup over a
+ * single thread and the parallel efficiency of each. Time spent waiting
+ * for the tile storage and tile cache mutexes is taken from gegl_stats ()
+ * to point out lock contention. An optional regular expression limits
+ * the graphs run.
+ */
+
+#define WIDTH  1024
+#define HEIGHT 1024
+
+/* efficiency, speedup divided by threads, below which scaling is flagged */
+#define MIN_EFFICIENCY 0.5
+
+/* fraction of the thread time spent waiting for locks that is flagged */
+#define MAX_LOCK_WAIT 0.05
+
+typedef struct
+{
+  const gchar *name;
+  t_run_perf   run;
+} Scenario;
+
+typedef struct
+{
+  gdouble mbps;
+  gdouble storage_wait; /* seconds per run */
+  gdouble cache_wait;
+} Measurement;
+
+static GeglBuffer *
+source_output (GeglNode *source)
+{
+  GeglBuffer *result = NULL;
+  GeglNode   *sink;
+
+  sink = gegl_node_new_child (gegl_node_get_parent (source),
+                              "operation", "gegl:buffer-sink",
+                              "buffer", &result,
+                              NULL);
+  gegl_node_link (source, sink);
+  gegl_node_process (sink);
+
+  return result;
+}
+
+static void
+point_chain (GeglBuffer *buffer)
+{
+  GeglBuffer *result;
+  GeglNode   *gegl, *source, *bcontrast, *saturation, *invert;
+
+  gegl       = gegl_node_new ();
+  source     = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                    "buffer", buffer, NULL);
+  bcontrast  = gegl_node_new_child (gegl, "operation", "gegl:brightness-contrast",
+                                    "contrast", 1.2, NULL);
+  saturation = gegl_node_new_child (gegl, "operation", "gegl:saturation",
+                                    "scale", 0.8, NULL);
+  invert     = gegl_node_new_child (gegl, "operation", "gegl:invert-linear",
+                                    NULL);
+
+  gegl_node_link_many (source, bcontrast, saturation, invert, NULL);
+  result = source_output (invert);
+
+  g_object_unref (result);
+  g_object_unref (gegl);
+}
+
+static void
+area_filter (GeglBuffer *buffer)
+{
+  GeglBuffer *result;
+  GeglNode   *gegl, *source, *blur;
+
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                "buffer", buffer, NULL);
+  blur   = gegl_node_new_child (gegl, "operation", "gegl:gaussian-blur",
+                                "std-dev-x", 10.0,
+                                "std-dev-y", 10.0,
+                                NULL);
+
+  gegl_node_link (source, blur);
+  result = source_output (blur);
+
+  g_object_unref (result);
+  g_object_unref (gegl);
+}
+
+static void
+transform (GeglBuffer *buffer)
+{
+  GeglBuffer *result;
+  GeglNode   *gegl, *source, *rotate;
+
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                "buffer", buffer, NULL);
+  rotate = gegl_node_new_child (gegl, "operation", "gegl:rotate",
+                                "degrees", 4.0, NULL);
+
+  gegl_node_link (source, rotate);
+  result = source_output (rotate);
+
+  g_object_unref (result);
+  g_object_unref (gegl);
+}
+
+static void
+composer (GeglBuffer *buffer)
+{
+  GeglBuffer *result;
+  GeglNode   *gegl, *source, *aux, *translate, *over;
+
+  gegl      = gegl_node_new ();
+  source    = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                   "buffer", buffer, NULL);
+  aux       = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                   "buffer", buffer, NULL);
+  translate = gegl_node_new_child (gegl, "operation", "gegl:translate",
+                                   "x", 64.0,
+                                   "y", 64.0,
+                                   NULL);
+  over      = gegl_node_new_child (gegl, "operation", "gegl:over", NULL);
+
+  gegl_node_link (aux, translate);
+  gegl_node_link (source, over);
+  gegl_node_connect_to (translate, "output", over, "aux");
+  result = source_output (over);
+
+  g_object_unref (result);
+  g_object_unref (gegl);
+}
+
+static void
+mipmap_read (GeglBuffer *buffer)
+{
+  GeglNode *gegl, *source, *invert;
+  guchar   *pixels = g_malloc (WIDTH / 4 * HEIGHT / 4 * 4);
+
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl, "operation", "gegl:buffer-source",
+                                "buffer", buffer, NULL);
+  invert = gegl_node_new_child (gegl, "operation", "gegl:invert-linear",
+                                NULL);
+
+  gegl_node_link (source, invert);
+  gegl_node_blit (invert, 0.25,
+                  GEGL_RECTANGLE (0, 0, WIDTH / 4, HEIGHT / 4),
+                  babl_format ("R'G'B'A u8"), pixels,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  g_free (pixels);
+  g_object_unref (gegl);
+}
+
+static const Scenario scenarios[] =
+{
+  { "point-chain", point_chain },
+  { "area-filter", area_filter },
+  { "transform",   transform },
+  { "composer",    composer },
+  { "mipmap-read", mipmap_read }
+};
+
+static guint64
+stats_get (const gchar *name)
+{
+  guint64 value;
+
+  g_object_get (gegl_stats (), name, &value, NULL);
+
+  return value;
+}
+
+static Measurement
+measure (const Scenario *scenario,
+         GeglBuffer     *buffer,
+         gint            threads)
+{
+  BenchConfig *config = bench_config ();
+  Measurement  measurement;
+  guint64      storage_wait, cache_wait;
+  gint         runs   = config->warmup + config->reps;
+  gchar       *suffix = g_strdup_printf (" [%d threads]", threads);
+
+  g_object_set (gegl_config (), "threads", threads, NULL);
+
+  storage_wait = stats_get ("storage-lock-wait-usecs");
+  cache_wait   = stats_get ("cache-lock-wait-usecs");
+
+  bench_measure (scenario->name, suffix, buffer, scenario->run, FALSE);
+
+  measurement.mbps         = bench_last_mbps;
+  measurement.storage_wait = (stats_get ("storage-lock-wait-usecs") -
+                              storage_wait) / 1000000.0 / runs;
+  measurement.cache_wait   = (stats_get ("cache-lock-wait-usecs") -
+                              cache_wait) / 1000000.0 / runs;
+
+  g_free (suffix);
+
+  return measurement;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  BenchConfig *config;
+  GeglBuffer  *buffer;
+  GRegex      *regex   = NULL;
+  GArray      *threads;
+  gint         max     = MIN (g_get_num_processors (), 16);
+  gint         flagged = 0;
+  guint        s, t;
+
+  gegl_init (&argc, &argv);
+
+  if (argc > 1)
+    regex = g_regex_new (argv[1], 0, 0, NULL);
+
+  config = bench_config ();
+
+  if (config->threads->len)
+    {
+      threads = g_array_ref (config->threads);
+    }
+  else
+    {
+      gint count;
+
+      threads = g_array_new (FALSE, FALSE, sizeof (gint));
+      for (count = 1; count < max; count *= 2)
+        g_array_append_val (threads, count);
+      g_array_append_val (threads, max);
+
+      /* the worker pools are sized when first used */
+      g_object_set (gegl_config (), "threads", max, NULL);
+    }
+
+  g_object_set (gegl_config (), "use-opencl", FALSE, NULL);
+
+  buffer = test_buffer (WIDTH, HEIGHT, babl_format ("RGBA float"));
+
+  for (s = 0; s < G_N_ELEMENTS (scenarios); s++)
+    {
+      const Scenario *scenario = &scenarios[s];
+      Measurement    *results;
+
+      if (regex && !g_regex_match (regex, scenario->name, 0, NULL))
+        continue;
+
+      results = g_new0 (Measurement, threads->len);
+
+      for (t = 0; t < threads->len; t++)
+        results[t] = measure (scenario, buffer,
+                              g_array_index (threads, gint, t));
+
+      g_print ("\n%s:\n", scenario->name);
+      g_print ("  %7s %10s %8s %10s %12s %12s\n",
+               "threads", "MB/s", "speedup", "efficiency",
+               "storage wait", "cache wait");
+
+      for (t = 0; t < threads->len; t++)
+        {
+          gint     count      = g_array_index (threads, gint, t);
+          gdouble  speedup    = results[0].mbps > 0.0 ?
+                                results[t].mbps / results[0].mbps : 0.0;
+          gdouble  efficiency = speedup / count *
+                                g_array_index (threads, gint, 0);
+          gdouble  seconds    = results[t].mbps > 0.0 ?
+                                gegl_buffer_get_pixel_count (buffer) * 16 /
+                                1024.0 / 1024.0 / results[t].mbps : 0.0;
+          gdouble  wait       = results[t].storage_wait +
+                                results[t].cache_wait;
+          GString *flags      = g_string_new (NULL);
+
+          if (t > 0 && efficiency < MIN_EFFICIENCY)
+            g_string_append (flags, " poor scaling");
+
+          if (seconds > 0.0 && wait > seconds * count * MAX_LOCK_WAIT)
+            g_string_append (flags, " lock contention");
+
+          if (flags->len)
+            flagged++;
+
+          g_print ("  %7d %10.2f %7.2fx %9.0f%% %10.2fms %10.2fms%s\n",
+                   count, results[t].mbps, speedup, efficiency * 100.0,
+                   results[t].storage_wait * 1000.0,
+                   results[t].cache_wait * 1000.0,
+                   flags->str);
+
+          g_string_free (flags, TRUE);
+        }
+
+      g_free (results);
+    }
+
+  if (flagged)
+    g_print ("\n%d measurements below %.0f%% efficiency or waiting over "
+             "%.0f%% of their thread time for locks\n",
+             flagged, MIN_EFFICIENCY * 100.0, MAX_LOCK_WAIT * 100.0);
+
+  g_array_unref (threads);
+  g_object_unref (buffer);
+  if (regex)
+    g_regex_unref (regex);
+
+  gegl_exit ();
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <math.h>
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define SIZE 128
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-area-filter-level: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static GeglNode *
+new_blur (GeglNode *graph)
+{
+  GeglNode *source, *blur;
+
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:checkerboard",
+                                "x",         16,
+                                "y",         16,
+                                NULL);
+  blur   = gegl_node_new_child (graph,
+                                "operation", "gegl:box-blur",
+                                "radius",    6,
+                                NULL);
+  gegl_node_link (source, blur);
+
+  return blur;
+}
+
+int main(int argc, char *argv[])
+{
+  gint           result = SUCCESS;
+  GeglNode      *preview_graph, *full_graph;
+  const Babl    *format;
+  gfloat        *full;
+  gfloat        *preview;
+  gfloat         max_diff = 0.0;
+  gint           x, y;
+
+  /* render the preview at mipmap level 1 */
+  g_setenv ("GEGL_MIPMAP_RENDERING", "1", TRUE);
+
+  gegl_init (&argc, &argv);
+
+  format  = babl_format ("Y float");
+  full    = g_new0 (gfloat, SIZE * SIZE);
+  preview = g_new0 (gfloat, SIZE * SIZE / 4);
+
+  /* separate graphs, so the preview is computed at level 1 rather than
+   * read from a cache filled by the full rendering
+   */
+  preview_graph = gegl_node_new ();
+  full_graph    = gegl_node_new ();
+
+  gegl_node_blit (new_blur (preview_graph), 0.5,
+                  GEGL_RECTANGLE (0, 0, SIZE / 2, SIZE / 2),
+                  format, preview, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  gegl_node_blit (new_blur (full_graph), 1.0,
+                  GEGL_RECTANGLE (0, 0, SIZE, SIZE), format, full,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  /* the half size preview should look like the full rendering scaled
+   * down, not like a blur with twice the radius
+   */
+  for (y = 0; y < SIZE / 2; y++)
+    for (x = 0; x < SIZE / 2; x++)
+      {
+        gfloat expected = (full[(y * 2)     * SIZE + x * 2]     +
+                           full[(y * 2)     * SIZE + x * 2 + 1] +
+                           full[(y * 2 + 1) * SIZE + x * 2]     +
+                           full[(y * 2 + 1) * SIZE + x * 2 + 1]) / 4.0;
+
+        max_diff = MAX (max_diff, fabs (preview[y * SIZE / 2 + x] - expected));
+      }
+
+  CHECK (max_diff < 0.15, "preview does not match the scaled down rendering");
+
+ abort:
+  g_free (full);
+  g_free (preview);
+  g_object_unref (preview_graph);
+  g_object_unref (full_graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-blit-latency: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+#define BLITS 20
+
+int main(int argc, char *argv[])
+{
+  gint           result    = SUCCESS;
+  GeglNode      *gegl, *source, *blur;
+  GeglColor     *color;
+  GeglProcessor *processor = NULL;
+  guchar        *pixels;
+  gint           i;
+
+  gegl_init (&argc, &argv);
+
+  pixels = g_new (guchar, 1024 * 1024 * 4);
+
+  color  = gegl_color_new ("red");
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl,
+                                "operation", "gegl:color",
+                                "value", color,
+                                NULL);
+  blur   = gegl_node_new_child (gegl,
+                                "operation", "gegl:gaussian-blur",
+                                "std-dev-x", 4.0,
+                                "std-dev-y", 4.0,
+                                NULL);
+  gegl_node_link (source, blur);
+
+  gegl_stats_reset_blit_latency ();
+
+  for (i = 0; i < BLITS; i++)
+    gegl_node_blit (blur, 1.0, GEGL_RECTANGLE (i * 64, 0, 64, 64),
+                    babl_format ("R'G'B'A u8"), pixels,
+                    GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  gegl_node_blit (blur, 1.0, GEGL_RECTANGLE (0, 0, 1024, 1024),
+                  babl_format ("R'G'B'A u8"), pixels,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  CHECK (gegl_stats_get_blit_count (GEGL_BLIT_SIZE_TILE) == BLITS,
+         "tile sized blits not counted");
+  CHECK (gegl_stats_get_blit_count (GEGL_BLIT_SIZE_VIEWPORT) == 1,
+         "viewport sized blit not counted");
+  CHECK (gegl_stats_get_blit_count (GEGL_BLIT_SIZE_LARGE) == 0,
+         "blit counted in the wrong size class");
+
+  CHECK (gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_TILE,
+                                      GEGL_LATENCY_TOTAL, 99.0) >=
+         gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_TILE,
+                                      GEGL_LATENCY_TOTAL, 50.0),
+         "p99 below the median");
+  CHECK (gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_VIEWPORT,
+                                      GEGL_LATENCY_TOTAL, 50.0) > 0,
+         "viewport blit took no time");
+  CHECK (gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_VIEWPORT,
+                                      GEGL_LATENCY_COMPUTE, 50.0) > 0,
+         "computation not accounted");
+  CHECK (gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_VIEWPORT,
+                                      GEGL_LATENCY_CONVERT, 50.0) > 0,
+         "conversion to the requested format not accounted");
+  CHECK (gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_VIEWPORT,
+                                      GEGL_LATENCY_COMPUTE, 100.0) <=
+         gegl_stats_get_blit_latency (GEGL_BLIT_SIZE_VIEWPORT,
+                                      GEGL_LATENCY_TOTAL, 100.0),
+         "phase longer than the whole blit");
+
+  gegl_stats_reset_blit_latency ();
+  CHECK (gegl_stats_get_blit_count (GEGL_BLIT_SIZE_TILE) == 0,
+         "histograms not reset");
+
+  processor = gegl_node_new_processor (blur, GEGL_RECTANGLE (0, 0, 512, 512));
+  CHECK (gegl_processor_get_latency (processor, GEGL_LATENCY_TOTAL, 50.0) == 0,
+         "latency before any work");
+
+  while (gegl_processor_work (processor, NULL));
+
+  CHECK (gegl_processor_get_latency (processor, GEGL_LATENCY_TOTAL, 100.0) > 0,
+         "processor work latency not recorded");
+  CHECK (gegl_stats_get_blit_count (GEGL_BLIT_SIZE_TILE) == 0 &&
+         gegl_stats_get_blit_count (GEGL_BLIT_SIZE_SMALL) == 0 &&
+         gegl_stats_get_blit_count (GEGL_BLIT_SIZE_VIEWPORT) == 0,
+         "processor chunks counted as blits");
+
+ abort:
+  g_clear_object (&processor);
+  g_object_unref (gegl);
+  g_object_unref (color);
+  g_free (pixels);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gegl.h"
+#include "gegl-node-private.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define WIDTH  200
+#define HEIGHT 300
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-blit-stream: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint           result = SUCCESS;
+  GeglNode      *graph, *source, *blur, *crop;
+  const Babl    *format;
+  guchar        *streamed;
+  guchar        *cached;
+  GeglRectangle  roi = {10, 20, WIDTH, HEIGHT};
+
+  gegl_init (&argc, &argv);
+
+  format   = babl_format ("RGBA u8");
+  streamed = g_malloc0 (WIDTH * HEIGHT * 4);
+  cached   = g_malloc0 (WIDTH * HEIGHT * 4);
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:checkerboard",
+                                "x",         7,
+                                "y",         5,
+                                NULL);
+  blur   = gegl_node_new_child (graph,
+                                "operation", "gegl:box-blur",
+                                "radius",    4,
+                                NULL);
+  crop   = gegl_node_new_child (graph,
+                                "operation", "gegl:crop",
+                                "width",     400.0,
+                                "height",    400.0,
+                                NULL);
+  gegl_node_link_many (source, blur, crop, NULL);
+
+  /* a streamed rendering leaves no caches behind */
+  gegl_node_blit (crop, 1.0, &roi, format, streamed,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_STREAM);
+
+  CHECK (source->cache == NULL && blur->cache == NULL && crop->cache == NULL,
+         "streaming rendering populated a node cache");
+
+  /* and matches what a regular rendering computes, also across the bands
+   * it was rendered in
+   */
+  gegl_node_blit (crop, 1.0, &roi, format, cached,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  CHECK (memcmp (streamed, cached, WIDTH * HEIGHT * 4) == 0,
+         "streamed rendering differs from the regular rendering");
+
+ abort:
+  g_free (streamed);
+  g_free (cached);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
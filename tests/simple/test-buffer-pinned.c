@@ -0,0 +1,121 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-buffer-private.h"
+#include "gegl-tile-storage.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-buffer-pinned: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static GeglBuffer *
+filled_buffer (gint tiles_x,
+               gint tiles_y)
+{
+  gint        width, height;
+  GeglBuffer *buffer;
+  GeglColor  *color = gegl_color_new ("white");
+
+  g_object_get (gegl_config (),
+                "tile-width",  &width,
+                "tile-height", &height,
+                NULL);
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, tiles_x * width,
+                                            tiles_y * height),
+                            babl_format ("Y u8"));
+  gegl_buffer_set_color (buffer, NULL, color);
+  g_object_unref (color);
+
+  return buffer;
+}
+
+static gint
+count_cached (GeglBuffer *buffer,
+              gint        tiles_x,
+              gint        tiles_y)
+{
+  GeglTileSource *cache = GEGL_TILE_SOURCE (buffer->tile_storage->cache);
+  gint            count = 0;
+  gint            x, y;
+
+  for (y = 0; y < tiles_y; y++)
+    for (x = 0; x < tiles_x; x++)
+      count += gegl_tile_source_is_cached (cache, x, y, 0);
+
+  return count;
+}
+
+int main(int argc, char *argv[])
+{
+  gint        result = SUCCESS;
+  gint        width, height;
+  GeglBuffer *pinned   = NULL;
+  GeglBuffer *unpinned = NULL;
+  GeglBuffer *flood    = NULL;
+
+  gegl_init (&argc, &argv);
+
+  g_object_get (gegl_config (),
+                "tile-width",  &width,
+                "tile-height", &height,
+                NULL);
+
+  /* room for 16 "Y u8" tiles, 4 of which may be pinned */
+  g_object_set (gegl_config (),
+                "tile-cache-size",        (guint64) 16 * width * height,
+                "tile-cache-pinned-size", (guint64) 4 * width * height,
+                NULL);
+
+  pinned   = filled_buffer (2, 2);
+  unpinned = filled_buffer (2, 2);
+  gegl_tile_handler_cache_set_pinned (pinned->tile_storage->cache, TRUE);
+
+  CHECK (count_cached (pinned, 2, 2) == 4, "pinned tiles not cached");
+
+  /* pinned tiles survive other buffers churning through the cache */
+  flood = filled_buffer (8, 8);
+
+  CHECK (count_cached (pinned, 2, 2) == 4, "pinned tiles evicted");
+  CHECK (count_cached (unpinned, 2, 2) == 0, "unpinned tiles not evicted");
+
+  /* but only as many as fit the pinned budget */
+  g_object_unref (flood);
+  g_object_unref (unpinned);
+  unpinned = filled_buffer (4, 2);
+  gegl_tile_handler_cache_set_pinned (unpinned->tile_storage->cache, TRUE);
+  flood = filled_buffer (8, 8);
+
+  CHECK (count_cached (pinned, 2, 2) + count_cached (unpinned, 4, 2) <= 4,
+         "pinned tiles beyond the budget kept");
+
+ abort:
+  g_clear_object (&pinned);
+  g_clear_object (&unpinned);
+  g_clear_object (&flood);
+  gegl_exit ();
+
+  return result;
+}
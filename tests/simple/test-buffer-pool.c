@@ -0,0 +1,158 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-types-internal.h"
+#include "gegl-operation.h"
+#include "gegl-operation-context.h"
+#include "gegl-operation-context-private.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-buffer-pool: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+/* the RGBA float buffers used here take a quarter of the pool each */
+#define SIZE  512
+#define N_FIT 4
+
+/* a context of @operation rendering a @size × @size output, as the
+ * traversal of a streamed render creates them
+ */
+static GeglOperationContext *
+new_context (GeglOperation *operation,
+             gint           size)
+{
+  GeglOperationContext *context = gegl_operation_context_new (operation);
+
+  context->streaming = TRUE;
+  gegl_operation_context_set_result_rect (context,
+                                          GEGL_RECTANGLE (0, 0, size, size));
+
+  return context;
+}
+
+/* the output buffer of a new context, which is left in *context */
+static GeglBuffer *
+new_target (GeglOperation         *operation,
+            gint                   size,
+            GeglOperationContext **context)
+{
+  *context = new_context (operation, size);
+
+  return gegl_operation_context_get_target (*context, "output");
+}
+
+int main(int argc, char *argv[])
+{
+  gint                  result = SUCCESS;
+  GeglNode             *graph;
+  GeglNode             *node;
+  GeglOperation        *operation;
+  GeglOperationContext *context;
+  GeglOperationContext *contexts[N_FIT + 1];
+  GeglBuffer           *buffers[N_FIT + 1];
+  GeglBuffer           *buffer;
+  GeglBuffer           *first;
+  gint                  n_alive;
+  gint                  i;
+
+  gegl_init (&argc, &argv);
+
+  graph = gegl_node_new ();
+
+  /* point filters write every pixel of their output, their outputs are
+   * taken from the pool
+   */
+  node      = gegl_node_new_child (graph,
+                                   "operation", "gegl:invert-linear",
+                                   NULL);
+  operation = gegl_node_get_gegl_operation (node);
+  gegl_operation_set_format (operation, "output", babl_format ("RGBA float"));
+
+  g_assert ((guint64) SIZE * SIZE * 16 * N_FIT == GEGL_BUFFER_POOL_BYTES);
+
+  /* the output is recycled for the next chunk of the same shape */
+  first = new_target (operation, SIZE, &context);
+  gegl_operation_context_destroy (context);
+
+  buffer = new_target (operation, SIZE, &context);
+  CHECK (buffer == first, "released buffer not reused");
+
+  /* a buffer that is still shared stays with its owner */
+  g_object_ref (buffer);
+  gegl_operation_context_destroy (context);
+
+  first  = buffer;
+  buffer = new_target (operation, SIZE, &context);
+  CHECK (buffer != first, "shared buffer recycled");
+  gegl_operation_context_destroy (context);
+  g_object_unref (first);
+
+  /* so does a buffer whose tiles were forked into another buffer */
+  buffer = new_target (operation, SIZE, &context);
+  gegl_object_set_has_forked (G_OBJECT (buffer));
+  first = buffer;
+  g_object_add_weak_pointer (G_OBJECT (first), (gpointer *) &first);
+  gegl_operation_context_destroy (context);
+  CHECK (first == NULL, "forked buffer recycled");
+
+  /* chunks of other shapes get their own buffers */
+  first = new_target (operation, SIZE, &context);
+  gegl_operation_context_destroy (context);
+  buffer = new_target (operation, SIZE / 2, &context);
+  CHECK (buffer != first, "buffer of another shape reused");
+  gegl_operation_context_destroy (context);
+
+  /* the pool is bounded by bytes: of five buffers taking a quarter of it
+   * each, the first one released is dropped
+   */
+  gegl_operation_context_pool_cleanup ();
+
+  for (i = 0; i <= N_FIT; i++)
+    {
+      buffers[i] = new_target (operation, SIZE, &contexts[i]);
+      g_object_add_weak_pointer (G_OBJECT (buffers[i]), (gpointer *) &buffers[i]);
+    }
+  for (i = 0; i <= N_FIT; i++)
+    gegl_operation_context_destroy (contexts[i]);
+
+  CHECK (buffers[0] == NULL, "least recently released buffer kept");
+  for (i = 1, n_alive = 0; i <= N_FIT; i++)
+    if (buffers[i])
+      n_alive++;
+  CHECK (n_alive == N_FIT, "pool does not hold what fits");
+
+  /* a buffer larger than the whole pool is never kept */
+  buffer = new_target (operation, SIZE * 4, &context);
+  first  = buffer;
+  g_object_add_weak_pointer (G_OBJECT (first), (gpointer *) &first);
+  gegl_operation_context_destroy (context);
+  CHECK (first == NULL, "buffer larger than the pool kept");
+
+ abort:
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,107 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-node-private.h"
+#include "gegl-cache-policy.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-cache-policy: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+#define SIZE   128
+#define PIXELS (SIZE * SIZE)
+
+static GeglNode *
+new_node (GeglNode    *graph,
+          const gchar *operation)
+{
+  GeglNode *node = gegl_node_new_child (graph, "operation", operation, NULL);
+
+  gegl_rectangle_set (&node->have_rect, 0, 0, SIZE, SIZE);
+
+  return node;
+}
+
+int main(int argc, char *argv[])
+{
+  gint      result = SUCCESS;
+  GeglNode *graph, *cheap, *reused, *unreused, *requested;
+  GList    *dfs_path = NULL;
+  gint      i;
+
+  gegl_init (&argc, &argv);
+
+  graph     = gegl_node_new ();
+  cheap     = new_node (graph, "gegl:box-blur");
+  reused    = new_node (graph, "gegl:box-blur");
+  unreused  = new_node (graph, "gegl:box-blur");
+  requested = new_node (graph, "gegl:crop");
+
+  dfs_path = g_list_append (dfs_path, cheap);
+  dfs_path = g_list_append (dfs_path, reused);
+  dfs_path = g_list_append (dfs_path, unreused);
+  dfs_path = g_list_append (dfs_path, requested);
+
+  /* nothing is measured without a budget */
+  gegl_cache_policy_record (reused, PIXELS, PIXELS, FALSE);
+  CHECK (reused->cache_requests == 0, "request recorded without a budget");
+
+  /* room for the cache of a single node, without a format known they
+   * count as 16 bytes per pixel
+   */
+  g_object_set (gegl_config (),
+                "cache-budget", (guint64) PIXELS * 16 + 1024,
+                NULL);
+
+  for (i = 0; i < 4; i++)
+    {
+      gegl_cache_policy_record (cheap, PIXELS, 1, FALSE);
+      gegl_cache_policy_record (reused, PIXELS, PIXELS * 2, FALSE);
+      gegl_cache_policy_record (reused, PIXELS, 0, TRUE);
+      gegl_cache_policy_record (unreused, PIXELS, PIXELS * 2, FALSE);
+    }
+
+  /* left over from a traversal where it was an intermediate node */
+  requested->auto_dont_cache = TRUE;
+
+  gegl_cache_policy_update (dfs_path, GEGL_RECTANGLE (0, 0, SIZE, SIZE));
+
+  CHECK (cheap->auto_dont_cache,
+         "node cheaper to recompute than to cache kept its cache");
+  CHECK (!reused->auto_dont_cache,
+         "expensive reused node lost its cache");
+  CHECK (unreused->auto_dont_cache,
+         "unreused node kept its cache beyond the budget");
+  CHECK (!requested->auto_dont_cache,
+         "requested node did not get its cache back");
+
+ abort:
+  g_object_set (gegl_config (), "cache-budget", (guint64) 0, NULL);
+  g_list_free (dfs_path);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,146 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-cache.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-cache-valid: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static gint
+missing_area (GeglCache           *cache,
+              const GeglRectangle *rect)
+{
+  GeglRectangle *rectangles;
+  gint           n_rectangles;
+  gint           i;
+  gint           sum = 0;
+
+  gegl_cache_get_missing (cache, rect, 0, &rectangles, &n_rectangles);
+
+  for (i = 0; i < n_rectangles; i++)
+    {
+      if (gegl_cache_is_valid (cache, &rectangles[i], 0))
+        sum = -1;
+      if (sum >= 0)
+        sum += rectangles[i].width * rectangles[i].height;
+    }
+  g_free (rectangles);
+
+  return sum;
+}
+
+int main(int argc, char *argv[])
+{
+  gint           result = SUCCESS;
+  GeglCache     *cache;
+  GeglRectangle *rectangles;
+  gint           n_rectangles;
+  GeglRectangle  infinite = gegl_rectangle_infinite_plane ();
+  gint           i;
+
+  gegl_init (&argc, &argv);
+
+  cache = g_object_new (GEGL_TYPE_CACHE,
+                        "format",      babl_format ("RGBA float"),
+                        "tile-width",  128,
+                        "tile-height", 64,
+                        NULL);
+
+  /* chunks not aligned with the tiles */
+  gegl_cache_computed (cache, GEGL_RECTANGLE (0, 0, 100, 100), 0);
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 100, 100), 0),
+         "computed rectangle not valid");
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 101, 100), 0),
+         "rectangle beyond computed area valid");
+
+  gegl_cache_computed (cache, GEGL_RECTANGLE (100, 0, 156, 100), 0);
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 256, 100), 0),
+         "adjacent chunks do not add up");
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 1, 101), 0),
+         "rectangle below computed area valid");
+
+  /* partially computed tiles are reported missing as a whole, with the
+   * 128×64 tiles used here that is everything below y = 64
+   */
+  CHECK (missing_area (cache, GEGL_RECTANGLE (0, 0, 256, 256)) == 256 * 192,
+         "wrong missing rectangles");
+
+  /* invalidation keeps what is around the invalidated rectangle */
+  gegl_cache_invalidate (cache, GEGL_RECTANGLE (8, 8, 8, 8));
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (8, 8, 1, 1), 0),
+         "invalidated pixel still valid");
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 8, 8), 0),
+         "pixels next to invalidated area lost");
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (200, 50, 10, 10), 0),
+         "pixels far from invalidated area lost");
+
+  /* computing what is reported missing makes everything valid */
+  gegl_cache_get_missing (cache, GEGL_RECTANGLE (0, 0, 256, 256), 0,
+                          &rectangles, &n_rectangles);
+  for (i = 0; i < n_rectangles; i++)
+    gegl_cache_computed (cache, &rectangles[i], 0);
+  g_free (rectangles);
+
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 256, 256), 0),
+         "missing rectangles did not cover the request");
+  CHECK (missing_area (cache, GEGL_RECTANGLE (0, 0, 256, 256)) == 0,
+         "missing rectangles left after computing them");
+
+  gegl_cache_computed (cache, GEGL_RECTANGLE (-128, -64, 128, 64), 0);
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (-128, -64, 128, 64), 0),
+         "tile at negative coordinates not valid");
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (-129, -64, 1, 1), 0),
+         "tile next to a computed negative tile valid");
+
+  /* nothing outside the extent of the cache is valid, not even what was
+   * computed before the extent shrunk
+   */
+  gegl_buffer_set_extent (GEGL_BUFFER (cache), GEGL_RECTANGLE (0, 0, 256, 256));
+  CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 256, 256), 0),
+         "whole extent not valid after computing it");
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 257, 256), 0),
+         "rectangle reaching outside the extent valid");
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (-128, -64, 128, 64), 0),
+         "computed tile outside the extent valid");
+  CHECK (!gegl_cache_is_valid (cache, &infinite, 0),
+         "infinite rectangle valid");
+
+  /* missing rectangles are only looked for within the extent */
+  CHECK (missing_area (cache, &infinite) == 0,
+         "missing rectangles outside the extent");
+  CHECK (missing_area (cache, GEGL_RECTANGLE (-100, -100, 300, 300)) == 0,
+         "missing rectangles at negative coordinates outside the extent");
+
+  gegl_cache_invalidate (cache, NULL);
+  CHECK (!gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, 1, 1), 0),
+         "cache valid after full invalidation");
+
+ abort:
+  g_object_unref (cache);
+  gegl_exit ();
+
+  return result;
+}
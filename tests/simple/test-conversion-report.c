@@ -0,0 +1,95 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-conversion-report: %s\n", msg); \
+      if (report) \
+        g_printerr ("%s", report); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint                result = SUCCESS;
+  GeglBuffer         *buffer;
+  GeglBufferIterator *iter;
+  gchar              *report = NULL;
+  guchar             *pixels;
+
+  gegl_init (&argc, &argv);
+
+  pixels = g_new0 (guchar, 256 * 256 * 4);
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, 256, 256),
+                            babl_format ("RGBA float"));
+
+  /* nothing is accounted unless asked for */
+  gegl_stats_reset_conversions ();
+  gegl_buffer_get (buffer, NULL, 1.0, babl_format ("R'G'B'A u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  report = gegl_stats_get_conversion_report (0);
+  CHECK (! strstr (report, "R'G'B'A u8"),
+         "conversion accounted with tracking disabled");
+  g_clear_pointer (&report, g_free);
+
+  gegl_stats_set_conversion_tracking (TRUE);
+
+  gegl_buffer_get (buffer, NULL, 1.0, babl_format ("R'G'B'A u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  gegl_buffer_set (buffer, NULL, 0, babl_format ("R'G'B'A u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  iter = gegl_buffer_iterator_new (buffer, NULL, 0, babl_format ("Y float"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+  while (gegl_buffer_iterator_next (iter));
+
+  gegl_stats_set_conversion_tracking (FALSE);
+
+  report = gegl_stats_get_conversion_report (0);
+  CHECK (strstr (report, "get       RGBA float -> R'G'B'A u8"),
+         "gegl_buffer_get conversion missing");
+  CHECK (strstr (report, "set       R'G'B'A u8 -> RGBA float"),
+         "gegl_buffer_set conversion missing");
+  CHECK (strstr (report, "iterator  RGBA float -> Y float"),
+         "iterator conversion missing");
+  g_clear_pointer (&report, g_free);
+
+  report = gegl_stats_get_conversion_report (1);
+  CHECK (strstr (report, "2 more"), "report not limited to one entry");
+  g_clear_pointer (&report, g_free);
+
+  gegl_stats_reset_conversions ();
+  report = gegl_stats_get_conversion_report (0);
+  CHECK (! strstr (report, "RGBA float ->"), "conversions not reset");
+
+ abort:
+  g_free (report);
+  g_object_unref (buffer);
+  g_free (pixels);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gegl.h"
+#include "gegl-disk-cache.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-disk-cache-key: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static GeglNode *
+make_graph (GeglNode    *parent,
+            const gchar *color,
+            gdouble      x)
+{
+  GeglNode  *source;
+  GeglNode  *translate;
+  GeglColor *c = gegl_color_new (color);
+
+  source = gegl_node_new_child (parent,
+                                "operation", "gegl:color",
+                                "value",     c,
+                                NULL);
+  translate = gegl_node_new_child (parent,
+                                   "operation", "gegl:translate",
+                                   "x",         x,
+                                   NULL);
+  gegl_node_link (source, translate);
+  g_object_unref (c);
+
+  return translate;
+}
+
+int main(int argc, char *argv[])
+{
+  gint        result = SUCCESS;
+  const Babl *format;
+  GeglNode   *graph;
+  GeglNode   *a, *b, *c, *source;
+  GeglBuffer *buffer;
+  GeglColor  *blue;
+  gchar      *key_a = NULL;
+  gchar      *key_b = NULL;
+  gchar      *key_c = NULL;
+  gchar      *key   = NULL;
+
+  gegl_init (&argc, &argv);
+
+  format = babl_format ("RGBA float");
+  graph  = gegl_node_new ();
+
+  /* separately built but identical graphs share a key */
+  a = make_graph (graph, "red", 10.0);
+  b = make_graph (graph, "red", 10.0);
+  c = make_graph (graph, "red", 10.5);
+
+  key_a = gegl_disk_cache_get_key (a, format);
+  key_b = gegl_disk_cache_get_key (b, format);
+  key_c = gegl_disk_cache_get_key (c, format);
+
+  CHECK (key_a && key_b && key_c, "graph without a key");
+  CHECK (!strcmp (key_a, key_b), "identical graphs have different keys");
+  CHECK (strcmp (key_a, key_c), "different properties have the same key");
+
+  /* the key follows changes upstream */
+  blue = gegl_color_new ("blue");
+  gegl_node_set (gegl_node_get_producer (b, "input", NULL),
+                 "value", blue, NULL);
+  g_object_unref (blue);
+  g_free (key_b);
+  key_b = gegl_disk_cache_get_key (b, format);
+  CHECK (strcmp (key_a, key_b), "upstream change does not change the key");
+
+  key = gegl_disk_cache_get_key (a, babl_format ("R'G'B'A u8"));
+  CHECK (strcmp (key_a, key), "different formats have the same key");
+  g_free (key);
+
+  /* buffers have no identity that survives the process */
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, 10, 10), format);
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:buffer-source",
+                                "buffer",    buffer,
+                                NULL);
+  key = gegl_disk_cache_get_key (source, format);
+  CHECK (key == NULL, "buffer source has a key");
+  g_object_unref (buffer);
+
+ abort:
+  g_free (key_a);
+  g_free (key_b);
+  g_free (key_c);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,304 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <utime.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+#include "gegl-node-private.h"
+#include "gegl-disk-cache.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-disk-cache: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+#define SIZE 64
+
+static GeglNode *
+make_graph (GeglNode *graph)
+{
+  GeglNode  *source;
+  GeglNode  *crop;
+  GeglColor *red = gegl_color_new ("red");
+
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:color",
+                                "value",     red,
+                                NULL);
+  crop = gegl_node_new_child (graph,
+                              "operation", "gegl:crop",
+                              "width",     (gdouble) SIZE,
+                              "height",    (gdouble) SIZE,
+                              NULL);
+  gegl_node_link (source, crop);
+  g_object_unref (red);
+
+  return crop;
+}
+
+/* one process using the disk cache in @dirname, "render" fills the cache
+ * of the graph, "reuse" expects to find it filled by an earlier process
+ */
+static gint
+child (const gchar *mode,
+       const gchar *dirname)
+{
+  gint        result = SUCCESS;
+  const Babl *format;
+  GeglNode   *graph;
+  GeglNode   *crop;
+  GeglCache  *cache;
+  gfloat      pixel[4];
+
+  gegl_init (NULL, NULL);
+  g_object_set (gegl_config (), "disk-cache", dirname, NULL);
+
+  format = babl_format ("RGBA float");
+  graph  = gegl_node_new ();
+  crop   = make_graph (graph);
+
+  if (!strcmp (mode, "render"))
+    {
+      gegl_node_blit (crop, 1.0, GEGL_RECTANGLE (0, 0, SIZE, SIZE), format,
+                      NULL, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_CACHE);
+
+      cache = crop->cache;
+      CHECK (cache && cache->valid_path, "node cache not on disk");
+    }
+  else
+    {
+      gegl_node_get_bounding_box (crop);
+
+      cache = gegl_node_get_cache (crop);
+      CHECK (cache && cache->valid_path, "node cache not on disk");
+      CHECK (gegl_cache_is_valid (cache, GEGL_RECTANGLE (0, 0, SIZE, SIZE), 0),
+             "rendering of an earlier process not reused");
+
+      gegl_buffer_get (GEGL_BUFFER (cache), GEGL_RECTANGLE (SIZE / 2, SIZE / 2, 1, 1),
+                       1.0, format, pixel, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      CHECK (pixel[0] > 0.9 && pixel[1] < 0.1 && pixel[3] > 0.9,
+             "reused cache holds the wrong pixels");
+    }
+
+ abort:
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
+
+static gboolean
+run_child (const gchar *self,
+           const gchar *mode,
+           const gchar *dirname)
+{
+  gchar *argv[] = { (gchar *) self, (gchar *) mode, (gchar *) dirname, NULL };
+  gint   status;
+
+  if (!g_spawn_sync (NULL, argv, NULL, G_SPAWN_CHILD_INHERITS_STDIN,
+                     NULL, NULL, NULL, NULL, &status, NULL))
+    return FALSE;
+
+  return g_spawn_check_exit_status (status, NULL);
+}
+
+/* the base path of the only entry in @dirname, or NULL */
+static gchar *
+find_entry (const gchar *dirname)
+{
+  GDir        *dir  = g_dir_open (dirname, 0, NULL);
+  const gchar *name;
+  gchar       *base = NULL;
+  gint         n    = 0;
+
+  if (!dir)
+    return NULL;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      if (!g_str_has_suffix (name, ".gegl"))
+        continue;
+
+      g_free (base);
+      base = g_build_filename (dirname, name, NULL);
+      base[strlen (base) - strlen (".gegl")] = '\0';
+      n++;
+    }
+  g_dir_close (dir);
+
+  if (n != 1)
+    {
+      g_free (base);
+      base = NULL;
+    }
+
+  return base;
+}
+
+static gboolean
+entry_file_exists (const gchar *base,
+                   const gchar *suffix)
+{
+  gchar    *path   = g_strconcat (base, suffix, NULL);
+  gboolean  exists = g_file_test (path, G_FILE_TEST_EXISTS);
+
+  g_free (path);
+
+  return exists;
+}
+
+/* a fake entry of @size bytes last used @age seconds ago */
+static gchar *
+make_entry (const gchar *dirname,
+            const gchar *name,
+            gsize        size,
+            gint         age)
+{
+  gchar          *base     = g_build_filename (dirname, name, NULL);
+  gchar          *contents = g_malloc0 (size);
+  struct utimbuf  times;
+  const gchar    *suffixes[] = { ".gegl", ".valid" };
+  guint           i;
+
+  times.actime = times.modtime = time (NULL) - age;
+
+  for (i = 0; i < G_N_ELEMENTS (suffixes); i++)
+    {
+      gchar *path = g_strconcat (base, suffixes[i], NULL);
+
+      g_file_set_contents (path, contents, size / 2, NULL);
+      g_utime (path, &times);
+      g_free (path);
+    }
+  g_free (contents);
+
+  return base;
+}
+
+static void
+remove_dir (const gchar *dirname)
+{
+  GDir        *dir = g_dir_open (dirname, 0, NULL);
+  const gchar *name;
+
+  if (!dir)
+    return;
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      gchar *path = g_build_filename (dirname, name, NULL);
+
+      g_unlink (path);
+      g_free (path);
+    }
+  g_dir_close (dir);
+
+  g_rmdir (dirname);
+}
+
+int main(int argc, char *argv[])
+{
+  gint      result  = SUCCESS;
+  gchar    *dirname = NULL;
+  gchar    *base    = NULL;
+  gchar    *old     = NULL;
+  gchar    *locked  = NULL;
+  gchar    *path    = NULL;
+  gchar    *pid;
+  GStatBuf  st;
+  guint64   size;
+
+  if (argc == 3)
+    return child (argv[1], argv[2]);
+
+  gegl_init (&argc, &argv);
+
+  dirname = g_dir_make_tmp ("gegl-disk-cache-XXXXXX", NULL);
+  CHECK (dirname, "failed to create a disk cache directory");
+
+  /* an entry is saved with its valid rectangles when the process exits,
+   * and a later process building the same graph picks it up
+   */
+  CHECK (run_child (argv[0], "render", dirname), "rendering process failed");
+
+  base = find_entry (dirname);
+  CHECK (base, "no disk cache entry after rendering");
+  CHECK (entry_file_exists (base, ".valid"), "valid rectangles not saved");
+  CHECK (!entry_file_exists (base, ".lock"), "lock left behind");
+
+  CHECK (run_child (argv[0], "reuse", dirname), "reusing process failed");
+  CHECK (entry_file_exists (base, ".valid"), "valid rectangles lost on reuse");
+  CHECK (!entry_file_exists (base, ".lock"), "lock left behind on reuse");
+
+  /* trimming removes the least recently used entries first, but not those
+   * locked by a running process
+   */
+  g_object_set (gegl_config (), "disk-cache", dirname, NULL);
+
+  size = 0;
+  path = g_strconcat (base, ".gegl", NULL);
+  if (g_stat (path, &st) == 0)
+    size += st.st_size;
+  g_free (path);
+  path = g_strconcat (base, ".valid", NULL);
+  if (g_stat (path, &st) == 0)
+    size += st.st_size;
+  g_free (path);
+
+  locked = make_entry (dirname, "locked", 1024, 2000);
+  old    = make_entry (dirname, "old",    1024, 1000);
+
+  path = g_strconcat (locked, ".lock", NULL);
+  pid  = g_strdup_printf ("%i\n", (gint) getpid ());
+  g_file_set_contents (path, pid, -1, NULL);
+  g_free (pid);
+  g_free (path);
+  path = NULL;
+
+  gegl_disk_cache_trim (size + 1024);
+
+  CHECK (!entry_file_exists (old, ".gegl") && !entry_file_exists (old, ".valid"),
+         "least recently used entry not removed");
+  CHECK (!entry_file_exists (old, ".lock"), "lock of a removed entry left behind");
+  CHECK (entry_file_exists (locked, ".gegl") && entry_file_exists (locked, ".valid"),
+         "entry in use removed");
+  CHECK (entry_file_exists (base, ".gegl") && entry_file_exists (base, ".valid"),
+         "recently used entry removed");
+
+ abort:
+  if (dirname)
+    remove_dir (dirname);
+  g_free (dirname);
+  g_free (base);
+  g_free (old);
+  g_free (locked);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gegl.h"
+#include "gegl-dot.h"
+#include "gegl-node-private.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-dot-profile: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint      result = SUCCESS;
+  GeglNode *graph, *source, *blur;
+  gchar    *plain   = NULL;
+  gchar    *profile = NULL;
+
+  gegl_init (&argc, &argv);
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:checkerboard",
+                                NULL);
+  blur   = gegl_node_new_child (graph,
+                                "operation", "gegl:box-blur",
+                                "radius",    8,
+                                NULL);
+  gegl_node_link (source, blur);
+
+  /* nothing is recorded unless asked for */
+  gegl_node_blit (blur, 1.0, GEGL_RECTANGLE (0, 0, 16, 16),
+                  babl_format ("RGBA float"), NULL,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_STREAM);
+  CHECK (blur->profile.requests == 0, "rendering profiled while disabled");
+
+  gegl_dot_set_profiling (TRUE);
+
+  gegl_node_blit (blur, 1.0, GEGL_RECTANGLE (0, 0, 256, 256),
+                  babl_format ("RGBA float"), NULL,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  CHECK (blur->profile.pixels == 256 * 256,
+         "pixels computed by the blur not recorded");
+  CHECK (blur->profile.peak_bytes >= 256 * 256 * 4 * sizeof (gfloat),
+         "peak output of the blur not recorded");
+  CHECK (source->profile.pixels > blur->profile.pixels,
+         "pixels computed by the source not recorded");
+
+  plain   = gegl_to_dot (graph);
+  profile = gegl_to_dot_profile (graph);
+
+  CHECK (!strstr (plain, "Mpx/s"), "plain graph annotated");
+  CHECK (strstr (profile, "Mpx/s") && strstr (profile, "cache hits="),
+         "profile graph not annotated");
+  /* the most expensive node is drawn in full red */
+  CHECK (strstr (profile, "fillcolor=\"#ff0000\""),
+         "no node heat coloured");
+
+ abort:
+  g_free (plain);
+  g_free (profile);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,168 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gegl.h"
+#include "gegl-types-internal.h"
+#include "gegl-operation.h"
+#include "gegl-graph-traversal.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-format-negotiation: %s\n", msg); \
+      if (report) \
+        g_printerr ("%s", report); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+#define SIZE 64
+
+/* a red square in RGBA float */
+static GeglNode *
+new_source (GeglNode *graph)
+{
+  GeglColor *red = gegl_color_new ("red");
+  GeglNode  *color;
+  GeglNode  *crop;
+
+  color = gegl_node_new_child (graph,
+                               "operation", "gegl:color",
+                               "value",     red,
+                               NULL);
+  crop  = gegl_node_new_child (graph,
+                               "operation", "gegl:crop",
+                               "width",     (gdouble) SIZE,
+                               "height",    (gdouble) SIZE,
+                               NULL);
+  gegl_node_link (color, crop);
+  g_object_unref (red);
+
+  return crop;
+}
+
+static GeglNode *
+new_temperature (GeglNode *graph)
+{
+  return gegl_node_new_child (graph,
+                              "operation",            "gegl:color-temperature",
+                              "intended-temperature", 12000.0,
+                              NULL);
+}
+
+/* the conversions avoided by negotiating the formats of the graph ending
+ * in @node, and the output format of @temperature it settles on
+ */
+static gint
+conversions_removed (GeglNode    *node,
+                     GeglNode    *temperature,
+                     const Babl **format)
+{
+  GeglGraphTraversal *path = gegl_graph_build (node);
+  gint                removed;
+
+  gegl_graph_prepare (path);
+  removed = gegl_graph_get_conversions_removed (path);
+  gegl_graph_free (path);
+
+  *format = gegl_operation_get_format (gegl_node_get_gegl_operation (temperature),
+                                       "output");
+
+  return removed;
+}
+
+int main(int argc, char *argv[])
+{
+  gint        result  = SUCCESS;
+  gchar      *report  = NULL;
+  gfloat     *pixels  = NULL;
+  const Babl *rgba    = NULL;
+  const Babl *ragabaa = NULL;
+  const Babl *format;
+  GeglNode   *graph;
+  GeglNode   *source, *temperature, *sink, *before, *after;
+
+  gegl_init (&argc, &argv);
+
+  rgba    = babl_format ("RGBA float");
+  ragabaa = babl_format ("RaGaBaA float");
+  graph   = gegl_node_new ();
+
+  /* between RGBA float producers and consumers there is nothing to
+   * negotiate
+   */
+  source      = new_source (graph);
+  temperature = new_temperature (graph);
+  sink        = gegl_node_new_child (graph,
+                                     "operation", "gegl:crop",
+                                     "width",     (gdouble) SIZE,
+                                     "height",    (gdouble) SIZE,
+                                     NULL);
+  gegl_node_link_many (source, temperature, sink, NULL);
+
+  CHECK (conversions_removed (sink, temperature, &format) == 0,
+         "conversions changed in an RGBA float graph");
+  CHECK (format == rgba, "RGBA float graph not left in RGBA float");
+
+  /* between premultiplied producers and consumers, color-temperature
+   * follows its source and both conversions around it go away, the one
+   * from the RGBA float source into the first blur stays
+   */
+  source      = new_source (graph);
+  before      = gegl_node_new_child (graph,
+                                     "operation", "gegl:box-blur",
+                                     "radius",    2,
+                                     NULL);
+  temperature = new_temperature (graph);
+  after       = gegl_node_new_child (graph,
+                                     "operation", "gegl:box-blur",
+                                     "radius",    2,
+                                     NULL);
+  gegl_node_link_many (source, before, temperature, after, NULL);
+
+  CHECK (conversions_removed (after, temperature, &format) == 2,
+         "conversions around color-temperature not removed");
+  CHECK (format == ragabaa, "color-temperature not switched to premultiplied");
+
+  /* rendering the graph no longer converts to and from the format
+   * color-temperature asked for in prepare
+   */
+  pixels = g_new (gfloat, SIZE * SIZE * 4);
+
+  gegl_stats_reset_conversions ();
+  gegl_stats_set_conversion_tracking (TRUE);
+  gegl_node_blit (after, 1.0, GEGL_RECTANGLE (0, 0, SIZE, SIZE), ragabaa,
+                  pixels, GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  gegl_stats_set_conversion_tracking (FALSE);
+
+  report = gegl_stats_get_conversion_report (0);
+  CHECK (! strstr (report, "RaGaBaA float -> RGBA float"),
+         "premultiplied pixels converted for color-temperature");
+
+ abort:
+  g_free (report);
+  g_free (pixels);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
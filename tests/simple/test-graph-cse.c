@@ -0,0 +1,166 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-graph-traversal.h"
+#include "gegl-graph-traversal-private.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-graph-cse: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint                result = SUCCESS;
+  GeglGraphTraversal *path   = NULL;
+  GeglBuffer         *buffer = NULL;
+  GeglColor          *red;
+  GeglNode           *graph, *color, *crop, *a, *b, *c, *over;
+  GeglNode           *wide, *near, *far, *shift, *root;
+  gfloat              pixel[4];
+
+  gegl_init (&argc, &argv);
+
+  graph = gegl_node_new ();
+  red   = gegl_color_new ("rgb(1.0, 0.0, 0.0)");
+
+  color = gegl_node_new_child (graph,
+                               "operation", "gegl:color",
+                               "value",     red,
+                               NULL);
+  crop  = gegl_node_new_child (graph,
+                               "operation", "gegl:crop",
+                               "width",     10.0,
+                               "height",    10.0,
+                               NULL);
+  a     = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         5.0,
+                               NULL);
+  b     = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         5.0,
+                               NULL);
+  c     = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         6.0,
+                               NULL);
+  over  = gegl_node_new_child (graph,
+                               "operation", "gegl:over",
+                               NULL);
+  g_object_unref (red);
+
+  /* the same translation of the same input is computed twice */
+  gegl_node_link_many (color, crop, a, over, NULL);
+  gegl_node_link (crop, b);
+  gegl_node_connect_to (b, "output", over, "aux");
+
+  path = gegl_graph_build (over);
+
+  CHECK (g_hash_table_size (path->duplicates) == 1,
+         "identical nodes not merged");
+  CHECK (g_hash_table_lookup (path->duplicates, b) == a ||
+         g_hash_table_lookup (path->duplicates, a) == b,
+         "wrong nodes merged");
+
+  /* the consumer of the merged node still gets its input */
+  gegl_graph_prepare (path);
+  gegl_graph_prepare_request (path, GEGL_RECTANGLE (0, 0, 20, 10), 0);
+  buffer = gegl_graph_process (path, 0);
+
+  CHECK (buffer, "no result");
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (7, 5, 1, 1), 1.0,
+                   babl_format ("RGBA float"), pixel,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  CHECK (pixel[0] == 1.0 && pixel[3] == 1.0, "wrong result");
+
+  gegl_graph_free (path);
+  path = NULL;
+
+  /* different properties are not merged */
+  gegl_node_connect_to (c, "output", over, "aux");
+  gegl_node_link (crop, c);
+
+  path = gegl_graph_build (over);
+  CHECK (g_hash_table_size (path->duplicates) == 0,
+         "nodes with different properties merged");
+
+  gegl_graph_free (path);
+  path = NULL;
+  g_clear_object (&buffer);
+
+  /* duplicates at different depths, whichever is kept it has to cover
+   * what the consumers of both need, the shifted one needs more
+   */
+  wide  = gegl_node_new_child (graph,
+                               "operation", "gegl:crop",
+                               "width",     20.0,
+                               "height",    10.0,
+                               NULL);
+  near  = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         5.0,
+                               NULL);
+  far   = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         5.0,
+                               NULL);
+  shift = gegl_node_new_child (graph,
+                               "operation", "gegl:translate",
+                               "x",         -10.0,
+                               NULL);
+  root  = gegl_node_new_child (graph,
+                               "operation", "gegl:over",
+                               NULL);
+
+  gegl_node_link_many (color, wide, far, shift, root, NULL);
+  gegl_node_link (wide, near);
+  gegl_node_connect_to (near, "output", root, "aux");
+
+  path = gegl_graph_build (root);
+
+  CHECK (g_hash_table_size (path->duplicates) == 1,
+         "duplicates at different depths not merged");
+
+  gegl_graph_prepare (path);
+  gegl_graph_prepare_request (path, GEGL_RECTANGLE (0, 0, 10, 10), 0);
+  buffer = gegl_graph_process (path, 0);
+
+  CHECK (buffer, "no result");
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (2, 5, 1, 1), 1.0,
+                   babl_format ("RGBA float"), pixel,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  CHECK (pixel[0] == 1.0 && pixel[3] == 1.0,
+         "area needed by the deeper consumer not computed");
+
+ abort:
+  if (buffer)
+    g_object_unref (buffer);
+  if (path)
+    gegl_graph_free (path);
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
@@ -0,0 +1,109 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-memory-report: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint              result = SUCCESS;
+  GeglNode         *gegl, *source, *crop, *sink;
+  GeglColor        *color;
+  GeglBuffer       *output = NULL;
+  GeglProcessor    *processor = NULL;
+  GeglMemoryReport  report;
+  guint64           peak;
+  guchar           *pixels;
+
+  gegl_init (&argc, &argv);
+
+  pixels = g_new (guchar, 256 * 256);
+
+  color  = gegl_color_new ("red");
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl,
+                                "operation", "gegl:color",
+                                "value", color,
+                                NULL);
+  crop   = gegl_node_new_child (gegl,
+                                "operation", "gegl:crop",
+                                "width",  256.0,
+                                "height", 256.0,
+                                NULL);
+  sink   = gegl_node_new_child (gegl,
+                                "operation", "gegl:buffer-sink",
+                                "buffer", &output,
+                                "format", babl_format ("RGBA float"),
+                                NULL);
+  gegl_node_link_many (source, crop, sink, NULL);
+
+  gegl_node_get_memory_report (crop, &report);
+  CHECK (report.peak_tile_bytes == 0 && report.buffers_created == 0,
+         "report of an unrendered node not empty");
+
+  /* rendering to another format than the node's own converts */
+  gegl_node_blit (crop, 1.0, GEGL_RECTANGLE (0, 0, 256, 256),
+                  babl_format ("Y u8"), pixels,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  gegl_node_get_memory_report (crop, &report);
+  CHECK (report.buffers_created > 0, "blit buffers not counted");
+  CHECK (report.peak_tile_bytes > 0, "blit tile bytes not counted");
+  CHECK (report.conversion_bytes >= 256 * 256, "blit conversion not counted");
+
+  processor = gegl_node_new_processor (sink, NULL);
+  while (gegl_processor_work (processor, NULL));
+
+  gegl_processor_get_memory_report (processor, &report);
+  CHECK (output != NULL, "nothing processed");
+  CHECK (report.peak_tile_bytes >= 256 * 256 * 16,
+         "peak below the size of the output");
+  CHECK (report.tile_allocations > 0, "processor tile allocations not counted");
+
+  /* the blits the processor makes do not reset the process wide peak */
+  g_object_get (gegl_stats (), "tile-bytes-peak", &peak, NULL);
+  CHECK (peak >= report.peak_tile_bytes,
+         "tile-bytes-peak below the peak of a report");
+
+  g_clear_object (&processor);
+  g_clear_object (&output);
+
+  gegl_node_process (sink);
+
+  gegl_node_get_memory_report (sink, &report);
+  CHECK (report.buffers_created > 0, "process buffers not counted");
+
+ abort:
+  g_clear_object (&processor);
+  g_clear_object (&output);
+  g_object_unref (gegl);
+  g_object_unref (color);
+  g_free (pixels);
+  gegl_exit ();
+
+  return result;
+}
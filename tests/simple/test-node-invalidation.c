@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-node-invalidation: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static gint n_invalidated;
+
+static void
+invalidated (GeglNode            *node,
+             const GeglRectangle *rect,
+             gpointer             data)
+{
+  GeglRectangle *last = data;
+
+  n_invalidated++;
+  *last = *rect;
+}
+
+int main(int argc, char *argv[])
+{
+  gint       result = SUCCESS;
+  GeglNode  *graph, *color, *crop, *translate, *view, *out;
+  GeglNode  *blue_color, *invert;
+  GeglColor *red, *blue;
+  GeglRectangle last;
+  guchar     before[4], after[4];
+
+  gegl_init (&argc, &argv);
+
+  graph = gegl_node_new ();
+  red   = gegl_color_new ("red");
+
+  color     = gegl_node_new_child (graph,
+                                   "operation", "gegl:color",
+                                   "value",     red,
+                                   NULL);
+  crop      = gegl_node_new_child (graph,
+                                   "operation", "gegl:crop",
+                                   "x",         50.0,
+                                   "y",         50.0,
+                                   "width",     10.0,
+                                   "height",    10.0,
+                                   NULL);
+  translate = gegl_node_new_child (graph,
+                                   "operation", "gegl:translate",
+                                   NULL);
+  view      = gegl_node_new_child (graph,
+                                   "operation", "gegl:crop",
+                                   "width",     40.0,
+                                   "height",    40.0,
+                                   NULL);
+  out       = gegl_node_new_child (graph,
+                                   "operation", "gegl:nop",
+                                   NULL);
+  g_object_unref (red);
+
+  gegl_node_link_many (color, crop, translate, view, out, NULL);
+  gegl_node_get_bounding_box (out);
+
+  g_signal_connect (out, "invalidated", G_CALLBACK (invalidated), &last);
+
+  /* setting a property to its current value is not a change */
+  gegl_node_set (crop, "width", 10.0, NULL);
+  gegl_node_set (translate, "x", 0.0, NULL);
+  red = gegl_color_new ("red");
+  gegl_node_set (color, "value", red, NULL);
+  g_object_unref (red);
+  CHECK (n_invalidated == 0, "setting current values invalidated");
+
+  /* changes outside of a crop do not propagate past it */
+  gegl_node_set (translate, "x", 5.0, NULL);
+  CHECK (n_invalidated == 0, "change outside of the view propagated");
+
+  gegl_node_set (translate, "x", -30.0, "y", -30.0, NULL);
+  CHECK (n_invalidated > 0, "change inside of the view did not propagate");
+
+  /* growing the crop only invalidates the added strip */
+  gegl_node_get_bounding_box (out);
+  g_signal_handlers_disconnect_by_func (out, invalidated, &last);
+  g_signal_connect (crop, "invalidated", G_CALLBACK (invalidated), &last);
+  n_invalidated = 0;
+
+  gegl_node_set (crop, "width", 15.0, NULL);
+  CHECK (n_invalidated == 1, "growing a crop did not invalidate it");
+  CHECK (gegl_rectangle_equal (&last, GEGL_RECTANGLE (60, 50, 5, 10)),
+         "growing a crop invalidated more than the added strip");
+
+  /* linking nodes that were never prepared, with an empty have rect,
+   * still reaches the root and changes what is rendered
+   */
+  g_signal_handlers_disconnect_by_func (crop, invalidated, &last);
+  gegl_node_link_many (color, out, NULL);
+  gegl_node_blit (out, 1.0, GEGL_RECTANGLE (0, 0, 1, 1),
+                  babl_format ("R'G'B'A u8"), before,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  blue       = gegl_color_new ("blue");
+  blue_color = gegl_node_new_child (graph,
+                                    "operation", "gegl:color",
+                                    "value",     blue,
+                                    NULL);
+  g_object_unref (blue);
+  gegl_node_link (blue_color, out);
+  gegl_node_blit (out, 1.0, GEGL_RECTANGLE (0, 0, 1, 1),
+                  babl_format ("R'G'B'A u8"), after,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  CHECK (before[0] == 255 && before[2] == 0, "red not rendered");
+  CHECK (after[0] == 0 && after[2] == 255,
+         "linking a new source did not change the output");
+
+  invert = gegl_node_new_child (graph,
+                                "operation", "gegl:invert-linear",
+                                NULL);
+  gegl_node_link_many (blue_color, invert, out, NULL);
+  gegl_node_blit (out, 1.0, GEGL_RECTANGLE (0, 0, 1, 1),
+                  babl_format ("R'G'B'A u8"), after,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+  CHECK (after[0] == 255 && after[2] == 0,
+         "inserting a new node did not change the output");
+
+ abort:
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
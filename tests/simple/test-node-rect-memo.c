@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+#include "gegl-operation.h"
+#include "gegl-node-private.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-node-rect-memo: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint           result = SUCCESS;
+  GeglNode      *graph, *source, *blur, *translate;
+  GeglOperation *operation;
+  GeglRectangle  required;
+  GeglRectangle  shifted;
+  GeglRectangle  roi = {0, 0, 10, 10};
+
+  gegl_init (&argc, &argv);
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:checkerboard",
+                                NULL);
+  blur   = gegl_node_new_child (graph,
+                                "operation", "gegl:box-blur",
+                                "radius",    4,
+                                NULL);
+  gegl_node_link (source, blur);
+  gegl_node_get_bounding_box (blur);
+
+  operation = gegl_node_get_gegl_operation (blur);
+
+  required = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (gegl_rectangle_equal (&required, GEGL_RECTANGLE (-4, -4, 18, 18)),
+         "wrong required region");
+
+  /* asking again gives the same answer */
+  required = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (gegl_rectangle_equal (&required, GEGL_RECTANGLE (-4, -4, 18, 18)),
+         "wrong remembered required region");
+
+  /* and changing a property changes it */
+  gegl_node_set (blur, "radius", 8, NULL);
+  gegl_node_get_bounding_box (blur);
+
+  required = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (gegl_rectangle_equal (&required, GEGL_RECTANGLE (-8, -8, 26, 26)),
+         "required region not updated after a property change");
+
+  /* regions that are cheap to compute are not remembered */
+  CHECK (blur->rect_memo_count == 0, "box-blur regions remembered");
+
+  /* those of transforms are */
+  translate = gegl_node_new_child (graph,
+                                   "operation", "gegl:translate",
+                                   "x",         4.5,
+                                   NULL);
+  gegl_node_link (source, translate);
+  gegl_node_get_bounding_box (translate);
+
+  operation = gegl_node_get_gegl_operation (translate);
+
+  required = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (translate->rect_memo_count == 1, "transform regions not remembered");
+
+  shifted = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (gegl_rectangle_equal (&required, &shifted),
+         "wrong remembered transform region");
+  CHECK (translate->rect_memo_count == 1, "remembered region not used");
+
+  gegl_node_set (translate, "x", 8.5, NULL);
+  gegl_node_get_bounding_box (translate);
+
+  shifted = gegl_operation_get_required_for_output (operation, "input", &roi);
+  CHECK (shifted.x == required.x - 4 &&
+         shifted.y == required.y &&
+         shifted.width == required.width &&
+         shifted.height == required.height,
+         "transform region not updated after a property change");
+
+ abort:
+  g_object_unref (graph);
+  gegl_exit ();
+
+  return result;
+}
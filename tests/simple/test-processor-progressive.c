@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <string.h>
+#include <math.h>
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define FLOATS_EQUAL(x,y) (fabs((x) - (y)) < 0.00001f)
+
+int main(int argc, char *argv[])
+{
+  gint           result      = SUCCESS;
+  GeglRectangle  rect        = { 0, 0, 64, 64 };
+  GeglColor     *color       = NULL;
+  GeglNode      *gegl        = NULL;
+  GeglNode      *source      = NULL;
+  GeglNode      *crop        = NULL;
+  GeglProcessor *processor   = NULL;
+  gint           last_level;
+  gdouble        progress    = 0.0;
+  gdouble        last_progress = 0.0;
+  gfloat         pixel[4]    = { 0, };
+  gint           i;
+
+  gegl_init (&argc, &argv);
+
+  color  = gegl_color_new ("rgb(1.0, 1.0, 1.0)");
+  gegl   = gegl_node_new ();
+  source = gegl_node_new_child (gegl,
+                                "operation", "gegl:color",
+                                "value", color,
+                                NULL);
+  crop   = gegl_node_new_child (gegl,
+                                "operation", "gegl:crop",
+                                "x", 0.0,
+                                "y", 0.0,
+                                "width", 64.0,
+                                "height", 64.0,
+                                NULL);
+  gegl_node_link (source, crop);
+
+  processor = gegl_node_new_processor (crop, &rect);
+  gegl_processor_set_progressive (processor, 3);
+
+  if (gegl_processor_get_level (processor) != 3)
+    {
+      g_printerr ("test-processor-progressive: did not start at the coarsest level\n");
+      result = FAILURE;
+      goto abort;
+    }
+
+  last_level = gegl_processor_get_level (processor);
+
+  while (gegl_processor_work (processor, &progress))
+    {
+      gint level = gegl_processor_get_level (processor);
+
+      if (level > last_level)
+        {
+          g_printerr ("test-processor-progressive: level went from %i to %i\n",
+                      last_level, level);
+          result = FAILURE;
+          goto abort;
+        }
+      if (progress + 0.00001 < last_progress)
+        {
+          g_printerr ("test-processor-progressive: progress went backwards\n");
+          result = FAILURE;
+          goto abort;
+        }
+      last_level    = level;
+      last_progress = progress;
+    }
+
+  if (gegl_processor_get_level (processor) != 0)
+    {
+      g_printerr ("test-processor-progressive: refinement stopped at level %i\n",
+                  gegl_processor_get_level (processor));
+      result = FAILURE;
+      goto abort;
+    }
+
+  /* the full resolution result must now be in the cache */
+  gegl_node_blit (crop, 1.0, GEGL_RECTANGLE (32, 32, 1, 1),
+                  babl_format ("RGBA float"), pixel,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_CACHE | GEGL_BLIT_DIRTY);
+
+  for (i = 0; i < 4; i++)
+    if (!FLOATS_EQUAL (pixel[i], 1.0))
+      {
+        g_printerr ("test-processor-progressive: wrong pixel in cache\n");
+        result = FAILURE;
+        goto abort;
+      }
+
+ abort:
+  g_object_unref (processor);
+  g_object_unref (color);
+  g_object_unref (gegl);
+  gegl_exit ();
+
+  return result;
+}
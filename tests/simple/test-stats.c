@@ -0,0 +1,93 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-stats: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+static guint64
+stats_get (const gchar *name)
+{
+  guint64 value;
+
+  g_object_get (gegl_stats (), name, &value, NULL);
+
+  return value;
+}
+
+int main(int argc, char *argv[])
+{
+  gint                result = SUCCESS;
+  GeglBuffer         *buffer;
+  GeglColor          *color;
+  GeglBufferIterator *iter;
+  guint64             allocations, hits, zoom_tiles, indirect;
+  gdouble             hit_ratio;
+  guchar              pixels[64 * 64];
+
+  gegl_init (&argc, &argv);
+
+  allocations = stats_get ("tile-allocations");
+  hits        = stats_get ("tile-cache-hits");
+  zoom_tiles  = stats_get ("zoom-tiles");
+  indirect    = stats_get ("iterator-indirect");
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, 256, 256),
+                            babl_format ("RGBA float"));
+  color  = gegl_color_new ("red");
+  gegl_buffer_set_color (buffer, NULL, color);
+  g_object_unref (color);
+
+  CHECK (stats_get ("tile-allocations") > allocations, "tile allocations not counted");
+
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, 64, 64), 1.0,
+                   babl_format ("Y u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  CHECK (stats_get ("tile-cache-hits") > hits, "tile cache hits not counted");
+
+  g_object_get (gegl_stats (), "tile-cache-hit-ratio", &hit_ratio, NULL);
+  CHECK (hit_ratio > 0.0 && hit_ratio <= 1.0, "hit ratio out of range");
+
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, 64, 64), 0.5,
+                   babl_format ("Y u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  CHECK (stats_get ("zoom-tiles") > zoom_tiles, "mipmap tile generation not counted");
+
+  iter = gegl_buffer_iterator_new (buffer, GEGL_RECTANGLE (0, 0, 64, 64), 0,
+                                   babl_format ("Y u8"),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+  while (gegl_buffer_iterator_next (iter));
+
+  CHECK (stats_get ("iterator-indirect") > indirect, "indirect iteration not counted");
+
+ abort:
+  g_object_unref (buffer);
+  gegl_exit ();
+
+  return result;
+}
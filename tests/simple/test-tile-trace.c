@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+#include "gegl-tile-trace.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-tile-trace: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint                       result   = SUCCESS;
+  gchar                     *path     = NULL;
+  gchar                     *contents = NULL;
+  gsize                      length;
+  const GeglTileTraceHeader *header;
+  const GeglTileTraceRecord *records;
+  gsize                      n_records, i;
+  gint                       counts[GEGL_TILE_TRACE_VOID + 1] = { 0, };
+  gint                       hits     = 0;
+  GeglBuffer                *buffer;
+  GeglColor                 *color;
+  guchar                     pixels[64 * 64 * 4];
+  gint                       fd;
+
+  fd = g_file_open_tmp ("test-tile-trace-XXXXXX", &path, NULL);
+  g_close (fd, NULL);
+  g_setenv ("GEGL_TILE_TRACE", path, TRUE);
+
+  gegl_init (&argc, &argv);
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, 256, 256),
+                            babl_format ("RGBA u8"));
+  color  = gegl_color_new ("red");
+  gegl_buffer_set_color (buffer, NULL, color);
+  g_object_unref (color);
+
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, 64, 64), 1.0,
+                   babl_format ("RGBA u8"), pixels,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  g_object_unref (buffer);
+
+  /* the trace is complete once gegl is shut down */
+  gegl_exit ();
+
+  CHECK (g_file_get_contents (path, &contents, &length, NULL),
+         "trace not written");
+  CHECK (length >= sizeof (GeglTileTraceHeader), "trace header missing");
+
+  header = (const GeglTileTraceHeader *) contents;
+  CHECK (! memcmp (header->magic, GEGL_TILE_TRACE_MAGIC, sizeof (header->magic)),
+         "wrong magic");
+  CHECK (header->record_size == sizeof (GeglTileTraceRecord),
+         "wrong record size");
+
+  records   = (const GeglTileTraceRecord *) (header + 1);
+  n_records = (length - sizeof (GeglTileTraceHeader)) /
+              sizeof (GeglTileTraceRecord);
+
+  for (i = 0; i < n_records; i++)
+    {
+      CHECK (records[i].op <= GEGL_TILE_TRACE_VOID, "unknown operation");
+      CHECK (records[i].storage > 0, "record without storage");
+
+      counts[records[i].op]++;
+
+      if (records[i].op == GEGL_TILE_TRACE_GET)
+        hits += records[i].hit;
+    }
+
+  CHECK (counts[GEGL_TILE_TRACE_STORAGE] > 0, "storage not recorded");
+  CHECK (counts[GEGL_TILE_TRACE_GET] > 0, "tile fetches not recorded");
+  CHECK (counts[GEGL_TILE_TRACE_WRITE] > 0, "tile writes not recorded");
+  CHECK (hits > 0, "cache hits not recorded");
+
+ abort:
+  g_free (contents);
+  g_unlink (path);
+  g_free (path);
+
+  return result;
+}
@@ -0,0 +1,89 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include "gegl.h"
+
+#define SUCCESS  0
+#define FAILURE -1
+
+#define CHECK(cond, msg) \
+  if (!(cond)) \
+    { \
+      g_printerr ("test-trace: %s\n", msg); \
+      result = FAILURE; \
+      goto abort; \
+    }
+
+int main(int argc, char *argv[])
+{
+  gint       result   = SUCCESS;
+  gchar     *path     = NULL;
+  gchar     *contents = NULL;
+  GeglNode  *graph, *source, *blur;
+  guchar    *pixels;
+  gint       fd;
+
+  fd = g_file_open_tmp ("test-trace-XXXXXX.json", &path, NULL);
+  if (fd < 0)
+    return FAILURE;
+  g_close (fd, NULL);
+
+  g_setenv ("GEGL_TRACE", path, TRUE);
+
+  gegl_init (&argc, &argv);
+
+  pixels = g_malloc (64 * 64 * 4);
+
+  graph  = gegl_node_new ();
+  source = gegl_node_new_child (graph,
+                                "operation", "gegl:checkerboard",
+                                NULL);
+  blur   = gegl_node_new_child (graph,
+                                "operation", "gegl:box-blur",
+                                NULL);
+  gegl_node_link (source, blur);
+
+  gegl_node_blit (blur, 1.0, GEGL_RECTANGLE (0, 0, 64, 64),
+                  babl_format ("RGBA u8"), pixels,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  g_object_unref (graph);
+  g_free (pixels);
+
+  /* the trace is written out at exit */
+  gegl_exit ();
+
+  CHECK (g_file_get_contents (path, &contents, NULL, NULL),
+         "no trace written");
+  CHECK (g_str_has_prefix (contents, "{\"traceEvents\":["),
+         "trace is not in the trace event format");
+  CHECK (strstr (contents, "\"name\":\"gegl:box-blur\",\"cat\":\"process\""),
+         "processing of the blur not traced");
+  CHECK (strstr (contents, "\"width\":64,\"height\":64"),
+         "region of the processing not traced");
+
+ abort:
+  g_free (contents);
+  g_unlink (path);
+  g_free (path);
+
+  return result;
+}
@@ -0,0 +1,402 @@
+/* This file is part of GEGL
+ *
+ * GEGL is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * GEGL is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GEGL; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gegl-tile-trace.h"
+
+/* Replays a tile access trace recorded with GEGL_TILE_TRACE against
+ * simulated tile caches of different sizes and eviction policies:
+ *
+ *   gegl-tile-replay trace.bin [size ...]
+ *
+ * sizes are in bytes with an optional K, M or G suffix, by default the
+ * tile-cache-size the trace was recorded with is tried halved and
+ * doubled twice. Tiles written and then evicted are counted as written
+ * back to swap, fetching them again as read back from it.
+ */
+
+typedef enum
+{
+  POLICY_LRU,   /* what GeglTileHandlerCache does */
+  POLICY_FIFO,
+  POLICY_CLOCK
+} Policy;
+
+static const gchar *policy_names[] = { "lru", "fifo", "clock" };
+
+typedef struct
+{
+  guint32  storage;
+  gint32   x;
+  gint32   y;
+  gint32   z;
+} TileKey;
+
+typedef struct
+{
+  TileKey  key;
+  GList    link;
+  gsize    size;
+  gboolean dirty;
+  gboolean referenced;
+} Entry;
+
+#define LINK_GET_ENTRY(link) \
+        ((Entry *) ((guchar *) link - G_STRUCT_OFFSET (Entry, link)))
+
+typedef struct
+{
+  Policy      policy;
+  guint64     size;
+  guint64     total;
+  GQueue      queue;   /* most recently inserted or used first */
+  GHashTable *entries; /* TileKey -> Entry */
+  GHashTable *stored;  /* TileKeys written back to swap */
+
+  guint64     gets;
+  guint64     hits;
+  guint64     evictions;
+  guint64     writebacks;
+  guint64     swap_reads;
+} Simulation;
+
+static guint
+tile_key_hash (gconstpointer key)
+{
+  const TileKey *k = key;
+
+  return (k->x * 73856093u) ^ (k->y * 19349663u) ^
+         (k->z * 83492791u) ^ (k->storage * 2654435761u);
+}
+
+static gboolean
+tile_key_equal (gconstpointer a,
+                gconstpointer b)
+{
+  return memcmp (a, b, sizeof (TileKey)) == 0;
+}
+
+static guint64
+parse_size (const gchar *str)
+{
+  gchar   *end;
+  guint64  size = g_ascii_strtoull (str, &end, 10);
+
+  switch (g_ascii_toupper (*end))
+    {
+      case 'G': size *= 1024; /* fall through */
+      case 'M': size *= 1024; /* fall through */
+      case 'K': size *= 1024;
+      default:  break;
+    }
+
+  return size;
+}
+
+static void
+simulation_evict (Simulation *sim)
+{
+  while (sim->total > sim->size && sim->queue.length)
+    {
+      GList *link  = g_queue_pop_tail_link (&sim->queue);
+      Entry *entry = LINK_GET_ENTRY (link);
+
+      if (sim->policy == POLICY_CLOCK && entry->referenced)
+        {
+          /* second chance */
+          entry->referenced = FALSE;
+          g_queue_push_head_link (&sim->queue, link);
+          continue;
+        }
+
+      if (entry->dirty)
+        {
+          TileKey *key = g_memdup (&entry->key, sizeof (TileKey));
+
+          g_hash_table_add (sim->stored, key);
+          sim->writebacks++;
+        }
+
+      sim->total -= entry->size;
+      sim->evictions++;
+      g_hash_table_remove (sim->entries, &entry->key);
+    }
+}
+
+static Entry *
+simulation_insert (Simulation    *sim,
+                   const TileKey *key,
+                   gsize          size)
+{
+  Entry *entry = g_slice_new0 (Entry);
+
+  entry->key  = *key;
+  entry->size = size;
+
+  g_queue_push_head_link (&sim->queue, &entry->link);
+  g_hash_table_insert (sim->entries, &entry->key, entry);
+  sim->total += size;
+
+  simulation_evict (sim);
+
+  /* a tile larger than the cache is evicted right away */
+  return g_hash_table_lookup (sim->entries, key);
+}
+
+static void
+simulation_remove (Simulation    *sim,
+                   const TileKey *key)
+{
+  Entry *entry = g_hash_table_lookup (sim->entries, key);
+
+  if (entry)
+    {
+      g_queue_unlink (&sim->queue, &entry->link);
+      sim->total -= entry->size;
+      g_hash_table_remove (sim->entries, key);
+    }
+
+  g_hash_table_remove (sim->stored, key);
+}
+
+static void
+entry_free (Entry *entry)
+{
+  g_slice_free (Entry, entry);
+}
+
+static void
+simulation_run (Simulation                *sim,
+                const GeglTileTraceRecord *records,
+                gsize                      n_records)
+{
+  GArray *tile_sizes = g_array_new (FALSE, TRUE, sizeof (gsize));
+  gsize   i;
+
+  sim->entries = g_hash_table_new_full (tile_key_hash, tile_key_equal,
+                                        NULL, (GDestroyNotify) entry_free);
+  sim->stored  = g_hash_table_new_full (tile_key_hash, tile_key_equal,
+                                        g_free, NULL);
+  g_queue_init (&sim->queue);
+
+  for (i = 0; i < n_records; i++)
+    {
+      const GeglTileTraceRecord *record = &records[i];
+      TileKey                    key    = { record->storage,
+                                            record->x, record->y, record->z };
+      Entry                     *entry;
+      gsize                      size   = 0;
+
+      if (record->storage < tile_sizes->len)
+        size = g_array_index (tile_sizes, gsize, record->storage);
+
+      switch (record->op)
+        {
+          case GEGL_TILE_TRACE_STORAGE:
+            size = record->x;
+            if (record->storage >= tile_sizes->len)
+              g_array_set_size (tile_sizes, record->storage + 1);
+            g_array_index (tile_sizes, gsize, record->storage) = size;
+            break;
+
+          case GEGL_TILE_TRACE_GET:
+            sim->gets++;
+            entry = g_hash_table_lookup (sim->entries, &key);
+
+            if (entry)
+              {
+                sim->hits++;
+
+                if (sim->policy == POLICY_LRU)
+                  {
+                    g_queue_unlink (&sim->queue, &entry->link);
+                    g_queue_push_head_link (&sim->queue, &entry->link);
+                  }
+                else if (sim->policy == POLICY_CLOCK)
+                  {
+                    entry->referenced = TRUE;
+                  }
+              }
+            else
+              {
+                if (g_hash_table_contains (sim->stored, &key))
+                  sim->swap_reads++;
+
+                simulation_insert (sim, &key, size);
+              }
+            break;
+
+          case GEGL_TILE_TRACE_WRITE:
+            entry = g_hash_table_lookup (sim->entries, &key);
+            if (! entry)
+              entry = simulation_insert (sim, &key, size);
+            if (entry)
+              entry->dirty = TRUE;
+            break;
+
+          case GEGL_TILE_TRACE_SET:
+            entry = g_hash_table_lookup (sim->entries, &key);
+            if (entry && entry->dirty)
+              {
+                entry->dirty = FALSE;
+                g_hash_table_add (sim->stored,
+                                  g_memdup (&key, sizeof (TileKey)));
+              }
+            break;
+
+          case GEGL_TILE_TRACE_VOID:
+            simulation_remove (sim, &key);
+            break;
+
+          default:
+            break;
+        }
+    }
+
+  g_hash_table_destroy (sim->entries);
+  g_hash_table_destroy (sim->stored);
+  g_array_free (tile_sizes, TRUE);
+}
+
+static gchar *
+format_size (guint64 size)
+{
+  if (size >= 1024 * 1024 * 1024 && size % (1024 * 1024 * 1024) == 0)
+    return g_strdup_printf ("%" G_GUINT64_FORMAT "G", size >> 30);
+  if (size >= 1024 * 1024 && size % (1024 * 1024) == 0)
+    return g_strdup_printf ("%" G_GUINT64_FORMAT "M", size >> 20);
+  if (size >= 1024 && size % 1024 == 0)
+    return g_strdup_printf ("%" G_GUINT64_FORMAT "K", size >> 10);
+
+  return g_strdup_printf ("%" G_GUINT64_FORMAT, size);
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  GMappedFile               *file;
+  const GeglTileTraceHeader *header;
+  const GeglTileTraceRecord *records;
+  GArray                    *sizes;
+  GError                    *error = NULL;
+  gsize                      n_records, i;
+  guint64                    gets = 0, hits = 0;
+  gchar                     *size_str;
+  gint                       p;
+
+  if (argc < 2)
+    {
+      g_printerr ("usage: %s trace [size ...]\n", argv[0]);
+      return 1;
+    }
+
+  file = g_mapped_file_new (argv[1], FALSE, &error);
+  if (! file)
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      return 1;
+    }
+
+  header = (const GeglTileTraceHeader *) g_mapped_file_get_contents (file);
+
+  if (g_mapped_file_get_length (file) < sizeof (GeglTileTraceHeader) ||
+      memcmp (header->magic, GEGL_TILE_TRACE_MAGIC, sizeof (header->magic)) ||
+      header->version != GEGL_TILE_TRACE_VERSION ||
+      header->record_size != sizeof (GeglTileTraceRecord))
+    {
+      g_printerr ("%s is not a tile trace this version of %s can read\n",
+                  argv[1], argv[0]);
+      g_mapped_file_unref (file);
+      return 1;
+    }
+
+  records   = (const GeglTileTraceRecord *) (header + 1);
+  n_records = (g_mapped_file_get_length (file) - sizeof (GeglTileTraceHeader)) /
+              sizeof (GeglTileTraceRecord);
+
+  for (i = 0; i < n_records; i++)
+    if (records[i].op == GEGL_TILE_TRACE_GET)
+      {
+        gets++;
+        hits += records[i].hit;
+      }
+
+  size_str = format_size (header->cache_size);
+  g_print ("%" G_GSIZE_FORMAT " records, %" G_GUINT64_FORMAT " gets, "
+           "%.1f%% hits recorded with a %s cache\n\n",
+           n_records, gets, gets ? 100.0 * hits / gets : 0.0, size_str);
+  g_free (size_str);
+
+  sizes = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+  if (argc > 2)
+    {
+      for (i = 2; i < argc; i++)
+        {
+          guint64 size = parse_size (argv[i]);
+
+          g_array_append_val (sizes, size);
+        }
+    }
+  else
+    {
+      gint shift;
+
+      for (shift = -2; shift <= 2; shift++)
+        {
+          guint64 size = shift < 0 ? header->cache_size >> -shift :
+                                     header->cache_size << shift;
+
+          g_array_append_val (sizes, size);
+        }
+    }
+
+  g_print ("%-6s %10s %10s %12s %12s %12s\n",
+           "policy", "size", "hit ratio", "evictions", "writebacks",
+           "swap reads");
+
+  for (p = 0; p < G_N_ELEMENTS (policy_names); p++)
+    for (i = 0; i < sizes->len; i++)
+      {
+        Simulation sim = { 0, };
+
+        sim.policy = p;
+        sim.size   = g_array_index (sizes, guint64, i);
+
+        simulation_run (&sim, records, n_records);
+
+        size_str = format_size (sim.size);
+        g_print ("%-6s %10s %9.1f%% %12" G_GUINT64_FORMAT
+                 " %12" G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT "\n",
+                 policy_names[p], size_str,
+                 sim.gets ? 100.0 * sim.hits / sim.gets : 0.0,
+                 sim.evictions, sim.writebacks, sim.swap_reads);
+        g_free (size_str);
+      }
+
+  g_array_free (sizes, TRUE);
+  g_mapped_file_unref (file);
+
+  return 0;
+}